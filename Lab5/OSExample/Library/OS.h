@@ -19,6 +19,8 @@
 #define OS_MAX_USER_THREADS       31
 #define OS_LOWEST_PRIORITY        31
 #define OS_MAX_EVENTS             32
+#define OS_MAX_QUEUES             8
+#define OS_MAX_FLAGS              8
 #define OS_PRIORITY_SELF          255
 
 // ----------------------------------------
@@ -28,6 +30,14 @@
 
 #define OS_THREAD_STACK(x, y) static uint32_t x[y] __attribute__ ((aligned(0x08)))
 
+// ----------------------------------------
+// OS message queue buffers
+// x = name of buffer
+// y = type of message
+// z = number of messages
+
+#define OS_QUEUE_BUFFER(x, y, z) static y x[z]
+
 // ----------------------------------------
 // OS error codes
 
@@ -46,7 +56,9 @@ typedef enum
   OS_THREAD_DELETE_IDLE,
   OS_THREAD_DELETE_ISR,
   // Semaphore error
-  OS_SEMAPHORE_OVERFLOW
+  OS_SEMAPHORE_OVERFLOW,
+  // Message queue error
+  OS_QUEUE_FULL
 } OS_ERROR;
 
 // ----------------------------------------
@@ -61,7 +73,11 @@ typedef enum
   // Waiting on semaphore
   OS_STATE_SEMAPHORE,
   // Waiting for a delay
-  OS_STATE_DELAYED
+  OS_STATE_DELAYED,
+  // Waiting on a message queue
+  OS_STATE_QUEUE,
+  // Waiting on event flags
+  OS_STATE_FLAGS
 } OS_STATE;
 
 // ----------------------------------------
@@ -74,6 +90,49 @@ typedef struct ecb
   uint32_t waitList;     // List of threads waiting for event
 } OS_ECB;
 
+// ----------------------------------------
+// Message queue
+// Holds copies of fixed size messages, oldest first
+
+typedef struct
+{
+  uint8_t *buffer;       // nbMessages messages of messageSize bytes
+  uint16_t messageSize;  // Bytes in a message
+  uint16_t nbMessages;   // Messages the buffer holds
+  uint16_t head;         // Index of the oldest message
+  uint16_t count;        // Messages in the queue
+  uint32_t waitList;     // List of threads waiting for a message
+} OS_QUEUE;
+
+// ----------------------------------------
+// Event flag group
+// 32 flags that threads wait on any or all of
+
+typedef struct
+{
+  uint32_t flags;        // Flags that are set
+  uint32_t waitList;     // List of threads waiting for flags
+} OS_FLAGS;
+
+// ----------------------------------------
+// Stack usage of a thread
+
+typedef struct
+{
+  uint32_t size;         // Words in the stack, 0 if the thread was not created with OS_ThreadCreateStack
+  uint32_t used;         // Most words the thread has used
+  bool overflowed;       // The canary at the bottom of the stack has been overwritten
+} OS_STACK_INFO;
+
+// ----------------------------------------
+// Processor time of a thread, or of the ISRs
+
+typedef struct
+{
+  uint64_t cycles;       // Processor cycles spent
+  uint32_t count;        // Times the thread was switched to, or outermost ISRs entered
+} OS_LOAD;
+
 /*! @brief Sets up the OS before first use.
  *
  *  Initialises the Coretex-M4 SysTick for use by the OS.
@@ -182,6 +241,130 @@ OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent);
 
 OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout);
 
+// ----------------------------------------
+// OS_QueueCreate
+//
+// Creates a message queue. Each message posted is
+// copied into the queue, and copied out again by the
+// thread that gets it, so the sender can reuse its
+// message at once.
+//
+// Input:
+//   buffer is where the queue keeps its messages,
+//     nbMessages * messageSize bytes, usually declared
+//     with OS_QUEUE_BUFFER.
+//   messageSize is the number of bytes in a message.
+//   nbMessages is the number of messages the queue holds.
+// Output:
+//   A pointer to the queue. If no queue is available,
+//   a NULL pointer is returned.
+// Conditions:
+//   Messages are copied with interrupts disabled, so
+//   they should be small.
+
+OS_QUEUE* OS_QueueCreate(void* const buffer, const uint16_t messageSize, const uint16_t nbMessages);
+
+// ----------------------------------------
+// OS_QueuePost
+//
+// Posts a copy of a message to a queue. The highest
+// priority thread waiting on the queue gets it,
+// otherwise it joins the back of the queue.
+//
+// Input:
+//   pQueue is a pointer to the queue.
+//   message is a pointer to the message.
+// Output:
+//   Returns one of two error codes:
+//   OS_NO_ERROR if the message was posted
+//   OS_QUEUE_FULL if the queue had no room, in which
+//     case the message is dropped
+// Conditions:
+//   Never waits, so it can be called by an ISR.
+
+OS_ERROR OS_QueuePost(OS_QUEUE* const pQueue, const void* const message);
+
+// ----------------------------------------
+// OS_QueuePend
+//
+// Gets the oldest message in a queue, waiting for
+// one if the queue is empty.
+//
+// Input:
+//   pQueue is a pointer to the queue.
+//   message is where the message is copied to.
+//   timeout is the number of clock ticks to wait
+//     for a message, or 0 to wait forever.
+// Output:
+//   Returns one of two error codes:
+//   OS_NO_ERROR if a message was got
+//   OS_TIMEOUT if no message was posted within the
+//     specified timeout
+// Conditions:
+//   A thread cannot wait on a queue from an ISR.
+
+OS_ERROR OS_QueuePend(OS_QUEUE* const pQueue, void* const message, const uint32_t timeout);
+
+// ----------------------------------------
+// OS_FlagsCreate
+//
+// Creates an event flag group. A thread can wait on
+// several flags at once, each set by a different ISR
+// or thread.
+//
+// Input:
+//   flags is the flags that are set to begin with.
+// Output:
+//   A pointer to the flag group. If no flag group is
+//   available, a NULL pointer is returned.
+// Conditions:
+//   none
+
+OS_FLAGS* OS_FlagsCreate(const uint32_t flags);
+
+// ----------------------------------------
+// OS_FlagsSet
+//
+// Sets flags in a flag group, readying every thread
+// whose wait they satisfy, highest priority first.
+// The flags a thread waited for are cleared as it is
+// readied.
+//
+// Input:
+//   pFlags is a pointer to the flag group.
+//   flags is the flags to set.
+// Output:
+//   none
+// Conditions:
+//   Can be called by an ISR.
+
+void OS_FlagsSet(OS_FLAGS* const pFlags, const uint32_t flags);
+
+// ----------------------------------------
+// OS_FlagsWait
+//
+// Waits for any or all of some flags of a flag group
+// to be set, and clears them.
+//
+// Input:
+//   pFlags is a pointer to the flag group.
+//   flags is the flags to wait for.
+//   all is true to wait for all of the flags, false
+//     for any of them.
+//   timeout is the number of clock ticks to wait, or
+//     0 to wait forever.
+//   ready is where the flags that were set, out of
+//     flags, are written.
+// Output:
+//   Returns one of two error codes:
+//   OS_NO_ERROR if the flags were set
+//   OS_TIMEOUT if the flags were not set within the
+//     specified timeout, in which case ready is 0
+// Conditions:
+//   A thread cannot wait on flags from an ISR.
+
+OS_ERROR OS_FlagsWait(OS_FLAGS* const pFlags, const uint32_t flags, const bool all, const uint32_t timeout, uint32_t* const ready);
+
 /*! @brief Starts the OS multithreading.
  *
  *  @note OS_Init() must be called prior to calling OS_Start().
@@ -224,6 +407,97 @@ void OS_Start(void);
 
 OS_ERROR OS_ThreadCreate(void (*thread)(void* pd), void* pData, void* pStack, const uint8_t priority);
 
+// ----------------------------------------
+// OS_ThreadCreateStack
+//
+// Creates a thread as OS_ThreadCreate() does, given the
+// whole of its stack rather than the top. The stack is
+// painted so the idle thread can find the deepest the
+// thread has ever used it, and its bottom word is a
+// canary that is checked each time the thread is switched
+// out.
+//
+// Input:
+//   thread is a pointer to the thread's code.
+//   pData is a pointer to an optional data area used to
+//     pass parameters to the thread when it is created.
+//   stack is a pointer to the bottom of the thread's stack.
+//   stackSize is the number of words in the stack.
+//   priority is the thread priority.
+// Output:
+//   Returns the error codes of OS_ThreadCreate().
+// Conditions:
+//   As OS_ThreadCreate().
+
+OS_ERROR OS_ThreadCreateStack(void (*thread)(void* pd), void* pData, uint32_t* const stack, const uint32_t stackSize, const uint8_t priority);
+
+// ----------------------------------------
+// OS_StackInfo
+//
+// Gets the stack usage of a thread.
+//
+// Input:
+//   priority is the priority number of the thread.
+//   info is where the usage is written.
+// Output:
+//   Returns true if the thread exists.
+// Conditions:
+//   The usage is what the idle thread last found, so
+//   it can be behind if the idle thread seldom runs.
+
+bool OS_StackInfo(const uint8_t priority, OS_STACK_INFO* const info);
+
+// ----------------------------------------
+// OS_LoadThread
+//
+// Gets the processor time a thread has used since
+// OS_Init() or OS_LoadClear(). Time in ISRs that call
+// OS_ISREnter() and OS_ISRExit() is not counted against
+// the thread they interrupted. The idle thread has
+// priority OS_LOWEST_PRIORITY, so its time is the time
+// the processor had nothing to do.
+//
+// Input:
+//   priority is the priority number of the thread.
+//   load is where the time is written.
+// Output:
+//   Returns true if the thread has run or exists.
+// Conditions:
+//   none
+
+bool OS_LoadThread(const uint8_t priority, OS_LOAD* const load);
+
+// ----------------------------------------
+// OS_LoadISR
+//
+// Gets the processor time spent in ISRs since
+// OS_Init() or OS_LoadClear(), from the outermost
+// OS_ISREnter() to the matching OS_ISRExit().
+//
+// Input:
+//   load is where the time is written.
+// Output:
+//   none
+// Conditions:
+//   none
+
+void OS_LoadISR(OS_LOAD* const load);
+
+// ----------------------------------------
+// OS_LoadClear
+//
+// Starts the processor time of every thread and of the
+// ISRs again from 0.
+//
+// Input:
+//   none
+// Output:
+//   none
+// Conditions:
+//   none
+
+void OS_LoadClear(void);
+
 // ----------------------------------------
 // OS_ThreadDelete
 //
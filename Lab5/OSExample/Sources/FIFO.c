@@ -15,6 +15,7 @@
 #include "PE_Types.h"
 #include "Cpu.h"
 #include "OS.h"
+#include "Profile.h"
 /****************************************PUBLIC FUNCTION DEFINITION***************************************/
 
 /*! @brief Initialize the FIFO before first use.
@@ -43,13 +44,14 @@ void FIFO_Put(TFIFO * const FIFO, const uint8_t data)
 {
   OS_SemaphoreWait(FIFO->SpaceAvailable, 0); // Wait on space available
   OS_SemaphoreWait(FIFO->BufferAccess, 0); // Get exclusive access
-
+  PROFILE_BEGIN(PROFILE_FIFO_PUT);
 
   FIFO->Buffer[FIFO->End] = data; 	//Put data into FIFO buffer
   FIFO->NbBytes++; 			//Number of bytes in FIFO increases
   FIFO->End++; 			//Next available position iterates
   if (FIFO->End == FIFO_SIZE-1) FIFO->End = 0; //Check whether the FIFO is full, reset
 
+  PROFILE_END(PROFILE_FIFO_PUT);
   OS_SemaphoreSignal(FIFO->BufferAccess); // Signal exclusive access
   OS_SemaphoreSignal(FIFO->ItemsAvailable); // Signal space available
 }
@@ -65,12 +67,14 @@ void FIFO_Get(TFIFO * const FIFO, uint8_t * const dataPtr)
 {
   OS_SemaphoreWait(FIFO->ItemsAvailable, 0); //Wait on items available
   OS_SemaphoreWait(FIFO->BufferAccess, 0); //Wait on exclusive access
+  PROFILE_BEGIN(PROFILE_FIFO_GET);
 
   *dataPtr = FIFO->Buffer[FIFO->Start]; //Data = Array[Start]
   FIFO->Start++; //Moves to the next element in the array
   FIFO->NbBytes--;
   if (FIFO->Start == FIFO_SIZE-1) FIFO->Start = 0;
 
+  PROFILE_END(PROFILE_FIFO_GET);
   OS_SemaphoreSignal(FIFO->BufferAccess); //Signal no exclusive access taking place
   OS_SemaphoreSignal(FIFO->SpaceAvailable); //Signal space available in FIFO
 }
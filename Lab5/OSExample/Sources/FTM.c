@@ -142,6 +142,44 @@ bool FTM_StartTimer(const TFTMChannel* const aFTMChannel)
   return false; //Not successful
 }
 
+/*! @brief Restarts an output compare timer a number of counts after its last compare.
+ *
+ *  Counting from the last compare rather than from now lets a periodic timer run without drift.
+ *  @param channelNb is the channel number of the FTM to use.
+ *  @param delayCount is the delay count (in module clock periods) from the last compare.
+ *  @return bool - TRUE if the timer was restarted, FALSE if the new compare has already passed,
+ *    in which case the channel interrupt is left off.
+ *  @note Assumes the channel has been set up for output compare.
+ */
+bool FTM_RestartTimer(const uint8_t channelNb, const uint16_t delayCount)
+{
+  uint16_t ahead;
+
+  if (channelNb >= NO_OF_CHANNELS)	//validate channel
+  {
+    return false;
+  }
+
+  FTM0_CnV(channelNb) = (uint16_t)(FTM0_CnV(channelNb) + delayCount);
+  FTM0_CnSC(channelNb) &= ~FTM_CnSC_CHF_MASK;
+
+  //If the counter is already past the new compare, the match was missed and would take a whole wrap to come round
+  ahead = (uint16_t)(FTM0_CnV(channelNb) - FTM0_CNT);
+  if ((ahead == 0) || (ahead > delayCount))
+  {
+    return false;
+  }
+
+  FTM0_CnSC(channelNb) |= FTM_CnSC_CHIE_MASK; //enables channel interrupts
+  return true;
+}
+
+/*! @brief Interrupt service routine for the FTM.
+ *
+ *  If a timer channel was set up as output compare, then the user callback function will be called,
+ *  or FTM0Semaphore signalled if the channel has no callback function.
+ *  @note Assumes the FTM has been initialized.
+ */
 void __attribute__ ((interrupt)) FTM0_ISR(void)
 {
   uint8_t channelNb;
@@ -158,13 +196,15 @@ void __attribute__ ((interrupt)) FTM0_ISR(void)
       //Disable interrupt
       FTM0_CnSC(channelNb) &= ~FTM_CnSC_CHIE_MASK;
 
-      OS_SemaphoreSignal(FTM0Semaphore); //Signal FTM Semaphore
-
-      //Callback function
-//      if (FTMCallback[channelNb])
-//      {
-//	(*FTMCallback[channelNb])(FTMArguments[channelNb]);
-//      }
+      //Callback function, which may restart the timer
+      if (FTMCallback[channelNb])
+      {
+	(*FTMCallback[channelNb])(FTMArguments[channelNb]);
+      }
+      else
+      {
+	OS_SemaphoreSignal(FTM0Semaphore); //Signal FTM Semaphore
+      }
     }
   }
   OS_ISRExit();
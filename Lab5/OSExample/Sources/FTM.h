@@ -89,10 +89,22 @@ bool FTM_Set(const TFTMChannel* const aFTMChannel);
  */
 bool FTM_StartTimer(const TFTMChannel* const aFTMChannel);
 
+/*! @brief Restarts an output compare timer a number of counts after its last compare.
+ *
+ *  Counting from the last compare rather than from now lets a periodic timer run without drift.
+ *  @param channelNb is the channel number of the FTM to use.
+ *  @param delayCount is the delay count (in module clock periods) from the last compare.
+ *  @return bool - TRUE if the timer was restarted, FALSE if the new compare has already passed,
+ *    in which case the channel interrupt is left off.
+ *  @note Assumes the channel has been set up for output compare.
+ */
+bool FTM_RestartTimer(const uint8_t channelNb, const uint16_t delayCount);
+
 
 /*! @brief Interrupt service routine for the FTM.
  *
- *  If a timer channel was set up as output compare, then the user callback function will be called.
+ *  If a timer channel was set up as output compare, then the user callback function will be called,
+ *  or FTM0Semaphore signalled if the channel has no callback function.
  *  @note Assumes the FTM has been initialized.
  */
 void __attribute__ ((interrupt)) FTM0_ISR(void);
@@ -14,6 +14,7 @@
 #include "Flash.h"
 #include "MK70F12.h"
 #include <string.h>
+#include "Profile.h"
 
 /****************************************GLOBAL VARS*****************************************************/
 
@@ -219,11 +220,13 @@ bool WritePhrase(const uint64_t phrase) //const uint32_t address,
 {
   uint8_t *bytes = (uint8_t *) &phrase; //split into eight 1 byte segments for saving to flash
   FCCOB_ADR_t fccob;
+  PROFILE_BEGIN(PROFILE_FLASH_WRITE);
 
   WaitCCIF();
 
   if(!Flash_Erase())			//Erase flash before writing as per manual
   {
+    PROFILE_END(PROFILE_FLASH_WRITE);	//A failed write is still timed
     return false;
   }
 
@@ -246,6 +249,7 @@ bool WritePhrase(const uint64_t phrase) //const uint32_t address,
   SetCCIF(); //Initiates the command
   WaitCCIF();//Waits until program can continue to execute
 
+  PROFILE_END(PROFILE_FLASH_WRITE);
   return true;
 }
 
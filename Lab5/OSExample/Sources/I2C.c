@@ -20,99 +20,435 @@
 #include "LEDs.h"
 #include "stdlib.h"
 #include "OS.h"
+#include "Profile.h"
+#include "Timer.h"
 
 //Definitions
 #define I2C_D_READ  0x01 //from datasheet figure 11
 #define I2C_D_WRITE 0x00 //from datasheet figure 11
 
-#define COMPLETE 0
-#define LAST_BYTE 1
-#define SND_LAST_BYTE 2
+#define DMA_CHANNEL     0   /*!< eDMA channel used for receive bursts */
+#define DMA_SOURCE_I2C0 22  /*!< DMAMUX0 request source for I2C0, K70 manual table 3-24 */
+#define DMA_MIN_LENGTH  8   /*!< Shorter reads are cheaper byte by byte in I2C_ISR */
+
+#define MAX_BAUD_RATE   400000 /*!< Fast-mode limit of the bus */
+
+//Bounded waits, measured with the DWT cycle counter or in ticks of BusTimer
+#define TRANSFER_TIMEOUT_CYCLES (CPU_CORE_CLK_HZ / 20)    /*!< 50 ms, longer than any 255 byte segment at 100 kHz */
+#define IDLE_TIMEOUT_TICKS      2                         /*!< Timer ticks for a STOP to clear BUSY, which takes microseconds */
+#define WAIT_TICKS              10                        /*!< How often a blocked caller checks for a stuck transfer */
+
+//Accelerometer bus pins, K70 manual table 10-1 signal multiplexing
+#define SDA_PIN (1 << 18)    /*!< PTE18, I2C0_SDA on ALT4 */
+#define SCL_PIN (1 << 19)    /*!< PTE19, I2C0_SCL on ALT4 */
+#define RECOVERY_PULSES 9    /*!< Enough to finish any byte and its acknowledge */
+
+//I2C divider and hold values, K70 manual table 55-41, indexed by ICR
+static const uint16_t SCL_DIVIDER[64] = { 20, 22, 24, 26, 28, 30, 34, 40, 28, 32, 36, 40, 44, 48,
+    56, 68, 48, 56, 64, 72, 80, 88, 104, 128, 80, 96, 112, 128, 144, 160, 192,
+    240, 160, 192, 224, 256, 288, 320, 384, 480, 320, 384, 448, 512, 576, 640,
+    768, 960, 640, 768, 896, 1024, 1152, 1280, 1536, 1920, 1280, 1536, 1792,
+    2048, 2304, 2560, 3072, 3840 };
+//Multiplier factor, indexed by MULT
+static const uint8_t MULTIPLIER[3] = { 1, 2, 4 };
 
 static void* ReadCompleteUserArgumentsGlobal;
 /*!< Private global pointer to the user arguments to use with the user callback function */
 static void (*ReadCompleteCallbackGlobal)(void *);
 /*!< Private global pointer to data ready user callback function */
 
-static uint8_t SlaveAddress;    /*!< Private global variable to store 8-bit slave address */
-static uint8_t RegisterAddress; /*!< Register to read and write from */
-static uint8_t NumBytes;
-static uint8_t *ReceivedData;
-static bool OKtoRead = true;
+static uint32_t ModuleClk;         /*!< The module clock in Hz */
+static TI2CDevice PrimaryDevice;   /*!< The device set up by I2C_Init, used by the register calls */
+
+static TI2CDevice* Devices;                 /*!< Ring of the devices on the bus */
+static TI2CDevice* LastDevice;              /*!< Device that was given the bus last */
+static TI2CTransaction* volatile Current;   /*!< Transaction on the bus */
+static uint8_t SegmentNb;                   /*!< Segment of Current on the bus */
+static uint8_t ByteNb;                      /*!< Bytes of the segment transferred so far */
+static bool AddressPhase;                   /*!< The byte being sent is the slave address */
+static volatile bool Running;               /*!< The bus is owned by Current, or being recovered */
+static uint32_t StartCycle;                 /*!< DWT_CYCCNT when Current was started */
+static uint8_t BusyTicks;                   /*!< Times the bus has been found BUSY with a transaction waiting */
+static uint8_t RecoveryEdge;                /*!< SCL and SDA edges of the bus recovery made so far */
+
+static TI2CErrors Errors;         /*!< Error counters, see I2C_GetErrors */
+
+static uint8_t IntRegister;           /*!< Register address sent by I2C_IntRead */
+static TI2CSegment IntSegments[2];    /*!< Register write followed by the data read */
+static TI2CTransaction IntTransaction = { .status = I2C_STATUS_OK };
 
 //function Prototypes
-static bool waitForAck(void);
-static bool start(void);
-static bool stop(void);
-static void waitTilIdle(void);
-static void sendDeviceAddress(void);
-static void sendRegisterAddress(const uint8_t registerAddress);
+static void repeatedStart(void);
+static void stop(void);
+static void sendAddress(void);
+static void release(const bool moreSegments);
+static bool pending(void);
+static TI2CTransaction* pick(void);
+static void finish(const TI2CStatus status);
+static void advance(const bool moreSegments, const TI2CStatus status);
+static void recoverBus(void);
+static void recoveryStep(void);
+static void begin(void);
+static void busTick(void* arguments);
+static void startDMA(const TI2CSegment* const segment);
+static bool transfer(TI2CTransaction* const transaction);
+
+static TTimer BusTimer = { .userFunction = busTick }; /*!< Retries a BUSY bus, or clocks the recovery */
+
+/*!
+ * @brief Generates a repeated START.
+ *
+ * Errata e6070: a repeated START is not generated while F[MULT] is not zero, so the multiplier is
+ * cleared around the request.
+ */
+void repeatedStart(void)
+{
+  I2C0_F = Current->device->frequencyDivider & ~I2C_F_MULT_MASK;
+  I2C0_C1 = (I2C0_C1 & ~I2C_C1_TXAK_MASK) | I2C_C1_RSTA_MASK | I2C_C1_TX_MASK;
+  I2C0_F = Current->device->frequencyDivider;
+}
+
+/*!
+ * @brief Generates a STOP and releases the bus
+ */
+void stop(void)
+{
+  I2C0_C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK | I2C_C1_TXAK_MASK);
+}
 
 /*!
- * @brief waitForAck
+ * @brief Sends the slave address for the current segment of the transaction on the bus
+ *
+ * The SCL rate is switched to the device's own rate first.
  */
-bool waitForAck(void)
+void sendAddress(void)
 {
-  int timeOut = 100000;
+  const TI2CSegment* segment = &Current->segments[SegmentNb];
+
+  AddressPhase = true;
+  I2C0_F = Current->device->frequencyDivider;
+  //slave addresses I2C Data I/O register (i2Cx_D) pg 1875/2275 k70 manual
+  I2C0_D = (Current->device->address << 1) | ((segment->type == I2C_SEGMENT_READ) ? I2C_D_READ : I2C_D_WRITE);
+}
 
-  while ((I2C0_S & I2C_S_IICIF_MASK) == 0 && timeOut > 0) // ||
+/*!
+ * @brief Ends the current segment on the bus.
+ *
+ * Keeps the bus with a repeated START when another segment or transaction follows, otherwise STOPs.
+ * Must be done before the last received byte is read from I2C0_D so that no further byte is clocked in.
+ * @param moreSegments TRUE if the transaction has another segment.
+ */
+void release(const bool moreSegments)
+{
+  if (moreSegments || pending())
   {
-    timeOut--;
+    repeatedStart();
+  }
+  else
+  {
+    stop();
   }
-  return true;
 }
 
 /*!
- * @brief Start the I2C bus
+ * @brief Checks whether any device has a transaction waiting for the bus.
+ *
+ * @return bool - TRUE if a transaction is queued.
  */
-bool start(void)
+bool pending(void)
 {
-  I2C0_C1 |= I2C_C1_MST_MASK; //Master mode selected, start signal
-  I2C0_C1 |= I2C_C1_TX_MASK; //Transmit mode selected
+  TI2CDevice* device = Devices;
 
-  return true;
+  if (device)
+  {
+    do
+    {
+      if (device->head)
+      {
+	return true;
+      }
+      device = device->next;
+    } while (device != Devices);
+  }
+  return false;
 }
 
 /*!
- * @brief Stop the I2C bus
+ * @brief Takes the next transaction off the queues, round robin between devices.
+ *
+ * Each device with queued work gets one transaction in turn, so a device that queues
+ * a lot cannot starve the others.
+ * @return TI2CTransaction* - The transaction to run next, or NULL if none is queued.
  */
-bool stop()
+TI2CTransaction* pick(void)
 {
-  //stop //disable the following.
-  //disable TX would set it to the receive mode
-  I2C0_C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK); //I2C_C1_IICIE_MASK |
+  TI2CDevice* start = LastDevice ? LastDevice : Devices;
+  TI2CDevice* device = start;
+  TI2CTransaction* transaction;
 
-  return true;
+  if (!device)
+  {
+    return NULL;
+  }
+
+  do
+  {
+    device = device->next;
+    transaction = device->head;
+    if (transaction)
+    {
+      device->head = transaction->next;
+      if (!device->head)
+      {
+	device->tail = NULL;
+      }
+      transaction->next = NULL;
+      LastDevice = device;
+      return transaction;
+    }
+  } while (device != start);
+
+  return NULL;
 }
 
 /*!
- * @brief sendDeviceAddress
+ * @brief Ends Current and signals its completion.
+ *
+ * @param status Outcome of the transaction.
  */
-void sendDeviceAddress(void)
+void finish(const TI2CStatus status)
 {
-  //slave addresses I2C Data I/O register (i2Cx_D) pg 1875/2275 k70 manual
-  I2C0_D = (SlaveAddress << 1);  //& I2C_D_WRITE; // Send slave address with write bit // |
+  TI2CTransaction* done = Current;
+
+  Current = NULL;
+  done->status = status;
+  if (done->complete)
+  {
+    (void)OS_SemaphoreSignal(done->complete);
+  }
+  if (done->flags)
+  {
+    OS_FlagsSet(done->flags, done->flagsMask);
+  }
+  if (done->device->completeCallbackFunction)
+  {
+    done->device->completeCallbackFunction(done->device->completeCallbackArguments);
+  }
+}
+
+/*!
+ * @brief Moves to the next segment, or completes the transaction and starts the next queued one.
+ *
+ * @param moreSegments TRUE if the transaction has another segment.
+ * @param status Outcome of the transaction if it has ended.
+ */
+void advance(const bool moreSegments, const TI2CStatus status)
+{
+  ByteNb = 0;
+  if (moreSegments)
+  {
+    SegmentNb++;
+    sendAddress();
+    return;
+  }
+
+  finish(status);
+  Current = pick();
+  SegmentNb = 0;
+  if (Current)
+  {
+    StartCycle = DWT_CYCCNT;
+    sendAddress();
+  }
+  else
+  {
+    Running = false;
+  }
+}
 
+/*!
+ * @brief Hands the first length - 2 bytes of a read segment to the eDMA.
+ *
+ * Each DMA read of I2C0_D starts the next byte, so when the major loop ends the
+ * second last byte is on the wire with TXAK clear. The last two bytes go back to
+ * I2C_ISR, which sets TXAK in time for the final NACK and STOPs before its read.
+ * The I2C interrupt is masked meanwhile so the CPU is not involved per byte.
+ * @param segment The read segment, at least DMA_MIN_LENGTH bytes.
+ */
+void startDMA(const TI2CSegment* const segment)
+{
+  DMA_TCD0_SADDR = (uint32_t)&I2C0_D;
+  DMA_TCD0_SOFF = 0;
+  DMA_TCD0_ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0); //8-bit transfers
+  DMA_TCD0_NBYTES_MLNO = 1;                                //One byte per request
+  DMA_TCD0_SLAST = 0;
+  DMA_TCD0_DADDR = (uint32_t)segment->data;
+  DMA_TCD0_DOFF = 1;
+  DMA_TCD0_CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(segment->length - 2);
+  DMA_TCD0_BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(segment->length - 2);
+  DMA_TCD0_DLASTSGA = 0;
+  DMA_TCD0_CSR = DMA_CSR_INTMAJOR_MASK | DMA_CSR_DREQ_MASK; //Interrupt and stop at the end of the major loop
+  DMA_SERQ = DMA_SERQ_SERQ(DMA_CHANNEL);
+
+  I2C0_C1 = (I2C0_C1 & ~(I2C_C1_IICIE_MASK | I2C_C1_TXAK_MASK)) | I2C_C1_DMAEN_MASK;
 }
 
 /*!
- * @brief send Register Address
+ * @brief Starts freeing a slave that is holding SDA low. Called with interrupts masked.
+ *
+ * The I2C module is switched off and the pins are taken over as open-drain GPIO. BusTimer then
+ * clocks the recovery one edge per tick in recoveryStep. Running stays set with no Current
+ * meanwhile, so that nothing else is started on the bus.
  */
-void sendRegisterAddress(const uint8_t registerAddress)
+void recoverBus(void)
 {
-  I2C0_D = registerAddress; //send slave register address
+  Errors.busRecoveries++;
+  Running = true;
+  BusyTicks = 0;
+  RecoveryEdge = 0;
+  I2C0_C1 = 0;
+
+  GPIOE_PSOR = SDA_PIN | SCL_PIN; //Released, the pins are open drain
+  GPIOE_PDDR |= SDA_PIN | SCL_PIN;
+  PORTE_PCR18 = PORT_PCR_MUX(0x1) | PORT_PCR_ODE_MASK;
+  PORTE_PCR19 = PORT_PCR_MUX(0x1) | PORT_PCR_ODE_MASK;
+  (void)Timer_Start(&BusTimer, 1, 1);
+}
+
+/*!
+ * @brief Makes the next edge of the bus recovery. Called from BusTimer.
+ *
+ * SCL is pulsed until the slave lets SDA go, at most RECOVERY_PULSES times, then a STOP is generated,
+ * the pins go back to the I2C and the queue is restarted. A millisecond per edge is slow, but the
+ * I2C bus has no lowest clock rate.
+ */
+void recoveryStep(void)
+{
+  if (RecoveryEdge < 2 * RECOVERY_PULSES)
+  {
+    if (RecoveryEdge & 1)
+    {
+      GPIOE_PSOR = SCL_PIN;
+      RecoveryEdge++;
+      return;
+    }
+    if (!(GPIOE_PDIR & SDA_PIN))
+    {
+      GPIOE_PCOR = SCL_PIN;
+      RecoveryEdge++;
+      return;
+    }
+    RecoveryEdge = 2 * RECOVERY_PULSES; //SDA is free
+  }
+
+  //STOP: SDA rises while SCL is high
+  switch (RecoveryEdge++ - 2 * RECOVERY_PULSES)
+  {
+    case 0:
+      GPIOE_PCOR = SCL_PIN;
+      break;
+    case 1:
+      GPIOE_PCOR = SDA_PIN;
+      break;
+    case 2:
+      GPIOE_PSOR = SCL_PIN;
+      break;
+    case 3:
+      GPIOE_PSOR = SDA_PIN;
+      break;
+    default:
+      (void)Timer_Stop(&BusTimer);
+      GPIOE_PDDR &= ~(SDA_PIN | SCL_PIN);
+      PORTE_PCR18 = PORT_PCR_MUX(0x4) | PORT_PCR_ODE_MASK;
+      PORTE_PCR19 = PORT_PCR_MUX(0x4) | PORT_PCR_ODE_MASK;
+
+      I2C0_F = PrimaryDevice.frequencyDivider;
+      I2C0_S = I2C_S_ARBL_MASK | I2C_S_IICIF_MASK;
+      I2C0_C1 = I2C_C1_IICEN_MASK | I2C_C1_IICIE_MASK;
+      Running = false;
+      begin();
+      break;
+  }
 }
 
 /*!
- * @brief Wait til idle
+ * @brief Puts the next queued transaction on the bus if the bus is idle. Called with interrupts masked.
+ *
+ * Nothing waits here for BUSY to clear. BusTimer tries again on its next tick, and a bus that is still
+ * BUSY after IDLE_TIMEOUT_TICKS is held by a slave and is recovered.
  */
-void waitTilIdle(void)
+void begin(void)
 {
-  //page 1872 k70 manual
-  while((I2C0_S & I2C_S_BUSY_MASK) == I2C_S_BUSY_MASK) // Wait till bus is idle
+  if (Running || !pending())
   {
+    BusyTicks = 0;
+    return;
+  }
 
+  if (I2C0_S & I2C_S_BUSY_MASK)
+  {
+    if (BusyTicks++ < IDLE_TIMEOUT_TICKS)
+    {
+      (void)Timer_Start(&BusTimer, 1, 0);
+    }
+    else
+    {
+      recoverBus();
+    }
+    return;
   }
+
+  BusyTicks = 0;
+  Running = true;
+  Current = pick();
+  SegmentNb = 0;
+  ByteNb = 0;
+  StartCycle = DWT_CYCCNT;
+  I2C0_F = Current->device->frequencyDivider;
+  I2C0_C1 = (I2C0_C1 & ~I2C_C1_TXAK_MASK) | I2C_C1_MST_MASK | I2C_C1_TX_MASK; // START
+  sendAddress();
+}
+
+/*!
+ * @brief Retries the start of the queue, or clocks the bus recovery. Called from the FTM0 interrupt.
+ *
+ * @param arguments Not used.
+ */
+void busTick(void* arguments)
+{
+  (void)arguments;
+  if (Running && !Current)
+  {
+    recoveryStep();
+  }
+  else
+  {
+    begin();
+  }
+}
+
+/*!
+ * @brief Runs a transaction and blocks the calling thread until it ends
+ *
+ * @return bool - TRUE if the transaction completed.
+ */
+bool transfer(TI2CTransaction* const transaction)
+{
+  TI2CDevice* device = transaction->device;
+  bool success = false;
+
+  (void)OS_SemaphoreWait(device->access, 0);
+  transaction->complete = device->done;
+  if (I2C_Submit(transaction))
+  {
+    while (OS_SemaphoreWait(device->done, WAIT_TICKS) == OS_TIMEOUT)
+    {
+      I2C_Service();
+    }
+    success = (transaction->status == I2C_STATUS_OK);
+  }
+  (void)OS_SemaphoreSignal(device->access);
+  return success;
 }
 
 /*! @brief Sets up the I2C before first use.
@@ -124,27 +460,18 @@ void waitTilIdle(void)
 bool I2C_Init(const TI2CModule* const aI2CModule, const uint32_t moduleClk)
 {
 
-  I2CSemaphore = OS_SemaphoreCreate(0); //Create Semaphore for I2C Thread
-
   ReadCompleteUserArgumentsGlobal = aI2CModule->readCompleteCallbackArguments;
   // userArguments made globally(private) accessible
   ReadCompleteCallbackGlobal = aI2CModule->readCompleteCallbackFunction;
   // userFunction made globally(private) accessible
 
-  //arrays store multiplier and scl divider values
-  const static uint8_t mult[] = { 1, 2, 4 };
-  const static uint16_t scl[] = { 20, 22, 24, 26, 28, 30, 34, 40, 28, 32, 36, 40, 44, 48,
-      56, 68, 48, 56, 64, 72, 80, 88, 104, 128, 80, 96, 112, 128, 144, 160, 192,
-      240, 160, 192, 224, 256, 288, 320, 384, 480, 320, 384, 448, 512, 576, 640,
-      768, 960, 640, 768, 896, 1024, 1152, 1280, 1536, 1920, 1280, 1536, 1792,
-      2048, 2304, 2560, 3072, 3840 };
-
-  uint8_t i, //counter for looping through scl dividerarray -scldivcount
-  j, // counter for looping through multplier array - mulcount
-  multiplier, //selected count value of multiplier
-  sclDivider; //selected count value of scl divider
-  uint32_t baudRateError = 100000; // baudrate should be close to 100kbps lab4 requirement
-  uint32_t selectedBaudRate;   //baudRate of current calculation
+  ModuleClk = moduleClk;
+  PrimaryDevice.address = aI2CModule->primarySlaveAddress;
+  PrimaryDevice.baudRate = aI2CModule->baudRate;
+  if (!I2C_AddDevice(&PrimaryDevice))
+  {
+    return false;
+  }
 
   //enables clocks
   SIM_SCGC4 |= SIM_SCGC4_IIC0_MASK; //pg 352/2275 k70 manual
@@ -156,23 +483,8 @@ bool I2C_Init(const TI2CModule* const aI2CModule, const uint32_t moduleClk)
   PORTE_PCR19 = PORT_PCR_MUX(0x4) | PORT_PCR_ODE_MASK;
 
 
-  //loop to find baudrate pg 1870
-  for (i=0; i <(sizeof(scl)/sizeof(uint16_t))-1; i++)
-  {
-    for (j=0; j< (sizeof(mult)/sizeof(uint8_t))-1; j++)
-    {
-      if (abs(selectedBaudRate -  aI2CModule ->baudRate) < baudRateError) //check if the baudRate is closer to 100kbps
-      {
-	selectedBaudRate = moduleClk / mult[j] * scl[i]; //calculate baudRate
-	baudRateError = abs(selectedBaudRate - aI2CModule->baudRate); //calculate difference between baudrates
-	multiplier = j;
-	sclDivider = i;
-      }
-    }
-  }
-
   //set BaudRate pg1870 k70
-  I2C0_F = I2C_F_ICR(0x23) | I2C_F_MULT(mult[0x00]);
+  I2C0_F = PrimaryDevice.frequencyDivider;
 
   //12c programmable input glitch filter registers
   I2C0_FLT = I2C_FLT_FLT(0x00);
@@ -181,96 +493,264 @@ bool I2C_Init(const TI2CModule* const aI2CModule, const uint32_t moduleClk)
 
   I2C0_S = I2C_S_IICIF_MASK; //Clear interrupts
 
-  I2C_SelectSlaveDevice(aI2CModule->primarySlaveAddress);
+  //eDMA channel for receive bursts, triggered by I2C0
+  SIM_SCGC6 |= SIM_SCGC6_DMAMUX0_MASK;
+  SIM_SCGC7 |= SIM_SCGC7_DMA_MASK;
+  DMAMUX0_CHCFG0 = 0;
+  DMAMUX0_CHCFG0 = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(DMA_SOURCE_I2C0);
+  DMA_SEEI = DMA_SEEI_SEEI(DMA_CHANNEL); //Report channel errors on the DMA error vector
 
   //NVICS page 91/2275 k70 manual
   // IRQ = 24 mod 32 = 24
   NVICICPR0 = (1<<24);                   	// Clears pending interrupts on I2C0 module
   NVICISER0 = (1<<24);                   	// Enables interrupts on I2C0 module
+  // IRQ = 0 for DMA channel 0, 16 for DMA error
+  NVICICPR0 = (1<<0) | (1<<16);
+  NVICISER0 = (1<<0) | (1<<16);
+
+  I2C0_C1 |= I2C_C1_IICEN_MASK | I2C_C1_IICIE_MASK;	// enable I2C and its interrupt pg 1871/2275
+  return true;
+}
 
-  I2C0_C1 |= I2C_C1_IICEN_MASK;		// enable I2C register pg 1871/2275
+/*! @brief Finds the I2C0_F setting for a baud rate.
+ *
+ *  @param baudRate The requested SCL frequency in Hz, at most 400 kHz.
+ *  @param moduleClk The module clock in Hz.
+ *  @param frequencyDivider Where the MULT and ICR fields are stored.
+ *  @param achievedRate Where the resulting SCL frequency in Hz is stored.
+ *  @return bool - TRUE if the requested rate is valid and can be reached without exceeding it.
+ */
+bool I2C_SolveBaud(const uint32_t baudRate, const uint32_t moduleClk, uint8_t* const frequencyDivider, uint32_t* const achievedRate)
+{
+  uint32_t divider, bestDivider = 0;
+  uint8_t mult, icr;
+
+  if ((baudRate == 0) || (baudRate > MAX_BAUD_RATE))
+  {
+    return false;
+  }
+
+  // Baud rate = module clock / (mul x SCL divider) pg 1870. Pick the fastest setting that does not
+  // exceed the request; on a tie the smaller MULT wins, which also keeps clear of errata e6070.
+  for (mult = 0; mult < sizeof(MULTIPLIER); mult++)
+  {
+    for (icr = 0; icr < sizeof(SCL_DIVIDER) / sizeof(SCL_DIVIDER[0]); icr++)
+    {
+      divider = (uint32_t)MULTIPLIER[mult] * SCL_DIVIDER[icr];
+      if (((uint64_t)baudRate * divider >= moduleClk) && (!bestDivider || (divider < bestDivider)))
+      {
+	bestDivider = divider;
+	*frequencyDivider = I2C_F_MULT(mult) | I2C_F_ICR(icr);
+      }
+    }
+  }
+
+  if (!bestDivider)
+  {
+    return false; // Even the largest divider is too fast
+  }
+
+  *achievedRate = moduleClk / bestDivider;
   return true;
 }
 
+/*! @brief Gets the SCL frequency set up by I2C_Init.
+ *
+ *  @return uint32_t - The baud rate in Hz.
+ */
+uint32_t I2C_GetBaudRate(void)
+{
+  return PrimaryDevice.achievedBaudRate;
+}
+
+/*! @brief Adds a device to the bus.
+ *
+ * @param device The device, with its address, baud rate and callback filled in.
+ * @return bool - TRUE if the device's baud rate is valid.
+ */
+bool I2C_AddDevice(TI2CDevice* const device)
+{
+  if (device->next)
+  {
+    return true; //Already on the bus
+  }
+  if (!I2C_SolveBaud(device->baudRate, ModuleClk, &device->frequencyDivider, &device->achievedBaudRate))
+  {
+    return false;
+  }
+
+  device->head = NULL;
+  device->tail = NULL;
+  device->access = OS_SemaphoreCreate(1);
+  device->done = OS_SemaphoreCreate(0);
+
+  EnterCritical();
+  if (Devices)
+  {
+    device->next = Devices->next;
+    Devices->next = device;
+  }
+  else
+  {
+    device->next = device;
+    Devices = device;
+  }
+  ExitCritical();
+  return true;
+}
+
+/*! @brief Writes a byte to a register of a device.
+ *
+ * @param device The device.
+ * @param registerAddress The register address.
+ * @param data The 8-bit data to write.
+ * @return bool - TRUE if the write completed.
+ */
+bool I2C_DeviceWrite(TI2CDevice* const device, const uint8_t registerAddress, const uint8_t data)
+{
+  uint8_t bytes[2] = { registerAddress, data };
+  const TI2CSegment segments[1] = {
+    { I2C_SEGMENT_WRITE, bytes, 2 }
+  };
+  TI2CTransaction transaction = { .device = device, .segments = segments, .nbSegments = 1 };
+
+  return transfer(&transaction);
+}
+
+/*! @brief Reads consecutive registers of a device.
+ *
+ * @param device The device.
+ * @param registerAddress The first register address.
+ * @param data A pointer to store the bytes that are read.
+ * @param nbBytes The number of bytes to read.
+ * @return bool - TRUE if the read completed.
+ */
+bool I2C_DeviceRead(TI2CDevice* const device, const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes)
+{
+  uint8_t reg = registerAddress;
+  const TI2CSegment segments[2] = {
+    { I2C_SEGMENT_WRITE, &reg, 1 },
+    { I2C_SEGMENT_READ, data, nbBytes }
+  };
+  TI2CTransaction transaction = { .device = device, .segments = segments, .nbSegments = 2 };
+
+  return transfer(&transaction);
+}
+
 /*! @brief Selects the current slave device
  *
  * @param slaveAddress The slave device address.
  */
 void I2C_SelectSlaveDevice(const uint8_t slaveAddress)
 {
-  SlaveAddress = slaveAddress; //store the slave address globally(private)
+  PrimaryDevice.address = slaveAddress;
 }
 
-/*! @brief Write a byte of data to a specified register
+/*! @brief Queues a transaction on the bus.
  *
- * @param registerAddress The register address.
- * @param data The 8-bit data to write.
+ * @param transaction The transaction to queue. It must stay valid until it completes.
+ * @return bool - TRUE if the transaction was queued.
  */
-void I2C_Write(const uint8_t registerAddress, const uint8_t data)
+bool I2C_Submit(TI2CTransaction* const transaction)
 {
+  uint8_t i;
+
+  if (!transaction->device || !transaction->device->next || !transaction->nbSegments)
+  {
+    return false;
+  }
+  for (i = 0; i < transaction->nbSegments; i++)
+  {
+    if (!transaction->segments[i].length)
+    {
+      return false;
+    }
+  }
+
+  transaction->status = I2C_STATUS_PENDING;
+  transaction->next = NULL;
+
+  // The ISR picks it up with a repeated START when its device's turn comes
+  EnterCritical();
+  if (transaction->device->tail)
+  {
+    transaction->device->tail->next = transaction;
+  }
+  else
+  {
+    transaction->device->head = transaction;
+  }
+  transaction->device->tail = transaction;
+  ExitCritical();
 
-  waitTilIdle();
-  //	I2C0_C1 |= (I2C_C1_TX_MASK); //Set to transmit mode
+  I2C_Service();
+  return true;
+}
 
-  // Wait for all bytes to write
-  OS_SemaphoreWait(I2CSemaphore, 0);
+/*! @brief Supervises the bus.
+ *
+ * @note Must be called from thread context.
+ */
+void I2C_Service(void)
+{
+  EnterCritical();
+  if (Running && Current && (DWT_CYCCNT - StartCycle > TRANSFER_TIMEOUT_CYCLES))
+  {
+    I2C0_C1 &= ~(I2C_C1_IICIE_MASK | I2C_C1_DMAEN_MASK);
+    DMA_CERQ = DMA_CERQ_CERQ(DMA_CHANNEL);
+    DMA_CINT = DMA_CINT_CINT(DMA_CHANNEL);
+    NVICICPR0 = (1<<0) | (1<<24);
+    Errors.timeouts++;
+    finish(I2C_STATUS_TIMEOUT);
+    recoverBus();
+  }
+  else
+  {
+    begin();
+  }
+  ExitCritical();
+}
 
-  start(); //we set to transmit mode here when we start
-  sendDeviceAddress();
-  waitForAck();
-  sendRegisterAddress(registerAddress);
-  waitForAck();
-  I2C0_D = data; // Send data
-  // do we need to disable receive mode here?
-  //I2C0_C1 &= ~(I2C_C1_TX_MASK); //Receive mode selected
-  waitForAck();
-  stop();
+/*! @brief Gets the error counters.
+ *
+ * @return const TI2CErrors* - The counters since I2C_Init or I2C_ClearErrors.
+ */
+const TI2CErrors* I2C_GetErrors(void)
+{
+  return &Errors;
+}
 
-  // Signal all bytes are written
-  OS_SemaphoreSignal(I2CSemaphore);
+/*! @brief Clears the error counters.
+ */
+void I2C_ClearErrors(void)
+{
+  EnterCritical();
+  Errors = (TI2CErrors){ 0 };
+  ExitCritical();
+}
 
-  // waitTilIdle();
+/*! @brief Write a byte of data to a specified register
+ *
+ * @param registerAddress The register address.
+ * @param data The 8-bit data to write.
+ */
+void I2C_Write(const uint8_t registerAddress, const uint8_t data)
+{
+  (void)I2C_DeviceWrite(&PrimaryDevice, registerAddress, data);
 }
 
 /*! @brief Reads data of a specified length starting from a specified register
  *
- * Uses polling as the method of data reception.
+ * Blocks the calling thread until the data has been received.
  * @param registerAddress The register address.
  * @param data A pointer to store the bytes that are read.
  * @param nbBytes The number of bytes to read.
  */
 void I2C_PollRead(const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes)
 {
-  //m-change
-  uint8_t dataCount;
-
-  waitTilIdle();
-  start();
-  sendDeviceAddress(); //sending address in the write bit
-  waitForAck();
-  sendRegisterAddress(registerAddress);
-  waitForAck();
-  I2C0_C1 |= I2C_C1_RSTA_MASK; //Repeat start -new
-  I2C0_D = (SlaveAddress << 1)  | I2C_D_READ; // Send slave address with read bit
-  waitForAck(); //new
-  I2C0_C1 &= ~(I2C_C1_TX_MASK); //Receive mode selected
-  I2C0_C1 &= ~(I2C_C1_TXAK_MASK); //Send ack after each msg
-  data[0] = I2C0_D; //dummy read -new
-  waitForAck();
-
-  //new for loop
-  for (dataCount = 0; dataCount < nbBytes-1; dataCount++)
-  {
-    data[dataCount] = I2C0_D;
-    waitForAck();
-  }
-
-  I2C0_C1 |= I2C_C1_TXAK_MASK;//Nack from Master
-
-  data[dataCount++] = I2C0_D; //Read second last byte
-  waitForAck();
-  stop(); //stop signal
-  data[dataCount++] = I2C0_D; //Read last byte
+  PROFILE_BEGIN(PROFILE_I2C_POLL_READ);
+  (void)I2C_DeviceRead(&PrimaryDevice, registerAddress, data, nbBytes);
+  PROFILE_END(PROFILE_I2C_POLL_READ);
 }
 
 /*! @brief Reads data of a specified length starting from a specified register
@@ -279,100 +759,164 @@ void I2C_PollRead(const uint8_t registerAddress, uint8_t* const data, const uint
  * @param registerAddress The register address.
  * @param data A pointer to store the bytes that are read.
  * @param nbBytes The number of bytes to read.
+ * @param flags The flag group to signal the end of the read in.
+ * @param mask The flags to set.
  */
-void I2C_IntRead(const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes)
+void I2C_IntRead(const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes, OS_FLAGS* const flags, const uint32_t mask)
 {
-  uint8_t tempDummy;
-
-  I2C0_C1 |= I2C_C1_IICIE_MASK;		// Enable interrupt
-
-  if (OKtoRead)
+  if (IntTransaction.status == I2C_STATUS_PENDING)
   {
-    NumBytes = nbBytes; 	// place into global variable
-    ReceivedData = data;			// place into global variable
-    OKtoRead = false;
+    I2C_Service();
+    return;
   }
 
-  waitTilIdle();
-  start();
-  sendDeviceAddress();
-  waitForAck();
-  sendRegisterAddress(registerAddress);
-  waitForAck();
+  IntRegister = registerAddress;
+  IntSegments[0] = (TI2CSegment){ I2C_SEGMENT_WRITE, &IntRegister, 1 };
+  IntSegments[1] = (TI2CSegment){ I2C_SEGMENT_READ, data, nbBytes };
 
-  I2C0_D = (SlaveAddress << 1)  | I2C_D_READ; // Send slave address with read bit
-  I2C0_C1 &= ~(I2C_C1_TX_MASK); 							// Receive mode selected
-  I2C0_C1 &= ~(I2C_C1_TXAK_MASK); 						// Send an ACK after receiving each byte
-  waitForAck();
-  tempDummy = I2C0_D; //In master transmit mode, when data is written to this register a data transfer is initiated
+  IntTransaction.device = &PrimaryDevice;
+  IntTransaction.segments = IntSegments;
+  IntTransaction.nbSegments = 2;
+  IntTransaction.flags = flags;
+  IntTransaction.flagsMask = mask;
+  (void)I2C_Submit(&IntTransaction);
+}
 
-  I2C0_C1 |= (I2C_C1_TX_MASK); //Set back to transmit mode
 
-  stop();
+/*! @brief Gets the outcome of the last I2C_IntRead.
+ *
+ * @return TI2CStatus - I2C_STATUS_PENDING while the read is in progress.
+ */
+TI2CStatus I2C_IntReadStatus(void)
+{
+  return IntTransaction.status;
 }
 
 
 /*! @brief Interrupt service routine for the I2C.
  *
- *  Only used for reading data.
- *  At the end of reception, the user callback function will be called.
+ *  Runs the queued transactions one bus event at a time.
  *  @note Assumes the I2C module has been initialized.
  */
 void __attribute__ ((interrupt)) I2C_ISR(void)
 {
   OS_ISREnter();
+  PROFILE_BEGIN(PROFILE_I2C_ISR);
   uint8_t status = I2C0_S;
-  static uint8_t iCount = 0; //counts the number of interrupts occurred, indicates bytes read.
+  const TI2CSegment* segment;
+  bool moreSegments;
 
   // Acknowledge interrupt
   I2C0_S = I2C_S_IICIF_MASK;
 
-  // Check transmission complete flag
-  if (I2C0_S & I2C_S_TCF_MASK)
+  if (Current && Running)
   {
-    // Check if the transmit type is set to Receive
-    if (~(I2C0_C1 & I2C_C1_TX_MASK))
+    segment = &Current->segments[SegmentNb];
+    moreSegments = (SegmentNb + 1 < Current->nbSegments);
+
+    if (status & I2C_S_ARBL_MASK)
+    {
+      // The module has dropped out of master mode; the queue restarts once the bus is idle
+      I2C0_S = I2C_S_ARBL_MASK;
+      I2C0_C1 &= ~(I2C_C1_MST_MASK | I2C_C1_TX_MASK | I2C_C1_TXAK_MASK);
+      Errors.arbitrationLosses++;
+      finish(I2C_STATUS_ARBITRATION_LOST);
+      Running = false;
+      begin();
+    }
+    else if (I2C0_C1 & I2C_C1_TX_MASK)
     {
-      switch (NumBytes)
+      if (status & I2C_S_RXAK_MASK)
+      {
+	// No slave answered, or it refused a byte: abandon the transaction
+	Errors.nacks++;
+	release(false);
+	advance(false, I2C_STATUS_NACK);
+      }
+      else if (AddressPhase && (segment->type == I2C_SEGMENT_READ))
+      {
+	AddressPhase = false;
+	I2C0_C1 &= ~I2C_C1_TX_MASK; //Receive mode selected
+	if (segment->length >= DMA_MIN_LENGTH)
+	  startDMA(segment);
+	else if (segment->length == 1)
+	  I2C0_C1 |= I2C_C1_TXAK_MASK; //Only byte is not acknowledged
+	else
+	  I2C0_C1 &= ~I2C_C1_TXAK_MASK;
+	(void)I2C0_D; //dummy read starts the first byte
+      }
+      else if (ByteNb < segment->length)
+      {
+	AddressPhase = false;
+	I2C0_D = segment->data[ByteNb++];
+      }
+      else
       {
-	case (SND_LAST_BYTE):
-	I2C0_C1 |= I2C_C1_TXAK_MASK;
-	//Decrement the number of bytes to be read
-	NumBytes++;
-	//Read data and store in received data location
-	ReceivedData[iCount] = I2C0_D;
-	break;
-	case (LAST_BYTE):
-	stop();
-	//Decrement number of bytes to be read
-	NumBytes--;
-	//Read data and store in received data location
-	ReceivedData[iCount] = I2C0_D;
-	//Increment interrupt counter
-	iCount++;
-	break;
-	case (COMPLETE):
-	//Reset the interrupt counter
-	iCount = 0;
-	//IntRead can be called again
-	OKtoRead = true;
-	//interrupts off
-
-	OS_SemaphoreSignal(I2CSemaphore); //Signal Semaphore
-	//Initiate callback function
-	//ReadCompleteCallbackGlobal(ReadCompleteUserArgumentsGlobal);
-	break;
-	default:
-	  //Decrement number of bytes to be read
-	  NumBytes--;
-	  //Read data and store in received data location
-	  ReceivedData[iCount] = I2C0_D;
-	  //Increment interrupt counter
-	  iCount++;
-	  break;
+	release(moreSegments);
+	advance(moreSegments, I2C_STATUS_OK);
+      }
+    }
+    else
+    {
+      if (segment->length - ByteNb == 1)
+      {
+	// Last byte: end the segment before reading it so no further byte is clocked in
+	release(moreSegments);
+	segment->data[ByteNb] = I2C0_D;
+	advance(moreSegments, I2C_STATUS_OK);
+      }
+      else
+      {
+	if (segment->length - ByteNb == 2)
+	{
+	  I2C0_C1 |= I2C_C1_TXAK_MASK; //Nack from Master on the last byte
+	}
+	segment->data[ByteNb++] = I2C0_D;
       }
     }
   }
+  PROFILE_END(PROFILE_I2C_ISR);
+  OS_ISRExit();
+}
+/*! @brief Interrupt service routine for the eDMA channel that receives I2C bursts.
+ *
+ *  Runs at the end of a burst, or on a DMA error, and returns the segment to I2C_ISR.
+ *  @note Assumes the I2C module has been initialized.
+ */
+void __attribute__ ((interrupt)) I2C_DMA_ISR(void)
+{
+  OS_ISREnter();
+  const TI2CSegment* segment;
+
+  DMA_CINT = DMA_CINT_CINT(DMA_CHANNEL);
+  I2C0_C1 &= ~I2C_C1_DMAEN_MASK;
+  I2C0_S = I2C_S_IICIF_MASK; //Flags raised while the eDMA owned the bytes
+
+  if (Current && Running)
+  {
+    segment = &Current->segments[SegmentNb];
+    if (DMA_ERR & (1 << DMA_CHANNEL))
+    {
+      Errors.dmaErrors++;
+      DMA_CERR = DMA_CERR_CERR(DMA_CHANNEL);
+      DMA_CERQ = DMA_CERQ_CERQ(DMA_CHANNEL);
+      // NACK the byte in flight and give up on the transaction
+      I2C0_C1 |= I2C_C1_TXAK_MASK;
+      release(false);
+      (void)I2C0_D;
+      advance(false, I2C_STATUS_ERROR);
+    }
+    else
+    {
+      ByteNb = segment->length - 2;
+      if (I2C0_S & I2C_S_TCF_MASK)
+      {
+	NVICISPR0 = (1<<24); //The second last byte arrived already; let I2C_ISR take it
+      }
+    }
+  }
+
+  I2C0_C1 |= I2C_C1_IICIE_MASK;
   OS_ISRExit();
 }
 /*!
@@ -18,8 +18,6 @@
 #include "types.h"
 #include"OS.h"
 
-OS_ECB *I2CSemaphore; //Semaphore for I2C Thread
-
 typedef struct
 {
   uint8_t primarySlaveAddress;
@@ -28,22 +26,175 @@ typedef struct
   void* readCompleteCallbackArguments;          /*!< The user's read complete callback function arguments. */
 } TI2CModule;
 
+typedef enum
+{
+  I2C_SEGMENT_WRITE,
+  I2C_SEGMENT_READ
+} TI2CSegmentType;
+
+typedef enum
+{
+  I2C_STATUS_PENDING,	/*!< Queued or in progress. */
+  I2C_STATUS_OK,	/*!< All segments were transferred. */
+  I2C_STATUS_NACK,	/*!< The slave did not acknowledge; the remaining segments were dropped. */
+  I2C_STATUS_ERROR,	/*!< The transfer was abandoned because of a bus or DMA fault. */
+  I2C_STATUS_ARBITRATION_LOST,	/*!< Another master, or a glitch, took the bus. */
+  I2C_STATUS_TIMEOUT	/*!< The transfer did not finish in time; the bus is being recovered. */
+} TI2CStatus;
+
+/*!
+ * @brief Error counters of the I2C module.
+ */
+typedef struct
+{
+  uint32_t nacks;		/*!< Addresses or bytes not acknowledged by the slave. */
+  uint32_t arbitrationLosses;	/*!< Transfers that lost arbitration. */
+  uint32_t timeouts;		/*!< Transfers abandoned for taking too long. */
+  uint32_t busRecoveries;	/*!< Times SCL was pulsed to free the bus. */
+  uint32_t dmaErrors;		/*!< Receive bursts that ended in a DMA error. */
+} TI2CErrors;
+
+/*!
+ * @brief One addressed phase of a transaction. Each segment after the first starts with a repeated START.
+ */
+typedef struct
+{
+  TI2CSegmentType type;		/*!< Write to or read from the slave. */
+  uint8_t* data;		/*!< Bytes to send, or where the received bytes are stored. */
+  uint8_t length;		/*!< Number of bytes in the segment, at least 1. */
+} TI2CSegment;
+
+struct I2CDevice;
+
+/*!
+ * @brief A queued I2C transaction. It belongs to the driver from I2C_Submit until its status leaves I2C_STATUS_PENDING.
+ */
+typedef struct I2CTransaction
+{
+  struct I2CDevice* device;		/*!< The slave, added with I2C_AddDevice. */
+  const TI2CSegment* segments;		/*!< The segments, transferred in order. */
+  uint8_t nbSegments;			/*!< Number of segments. */
+  OS_ECB* complete;			/*!< Signalled from the ISR when the transaction ends, or NULL. */
+  OS_FLAGS* flags;			/*!< Has flagsMask set from the ISR when the transaction ends, or NULL. */
+  uint32_t flagsMask;
+  volatile TI2CStatus status;		/*!< Outcome of the transaction. */
+  struct I2CTransaction* next;		/*!< Used by the driver to queue transactions. */
+} TI2CTransaction;
+
+/*!
+ * @brief A slave on the bus. Each device has its own queue, and the bus is shared between devices round robin.
+ */
+typedef struct I2CDevice
+{
+  uint8_t address;				/*!< 7-bit address of the slave. */
+  uint32_t baudRate;				/*!< Fastest SCL frequency the slave supports, in Hz. */
+  void (*completeCallbackFunction)(void*);	/*!< Called from I2C_ISR when a transaction of the device ends, or NULL. */
+  void* completeCallbackArguments;		/*!< The complete callback function arguments. */
+  // Used by the driver
+  uint8_t frequencyDivider;			/*!< I2C0_F value for baudRate. */
+  uint32_t achievedBaudRate;			/*!< SCL frequency given by frequencyDivider. */
+  TI2CTransaction* head;			/*!< Oldest queued transaction. */
+  TI2CTransaction* tail;			/*!< Newest queued transaction. */
+  OS_ECB* access;				/*!< Serialises the blocking calls on the device. */
+  OS_ECB* done;					/*!< Signalled when a blocking call's transaction ends. */
+  struct I2CDevice* next;			/*!< Ring of devices on the bus. */
+} TI2CDevice;
+
 /*! @brief Sets up the I2C before first use.
  *
  *  @param aI2CModule is a structure containing the operating conditions for the module.
  *  @param moduleClk The module clock in Hz.
  *  @return BOOL - TRUE if the I2C module was successfully initialized.
+ *  @note Assumes that Timer_Init has been called; a busy or stuck bus is waited out and recovered on timer ticks.
  */
 bool I2C_Init(const TI2CModule* const aI2CModule, const uint32_t moduleClk);
 
+/*! @brief Supervises the bus.
+ *
+ * Abandons a transfer that has been on the bus for more than 50 ms and recovers the bus,
+ * and starts the queue if the bus is idle. Called from the blocking calls and I2C_Submit;
+ * should also be called periodically so interrupt-driven reads cannot stall.
+ * @note Must be called from thread context.
+ */
+void I2C_Service(void);
+
+/*! @brief Gets the error counters.
+ *
+ * @return const TI2CErrors* - The counters since I2C_Init or I2C_ClearErrors.
+ */
+const TI2CErrors* I2C_GetErrors(void);
+
+/*! @brief Clears the error counters.
+ */
+void I2C_ClearErrors(void);
+
+/*! @brief Finds the I2C0_F setting for a baud rate.
+ *
+ *  Picks the MULT and ICR giving the fastest SCL that does not exceed the request.
+ *  @param baudRate The requested SCL frequency in Hz, at most 400 kHz.
+ *  @param moduleClk The module clock in Hz.
+ *  @param frequencyDivider Where the MULT and ICR fields are stored.
+ *  @param achievedRate Where the resulting SCL frequency in Hz is stored.
+ *  @return bool - TRUE if the requested rate is valid and can be reached without exceeding it.
+ */
+bool I2C_SolveBaud(const uint32_t baudRate, const uint32_t moduleClk, uint8_t* const frequencyDivider, uint32_t* const achievedRate);
+
+/*! @brief Gets the SCL frequency set up by I2C_Init.
+ *
+ *  @return uint32_t - The baud rate in Hz.
+ */
+uint32_t I2C_GetBaudRate(void);
+
+/*! @brief Adds a device to the bus.
+ *
+ * Blocking calls on different devices can be made from different threads at the same time;
+ * their transactions are interleaved on the bus.
+ * @param device The device, with its address, baud rate and callback filled in. It must stay valid.
+ * @return bool - TRUE if the device's baud rate is valid.
+ * @note Must be called from thread context after I2C_Init.
+ */
+bool I2C_AddDevice(TI2CDevice* const device);
+
+/*! @brief Writes a byte to a register of a device.
+ *
+ * Blocks the calling thread until the transfer is done.
+ * @param device The device.
+ * @param registerAddress The register address.
+ * @param data The 8-bit data to write.
+ * @return bool - TRUE if the write completed.
+ */
+bool I2C_DeviceWrite(TI2CDevice* const device, const uint8_t registerAddress, const uint8_t data);
+
+/*! @brief Reads consecutive registers of a device.
+ *
+ * Blocks the calling thread until the data has been received.
+ * @param device The device.
+ * @param registerAddress The first register address.
+ * @param data A pointer to store the bytes that are read.
+ * @param nbBytes The number of bytes to read.
+ * @return bool - TRUE if the read completed.
+ */
+bool I2C_DeviceRead(TI2CDevice* const device, const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes);
+
 /*! @brief Selects the current slave device
  *
+ * Changes the address of the device set up by I2C_Init, which the register calls below use.
  * @param slaveAddress The slave device address.
  */
 void I2C_SelectSlaveDevice(const uint8_t slaveAddress);
 
-/*! @brief Write a byte of data to a specified register
+/*! @brief Queues a transaction on the bus.
+ *
+ * Returns immediately; the transaction is run by I2C_ISR and its complete semaphore is signalled when it ends.
+ * Transactions run in the order they are submitted, chained with repeated STARTs.
+ * @param transaction The transaction to queue. It must stay valid until it completes.
+ * @return bool - TRUE if the transaction was queued.
+ */
+bool I2C_Submit(TI2CTransaction* const transaction);
+
+/*! @brief Write a byte of data to a specified register of the device set up by I2C_Init
  *
+ * Blocks the calling thread until the transfer is done.
  * @param registerAddress The register address.
  * @param data The 8-bit data to write.
  */
@@ -51,7 +202,7 @@ void I2C_Write(const uint8_t registerAddress, const uint8_t data);
 
 /*! @brief Reads data of a specified length starting from a specified register
  *
- * Uses polling as the method of data reception.
+ * Blocks the calling thread until the data has been received.
  * @param registerAddress The register address.
  * @param data A pointer to store the bytes that are read.
  * @param nbBytes The number of bytes to read.
@@ -60,20 +211,37 @@ void I2C_PollRead(const uint8_t registerAddress, uint8_t* const data, const uint
 
 /*! @brief Reads data of a specified length starting from a specified register
  *
- * Uses interrupts as the method of data reception.
+ * Uses interrupts as the method of data reception and returns straight away.
+ * The flags are set once the data is stored, and until then data belongs to the driver.
+ * The call is ignored while a previous read is in progress.
  * @param registerAddress The register address.
  * @param data A pointer to store the bytes that are read.
  * @param nbBytes The number of bytes to read.
+ * @param flags The flag group to signal the end of the read in.
+ * @param mask The flags to set.
  */
-void I2C_IntRead(const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes);
+void I2C_IntRead(const uint8_t registerAddress, uint8_t* const data, const uint8_t nbBytes, OS_FLAGS* const flags, const uint32_t mask);
+
+/*! @brief Gets the outcome of the last I2C_IntRead.
+ *
+ * @return TI2CStatus - I2C_STATUS_PENDING while the read is in progress.
+ */
+TI2CStatus I2C_IntReadStatus(void);
 
 /*! @brief Interrupt service routine for the I2C.
  *
- *  Only used for reading data.
- *  At the end of reception, the user callback function will be called.
+ *  Runs the queued transactions one bus event at a time.
  *  @note Assumes the I2C module has been initialized.
  */
 void __attribute__ ((interrupt)) I2C_ISR(void);
+
+/*! @brief Interrupt service routine for the eDMA channel that receives I2C bursts.
+ *
+ *  Read segments of 8 bytes or more are moved from I2C0_D by the eDMA without a
+ *  per-byte interrupt. This runs once the burst is done, or on a DMA error.
+ *  @note Assumes the I2C module has been initialized.
+ */
+void __attribute__ ((interrupt)) I2C_DMA_ISR(void);
 /*!
  * @}
 */
@@ -0,0 +1,835 @@
+/*! @file
+ *
+ *  @brief Routines to implement a simple real-time operating system (RTOS).
+ *
+ *  This is the portable part of the kernel behind OS.h; OSPort.h is the processor specific part.
+ *  Every priority has its own thread control block, and the threads that are ready, delayed or
+ *  waiting on a semaphore, message queue or flag group are each kept as a 32-bit map with priority p at bit 31 - p. The
+ *  highest priority thread in a map is then its count of leading zeros, a single CLZ instruction,
+ *  so the scheduler takes the same time however many threads there are.
+ *
+ *  A message posted to a queue a thread is waiting on is copied straight to the waiting thread, and
+ *  only goes through the queue's buffer when no thread is waiting.
+ *
+ *  A stack given to OS_ThreadCreateStack is painted with STACK_PAINT, less its bottom word which is
+ *  STACK_CANARY. The idle thread scans one stack each pass for the lowest word that is no longer
+ *  paint, and the canary is checked whenever the thread is switched out.
+ *
+ *  The processor cycles between context switches and outermost interrupts are charged to the
+ *  running thread, or to the ISRs while an interrupt is being processed.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup os_module OS module documentation
+ **  @{
+ */
+#include "OS.h"
+#include "OSPort.h"
+#include "Cpu.h"
+#include "PE_Types.h"
+#include <string.h>
+
+#define IDLE_STACK_SIZE 256
+#define STACK_PAINT 0xA5A5A5A5u		/*!< The words of a stack that have never been used */
+#define STACK_CANARY 0xDEADC0DEu	/*!< The bottom word of a stack */
+
+#define PRIORITY_BIT(priority) (0x80000000u >> (priority))	/*!< A priority's bit in a thread map */
+
+/*!
+ * @brief A thread control block.
+ */
+typedef struct
+{
+  void *stackPointer;		/*!< Where the thread's context is saved while it is not running */
+  OS_STATE state;
+  uint32_t delay;		/*!< Ticks left of a delay or timeout */
+  uint32_t *waitList;		/*!< The wait list of the semaphore, queue or flag group the thread is waiting on */
+  void *message;		/*!< Where a queue wait copies its message to */
+  uint32_t flags;		/*!< The flags a flag wait is for, then the ones it got */
+  bool all;			/*!< The flag wait is for all of flags, not any */
+  bool timedOut;		/*!< The last wait timed out */
+  uint32_t *stackBottom;	/*!< NULL if the thread was not created with OS_ThreadCreateStack */
+  OS_STACK_INFO stack;
+  OS_LOAD load;
+} TTCB;
+
+const uint32_t OS_TICK_FREQUENCY = OS_TICK_HZ;
+
+static TTCB TCBTable[OS_LOWEST_PRIORITY + 1];	/*!< Indexed by priority */
+static OS_ECB ECBTable[OS_MAX_EVENTS];
+static uint8_t NextECBFree;
+static OS_QUEUE QueueTable[OS_MAX_QUEUES];
+static uint8_t NextQueueFree;
+static OS_FLAGS FlagsTable[OS_MAX_FLAGS];
+static uint8_t NextFlagsFree;
+
+static volatile uint32_t ReadyList;	/*!< Threads ready to run */
+static volatile uint32_t DelayedList;	/*!< Threads with a delay or timeout counting down */
+static TTCB * volatile TCBRunning;
+
+static volatile uint8_t ISRNestLevel;
+static OS_LOAD ISRLoad;
+static uint32_t LoadMark;		/*!< The cycle count up to which time has been charged */
+static volatile uint32_t Ticks;
+static bool Started;
+
+OS_THREAD_STACK(IdleStack, IDLE_STACK_SIZE);
+
+/*! @brief Gets the highest priority in a thread map.
+ *
+ *  @param map is the thread map, not 0.
+ *  @return uint8_t - The priority.
+ */
+static inline uint8_t HighestPriority(const uint32_t map)
+{
+  return (uint8_t) __builtin_clz(map);
+}
+
+/*! @brief Gets the priority of a thread control block.
+ *
+ *  @param tcb is the thread control block.
+ *  @return uint8_t - The priority.
+ */
+static inline uint8_t Priority(const TTCB* const tcb)
+{
+  return (uint8_t) (tcb - TCBTable);
+}
+
+/*! @brief Charges the cycles since the last charge to the ISRs or the running thread.
+ *
+ *  @note Call from inside a critical section.
+ */
+static void Charge(void)
+{
+  const uint32_t now = OSPort_Cycles();
+  const uint32_t cycles = now - LoadMark;
+
+  LoadMark = now;
+  if (ISRNestLevel)
+  {
+    ISRLoad.cycles += cycles;
+  }
+  else if (TCBRunning)
+  {
+    TCBRunning->load.cycles += cycles;
+  }
+}
+
+/*! @brief Switches to the highest priority ready thread, if it is not the running one.
+ *
+ *  Inside an interrupt nothing happens; OS_ISRExit calls this again when the last nested interrupt ends.
+ *  @note Call from inside a critical section.
+ */
+static void Schedule(void)
+{
+  if (Started && !ISRNestLevel && (&TCBTable[HighestPriority(ReadyList)] != TCBRunning))
+  {
+    OSPort_Switch();
+  }
+}
+
+/*! @brief Makes a delayed or waiting thread ready.
+ *
+ *  @param priority is the thread's priority.
+ *  @param timedOut is TRUE if the thread's delay or timeout ran out.
+ */
+static void MakeReady(const uint8_t priority, const bool timedOut)
+{
+  TTCB* const tcb = &TCBTable[priority];
+
+  if (tcb->waitList)
+  {
+    *tcb->waitList &= ~PRIORITY_BIT(priority);
+    tcb->waitList = (uint32_t*) 0;
+  }
+  DelayedList &= ~PRIORITY_BIT(priority);
+  tcb->timedOut = timedOut;
+  tcb->state = OS_STATE_READY;
+  ReadyList |= PRIORITY_BIT(priority);
+}
+
+/*! @brief Takes the running thread off the ready list.
+ *
+ *  @param state is what the thread is going to wait for.
+ *  @param ticks is how long it waits for, or 0 for ever.
+ */
+static void Block(const OS_STATE state, const uint32_t ticks)
+{
+  const uint8_t priority = Priority(TCBRunning);
+
+  ReadyList &= ~PRIORITY_BIT(priority);
+  TCBRunning->state = state;
+  TCBRunning->delay = ticks;
+  if (ticks)
+  {
+    DelayedList |= PRIORITY_BIT(priority);
+  }
+}
+
+/*! @brief Puts the running thread on a wait list.
+ *
+ *  @param state is what the thread is going to wait for.
+ *  @param waitList is the wait list of the semaphore, queue or flag group.
+ *  @param ticks is how long it waits for, or 0 for ever.
+ */
+static void Wait(const OS_STATE state, uint32_t* const waitList, const uint32_t ticks)
+{
+  Block(state, ticks);
+  TCBRunning->waitList = waitList;
+  *waitList |= PRIORITY_BIT(Priority(TCBRunning));
+}
+
+/*! @brief Finds the deepest a thread has used its stack.
+ *
+ *  @param tcb is the thread control block.
+ */
+static void ScanStack(TTCB* const tcb)
+{
+  const uint32_t* const bottom = tcb->stackBottom;
+  uint32_t i = 1;
+
+  if (!bottom || (tcb->state == OS_STATE_DORMANT))
+  {
+    return;
+  }
+  if (bottom[0] != STACK_CANARY)
+  {
+    tcb->stack.overflowed = true;
+    tcb->stack.used = tcb->stack.size;
+    return;
+  }
+  while ((i < tcb->stack.size) && (bottom[i] == STACK_PAINT))
+  {
+    i++;
+  }
+  tcb->stack.used = tcb->stack.size - i;
+}
+
+/*! @brief Runs when no other thread is ready, scanning a thread's stack each pass.
+ *
+ *  @param pData is not used.
+ */
+static void Idle(void* pData)
+{
+  uint8_t priority = 0;
+
+  for (;;)
+  {
+    ScanStack(&TCBTable[priority]);
+    priority = (priority + 1) % (OS_LOWEST_PRIORITY + 1);
+    OSPort_Idle();
+  }
+}
+
+/*! @brief Creates a thread.
+ *
+ *  @param thread is a pointer to the thread's code.
+ *  @param pData is passed to the thread.
+ *  @param stack is the bottom of the thread's stack, or NULL if it is not known.
+ *  @param stackSize is the words in the stack, if it is known.
+ *  @param pStack is a pointer to the thread's top-of-stack.
+ *  @param priority is the thread's unique priority, lower numbers first.
+ *  @return OS_ERROR - OS_NO_ERROR, OS_PRIORITY_EXISTS or OS_PRIORITY_INVALID.
+ */
+static OS_ERROR Create(void (*thread)(void* pd), void* const pData, uint32_t* const stack,
+    const uint32_t stackSize, void* const pStack, const uint8_t priority)
+{
+  TTCB *tcb;
+  uint32_t i;
+
+  if (priority > OS_LOWEST_PRIORITY)
+  {
+    return OS_PRIORITY_INVALID;
+  }
+
+  tcb = &TCBTable[priority];
+  EnterCritical();
+  if (tcb->state != OS_STATE_DORMANT)
+  {
+    ExitCritical();
+    return OS_PRIORITY_EXISTS;
+  }
+  if (stack)
+  {
+    stack[0] = STACK_CANARY;
+    for (i = 1; i < stackSize; i++)
+    {
+      stack[i] = STACK_PAINT;
+    }
+  }
+  tcb->stackBottom = stack;
+  tcb->stack = (OS_STACK_INFO) { .size = stack ? stackSize : 0 };
+  tcb->load = (OS_LOAD) { 0 };
+  tcb->stackPointer = OSPort_StackInit(thread, pData, pStack);
+  tcb->waitList = (uint32_t*) 0;
+  tcb->delay = 0;
+  MakeReady(priority, false);
+  Schedule();
+  ExitCritical();
+  return OS_NO_ERROR;
+}
+
+/*! @brief Sets up the OS before first use.
+ *
+ *  Initialises the Coretex-M4 SysTick for use by the OS.
+ *  @param cpuCoreClk is the CPU core clock frequency in Hz.
+ *  @param toggleLED will flash the orange LED every half second if true.
+ *  @note Must be called prior to calling OS_STart(),
+ *  which actually starts multithreading.
+ */
+void OS_Init(const uint32_t cpuCoreClk, const bool toggleLED)
+{
+  uint8_t priority;
+
+  for (priority = 0; priority <= OS_LOWEST_PRIORITY; priority++)
+  {
+    TCBTable[priority] = (TTCB) { .state = OS_STATE_DORMANT };
+  }
+  NextECBFree = 0;
+  NextQueueFree = 0;
+  NextFlagsFree = 0;
+  ReadyList = 0;
+  DelayedList = 0;
+  TCBRunning = (TTCB*) 0;
+  ISRNestLevel = 0;
+  ISRLoad = (OS_LOAD) { 0 };
+  Ticks = 0;
+  Started = false;
+
+  //The idle thread keeps the ready list from ever being empty
+  (void) Create(Idle, (void*) 0, IdleStack, IDLE_STACK_SIZE, &IdleStack[IDLE_STACK_SIZE - 1], OS_LOWEST_PRIORITY);
+
+  OSPort_Init(cpuCoreClk, toggleLED);
+  LoadMark = OSPort_Cycles();
+}
+
+/*! @brief Notifies the RTOS that an ISR is being processed.
+ *
+ *  @note Must not be called by thread-level code.
+ */
+void OS_ISREnter(void)
+{
+  EnterCritical();
+  if (!ISRNestLevel)
+  {
+    Charge();
+    ISRLoad.count++;
+  }
+  ISRNestLevel++;
+  ExitCritical();
+}
+
+/*! @brief Notifies the RTOS that an ISR has completed.
+ *
+ *  When the last nested interrupt completes, a thread the interrupts made ready is switched to.
+ *  @note Must not be called by thread-level code.
+ */
+void OS_ISRExit(void)
+{
+  EnterCritical();
+  if (ISRNestLevel == 1)
+  {
+    Charge();
+  }
+  if (ISRNestLevel && !--ISRNestLevel)
+  {
+    Schedule();
+  }
+  ExitCritical();
+}
+
+/*! @brief Creates and initializes a semaphore.
+ *
+ *  @param value is the initial value of the semaphore.
+ *  @return OS_ECB* - The semaphore, or NULL if there are no more event control blocks.
+ */
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  OS_ECB *pEvent = (OS_ECB*) 0;
+
+  EnterCritical();
+  if (NextECBFree < OS_MAX_EVENTS)
+  {
+    pEvent = &ECBTable[NextECBFree++];
+    pEvent->count = value;
+    pEvent->waitList = 0;
+  }
+  ExitCritical();
+  return pEvent;
+}
+
+/*! @brief Signals a semaphore.
+ *
+ *  The highest priority waiting thread gets the signal, otherwise the count goes up.
+ *  @param pEvent is the semaphore.
+ *  @return OS_ERROR - OS_NO_ERROR, or OS_SEMAPHORE_OVERFLOW if the count would overflow.
+ */
+OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent)
+{
+  OS_ERROR error = OS_NO_ERROR;
+
+  EnterCritical();
+  if (pEvent->waitList)
+  {
+    MakeReady(HighestPriority(pEvent->waitList), false);
+    Schedule();
+  }
+  else if (pEvent->count == 0xFFFFFFFFu)
+  {
+    error = OS_SEMAPHORE_OVERFLOW;
+  }
+  else
+  {
+    pEvent->count++;
+  }
+  ExitCritical();
+  return error;
+}
+
+/*! @brief Waits on a semaphore.
+ *
+ *  @param pEvent is the semaphore.
+ *  @param timeout is the clock ticks to wait for, or 0 to wait for ever.
+ *  @return OS_ERROR - OS_NO_ERROR, or OS_TIMEOUT if the semaphore was not signalled in time.
+ *  @note Must not be called from inside a critical section, where the thread cannot be switched out.
+ */
+OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout)
+{
+  TTCB *tcb;
+
+  EnterCritical();
+  if (pEvent->count)
+  {
+    pEvent->count--;
+    ExitCritical();
+    return OS_NO_ERROR;
+  }
+
+  tcb = TCBRunning;
+  Wait(OS_STATE_SEMAPHORE, &pEvent->waitList, timeout);
+  Schedule();
+  ExitCritical();
+
+  //Running again, either signalled or timed out
+  return tcb->timedOut ? OS_TIMEOUT : OS_NO_ERROR;
+}
+
+/*! @brief Creates a message queue.
+ *
+ *  @param buffer is where the queue keeps its messages, nbMessages * messageSize bytes.
+ *  @param messageSize is the bytes in a message.
+ *  @param nbMessages is the messages the queue holds.
+ *  @return OS_QUEUE* - The queue, or NULL if there are no more queues.
+ */
+OS_QUEUE* OS_QueueCreate(void* const buffer, const uint16_t messageSize, const uint16_t nbMessages)
+{
+  OS_QUEUE *pQueue = (OS_QUEUE*) 0;
+
+  EnterCritical();
+  if (NextQueueFree < OS_MAX_QUEUES)
+  {
+    pQueue = &QueueTable[NextQueueFree++];
+    *pQueue = (OS_QUEUE) { .buffer = buffer, .messageSize = messageSize, .nbMessages = nbMessages };
+  }
+  ExitCritical();
+  return pQueue;
+}
+
+/*! @brief Posts a copy of a message to a queue.
+ *
+ *  The highest priority waiting thread gets the message, otherwise it joins the back of the queue.
+ *  @param pQueue is the queue.
+ *  @param message is the message.
+ *  @return OS_ERROR - OS_NO_ERROR, or OS_QUEUE_FULL if the queue had no room and the message was dropped.
+ *  @note Never waits, so it can be called from an ISR.
+ */
+OS_ERROR OS_QueuePost(OS_QUEUE* const pQueue, const void* const message)
+{
+  OS_ERROR error = OS_NO_ERROR;
+  uint8_t priority;
+
+  EnterCritical();
+  if (pQueue->waitList)
+  {
+    priority = HighestPriority(pQueue->waitList);
+    memcpy(TCBTable[priority].message, message, pQueue->messageSize);
+    MakeReady(priority, false);
+    Schedule();
+  }
+  else if (pQueue->count == pQueue->nbMessages)
+  {
+    error = OS_QUEUE_FULL;
+  }
+  else
+  {
+    memcpy(&pQueue->buffer[((pQueue->head + pQueue->count) % pQueue->nbMessages) * pQueue->messageSize],
+           message, pQueue->messageSize);
+    pQueue->count++;
+  }
+  ExitCritical();
+  return error;
+}
+
+/*! @brief Gets the oldest message in a queue, waiting for one if the queue is empty.
+ *
+ *  @param pQueue is the queue.
+ *  @param message is where the message is copied to.
+ *  @param timeout is the clock ticks to wait for, or 0 to wait for ever.
+ *  @return OS_ERROR - OS_NO_ERROR, or OS_TIMEOUT if no message was posted in time.
+ *  @note Must not be called from inside a critical section, where the thread cannot be switched out.
+ */
+OS_ERROR OS_QueuePend(OS_QUEUE* const pQueue, void* const message, const uint32_t timeout)
+{
+  TTCB *tcb;
+
+  EnterCritical();
+  if (pQueue->count)
+  {
+    memcpy(message, &pQueue->buffer[pQueue->head * pQueue->messageSize], pQueue->messageSize);
+    pQueue->head = (pQueue->head + 1) % pQueue->nbMessages;
+    pQueue->count--;
+    ExitCritical();
+    return OS_NO_ERROR;
+  }
+
+  tcb = TCBRunning;
+  tcb->message = message;
+  Wait(OS_STATE_QUEUE, &pQueue->waitList, timeout);
+  Schedule();
+  ExitCritical();
+
+  //Running again, with the message copied in by OS_QueuePost, or timed out
+  return tcb->timedOut ? OS_TIMEOUT : OS_NO_ERROR;
+}
+
+/*! @brief Creates an event flag group.
+ *
+ *  @param flags is the flags that are set to begin with.
+ *  @return OS_FLAGS* - The flag group, or NULL if there are no more flag groups.
+ */
+OS_FLAGS* OS_FlagsCreate(const uint32_t flags)
+{
+  OS_FLAGS *pFlags = (OS_FLAGS*) 0;
+
+  EnterCritical();
+  if (NextFlagsFree < OS_MAX_FLAGS)
+  {
+    pFlags = &FlagsTable[NextFlagsFree++];
+    pFlags->flags = flags;
+    pFlags->waitList = 0;
+  }
+  ExitCritical();
+  return pFlags;
+}
+
+/*! @brief Sets flags in a flag group.
+ *
+ *  Readies every waiting thread whose wait the flags satisfy, highest priority first, clearing the
+ *  flags it waited for; a flag two threads wait for only readies the higher priority one.
+ *  @param pFlags is the flag group.
+ *  @param flags is the flags to set.
+ *  @note Can be called from an ISR.
+ */
+void OS_FlagsSet(OS_FLAGS* const pFlags, const uint32_t flags)
+{
+  uint32_t waiting, got;
+  uint8_t priority;
+  TTCB *tcb;
+
+  EnterCritical();
+  pFlags->flags |= flags;
+  for (waiting = pFlags->waitList; waiting; waiting &= ~PRIORITY_BIT(priority))
+  {
+    priority = HighestPriority(waiting);
+    tcb = &TCBTable[priority];
+    got = pFlags->flags & tcb->flags;
+    if (tcb->all ? (got == tcb->flags) : (got != 0))
+    {
+      pFlags->flags &= ~got;
+      tcb->flags = got;
+      MakeReady(priority, false);
+    }
+  }
+  Schedule();
+  ExitCritical();
+}
+
+/*! @brief Waits for any or all of some flags of a flag group, and clears them.
+ *
+ *  @param pFlags is the flag group.
+ *  @param flags is the flags to wait for.
+ *  @param all is TRUE to wait for all of the flags, FALSE for any of them.
+ *  @param timeout is the clock ticks to wait for, or 0 to wait for ever.
+ *  @param ready is where the flags that were set, out of flags, are written; 0 on a timeout.
+ *  @return OS_ERROR - OS_NO_ERROR, or OS_TIMEOUT if the flags were not set in time.
+ *  @note Must not be called from inside a critical section, where the thread cannot be switched out.
+ */
+OS_ERROR OS_FlagsWait(OS_FLAGS* const pFlags, const uint32_t flags, const bool all, const uint32_t timeout, uint32_t* const ready)
+{
+  uint32_t got;
+  TTCB *tcb;
+
+  EnterCritical();
+  got = pFlags->flags & flags;
+  if (all ? (got == flags) : (got != 0))
+  {
+    pFlags->flags &= ~got;
+    ExitCritical();
+    *ready = got;
+    return OS_NO_ERROR;
+  }
+
+  tcb = TCBRunning;
+  tcb->flags = flags;
+  tcb->all = all;
+  Wait(OS_STATE_FLAGS, &pFlags->waitList, timeout);
+  Schedule();
+  ExitCritical();
+
+  //Running again, with the flags OS_FlagsSet found, or timed out
+  *ready = tcb->timedOut ? 0 : tcb->flags;
+  return tcb->timedOut ? OS_TIMEOUT : OS_NO_ERROR;
+}
+
+/*! @brief Starts the OS multithreading.
+ *
+ *  @note OS_Init() must be called prior to calling OS_Start().
+ *  OS_Start() will never return to its caller, and does nothing if multithreading has already started.
+ */
+void OS_Start(void)
+{
+  if (Started)
+  {
+    return;
+  }
+  Started = true;
+  OSPort_Start();
+}
+
+/*! @brief Creates a thread so it can be managed by the RTOS.
+ *
+ *  @param thread is a pointer to the thread's code.
+ *  @param pData is passed to the thread.
+ *  @param pStack is a pointer to the thread's top-of-stack.
+ *  @param priority is the thread's unique priority, lower numbers first.
+ *  @return OS_ERROR - OS_NO_ERROR, OS_PRIORITY_EXISTS or OS_PRIORITY_INVALID.
+ *  @note A thread cannot be created by an ISR.
+ */
+OS_ERROR OS_ThreadCreate(void (*thread)(void* pd), void* pData, void* pStack, const uint8_t priority)
+{
+  return Create(thread, pData, (uint32_t*) 0, 0, pStack, priority);
+}
+
+/*! @brief Creates a thread with a painted stack whose usage is tracked.
+ *
+ *  @param thread is a pointer to the thread's code.
+ *  @param pData is passed to the thread.
+ *  @param stack is a pointer to the bottom of the thread's stack.
+ *  @param stackSize is the number of words in the stack.
+ *  @param priority is the thread's unique priority, lower numbers first.
+ *  @return OS_ERROR - OS_NO_ERROR, OS_PRIORITY_EXISTS or OS_PRIORITY_INVALID.
+ *  @note A thread cannot be created by an ISR.
+ */
+OS_ERROR OS_ThreadCreateStack(void (*thread)(void* pd), void* pData, uint32_t* const stack, const uint32_t stackSize, const uint8_t priority)
+{
+  return Create(thread, pData, stack, stackSize, &stack[stackSize - 1], priority);
+}
+
+/*! @brief Gets the stack usage of a thread.
+ *
+ *  @param priority is the thread's priority.
+ *  @param info is where the usage is written.
+ *  @return bool - TRUE if the thread exists.
+ */
+bool OS_StackInfo(const uint8_t priority, OS_STACK_INFO* const info)
+{
+  bool exists;
+
+  if (priority > OS_LOWEST_PRIORITY)
+  {
+    return false;
+  }
+
+  EnterCritical();
+  exists = (TCBTable[priority].state != OS_STATE_DORMANT);
+  *info = TCBTable[priority].stack;
+  ExitCritical();
+  return exists;
+}
+
+/*! @brief Deletes a thread, returning it to the dormant state.
+ *
+ *  @param priority is the thread's priority, or OS_PRIORITY_SELF for the calling thread.
+ *  @return OS_ERROR - OS_NO_ERROR, OS_THREAD_DELETE_ERROR, OS_THREAD_DELETE_IDLE,
+ *          OS_PRIORITY_INVALID or OS_THREAD_DELETE_ISR.
+ */
+OS_ERROR OS_ThreadDelete(uint8_t priority)
+{
+  TTCB *tcb;
+
+  if (ISRNestLevel)
+  {
+    return OS_THREAD_DELETE_ISR;
+  }
+  if (priority == OS_PRIORITY_SELF)
+  {
+    priority = Priority(TCBRunning);
+  }
+  if (priority == OS_LOWEST_PRIORITY)
+  {
+    return OS_THREAD_DELETE_IDLE;
+  }
+  if (priority > OS_LOWEST_PRIORITY)
+  {
+    return OS_PRIORITY_INVALID;
+  }
+
+  tcb = &TCBTable[priority];
+  EnterCritical();
+  if (tcb->state == OS_STATE_DORMANT)
+  {
+    ExitCritical();
+    return OS_THREAD_DELETE_ERROR;
+  }
+  MakeReady(priority, false); //Off any wait list
+  ReadyList &= ~PRIORITY_BIT(priority);
+  tcb->state = OS_STATE_DORMANT;
+  Schedule();
+  ExitCritical();
+  return OS_NO_ERROR;
+}
+
+/*! @brief Delays the calling thread.
+ *
+ *  @param ticks is the clock ticks to delay for; 0 returns at once.
+ */
+void OS_TimeDelay(const uint32_t ticks)
+{
+  if (!ticks)
+  {
+    return;
+  }
+
+  EnterCritical();
+  Block(OS_STATE_DELAYED, ticks);
+  Schedule();
+  ExitCritical();
+}
+
+/*! @brief Gets the system clock.
+ *
+ *  @return uint32_t - Clock ticks since OS_Init or OS_TimeSet.
+ */
+uint32_t OS_TimeGet(void)
+{
+  return Ticks;
+}
+
+/*! @brief Sets the system clock.
+ *
+ *  @param ticks is the new clock, in ticks.
+ */
+void OS_TimeSet(const uint32_t ticks)
+{
+  Ticks = ticks;
+}
+
+/*! @brief Hands over from the running thread to the highest priority ready thread.
+ *
+ *  Called by the port with interrupts disabled.
+ *  @param stackPointer is where the running thread's context was saved, or NULL if there is no
+ *         running thread yet.
+ *  @return void* - The stack pointer of the thread to resume.
+ */
+void* OS_ContextSwitch(void* const stackPointer)
+{
+  if (stackPointer)
+  {
+    TCBRunning->stackPointer = stackPointer;
+    if (TCBRunning->stackBottom && (*TCBRunning->stackBottom != STACK_CANARY))
+    {
+      TCBRunning->stack.overflowed = true;
+    }
+  }
+  Charge();
+  TCBRunning = &TCBTable[HighestPriority(ReadyList)];
+  TCBRunning->load.count++;
+  return TCBRunning->stackPointer;
+}
+
+/*! @brief Gets the processor time a thread has used.
+ *
+ *  @param priority is the thread's priority.
+ *  @param load is where the time is written.
+ *  @return bool - TRUE if the thread has run or exists.
+ */
+bool OS_LoadThread(const uint8_t priority, OS_LOAD* const load)
+{
+  if (priority > OS_LOWEST_PRIORITY)
+  {
+    return false;
+  }
+
+  EnterCritical();
+  Charge(); //Up to date for the running thread
+  *load = TCBTable[priority].load;
+  ExitCritical();
+  return load->count || (TCBTable[priority].state != OS_STATE_DORMANT);
+}
+
+/*! @brief Gets the processor time spent in ISRs.
+ *
+ *  @param load is where the time is written.
+ */
+void OS_LoadISR(OS_LOAD* const load)
+{
+  EnterCritical();
+  Charge();
+  *load = ISRLoad;
+  ExitCritical();
+}
+
+/*! @brief Starts the processor time of every thread and of the ISRs again from 0.
+ */
+void OS_LoadClear(void)
+{
+  uint8_t priority;
+
+  EnterCritical();
+  Charge();
+  for (priority = 0; priority <= OS_LOWEST_PRIORITY; priority++)
+  {
+    TCBTable[priority].load = (OS_LOAD) { 0 };
+  }
+  ISRLoad = (OS_LOAD) { 0 };
+  ExitCritical();
+}
+
+/*! @brief Moves the OS clock on a tick.
+ *
+ *  Readies the threads whose delay or semaphore timeout has run out.
+ *  Called by the port's tick interrupt, between OS_ISREnter and OS_ISRExit.
+ */
+void OS_Tick(void)
+{
+  uint32_t delayed;
+  uint8_t priority;
+
+  EnterCritical();
+  Ticks++;
+  for (delayed = DelayedList; delayed; delayed &= ~PRIORITY_BIT(priority))
+  {
+    priority = HighestPriority(delayed);
+    if (!--TCBTable[priority].delay)
+    {
+      MakeReady(priority, true);
+    }
+  }
+  ExitCritical();
+}
+
+/*!
+ ** @}
+ */
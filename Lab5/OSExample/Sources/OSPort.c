@@ -0,0 +1,182 @@
+/*! @file
+ *
+ *  @brief The Cortex-M4F port of the RTOS.
+ *
+ *  Threads run on the process stack and interrupts on the main stack. Context switches are made
+ *  in the PendSV exception, which has the lowest priority so it only runs once every other
+ *  interrupt has finished. A thread's floating point registers are only saved when it has used
+ *  the FPU since it was switched in: the core stacks S0-S15 lazily on exception entry, and
+ *  the switch saves S16-S31 only if the exception return value says there is a floating point frame.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup osport_module OS port module documentation
+ **  @{
+ */
+#include "OSPort.h"
+#include "OS.h"
+#include "MK70F12.h"
+#include "LEDs.h"
+
+#define INITIAL_XPSR 0x01000000u		/*!< Thumb state */
+#define INITIAL_EXC_RETURN 0xFFFFFFFDu		/*!< Thread mode, process stack, no floating point frame */
+#define PENDSV_PRIORITY 0xF0u			/*!< The lowest */
+#define SYSTICK_PRIORITY 0xE0u
+#define DEMCR_TRCENA_MASK 0x01000000u		/*!< Enables the DWT, ARMv7-M ARM C1.6.5 */
+#define DWT_CTRL_CYCCNTENA_MASK 0x00000001u	/*!< Enables DWT_CYCCNT */
+
+static bool ToggleLED;
+static uint32_t ToggleCount;
+
+/*! @brief Where a thread that returns ends up.
+ */
+static void ThreadExit(void)
+{
+  (void) OS_ThreadDelete(OS_PRIORITY_SELF);
+  for (;;) {}
+}
+
+/*! @brief Sets up the tick interrupt and the context switch.
+ *
+ *  Also starts the DWT cycle counter, which the rest of the firmware reads as DWT_CYCCNT.
+ *  @param cpuCoreClk is the CPU core clock frequency in Hz.
+ *  @param toggleLED is TRUE to flash the orange LED every half second from the tick.
+ */
+void OSPort_Init(const uint32_t cpuCoreClk, const bool toggleLED)
+{
+  ToggleLED = toggleLED;
+  ToggleCount = 0;
+
+  SCB_SHPR3 = (SCB_SHPR3 & ~(SCB_SHPR3_PRI_14_MASK | SCB_SHPR3_PRI_15_MASK))
+      | SCB_SHPR3_PRI_14(PENDSV_PRIORITY) | SCB_SHPR3_PRI_15(SYSTICK_PRIORITY);
+
+  SYST_CSR = 0;
+  SYST_RVR = (cpuCoreClk / OS_TICK_HZ) - 1;
+  SYST_CVR = 0;
+  SYST_CSR = SysTick_CSR_CLKSOURCE_MASK | SysTick_CSR_TICKINT_MASK | SysTick_CSR_ENABLE_MASK;
+
+  //The cycle counter, for the load accounting, the profiler and the I2C timeouts
+  DEMCR |= DEMCR_TRCENA_MASK;
+  DWT_CTRL |= DWT_CTRL_CYCCNTENA_MASK;
+}
+
+/*! @brief Builds the stack of a thread that has not run yet.
+ *
+ *  The stack is made to look as if the thread had been switched out: the frame the core stacks
+ *  on exception entry, below it R4-R11 and the exception return value.
+ *  @param thread is the thread's code.
+ *  @param pData is passed to the thread.
+ *  @param pStack is the thread's top-of-stack.
+ *  @return void* - The stack pointer the thread is first resumed from.
+ */
+void* OSPort_StackInit(void (*thread)(void* pd), void* const pData, void* const pStack)
+{
+  //pStack is the last word of the stack; the core needs the stack pointer 8-byte aligned
+  uint32_t *sp = (uint32_t*) (((uint32_t) pStack + sizeof(uint32_t)) & ~0x7u);
+  uint8_t i;
+
+  *--sp = INITIAL_XPSR;
+  *--sp = (uint32_t) thread;			//PC
+  *--sp = (uint32_t) ThreadExit;		//LR
+  for (i = 0; i < 4; i++)
+  {
+    *--sp = 0;					//R12, R3, R2, R1
+  }
+  *--sp = (uint32_t) pData;			//R0
+  *--sp = INITIAL_EXC_RETURN;
+  for (i = 0; i < 8; i++)
+  {
+    *--sp = 0;					//R11 to R4
+  }
+  return sp;
+}
+
+/*! @brief Runs the first thread.
+ *
+ *  A process stack pointer of 0 tells the context switch there is no thread to save.
+ *  @note Never returns.
+ */
+void OSPort_Start(void)
+{
+  __asm volatile ("msr psp, %0" : : "r" (0));
+  SCB_ICSR = SCB_ICSR_PENDSVSET_MASK;
+  OS_EnableInterrupts();
+  for (;;) {}
+}
+
+/*! @brief Asks for a context switch.
+ *
+ *  Pends PendSV, which runs once the caller's critical section and any interrupts have ended.
+ */
+void OSPort_Switch(void)
+{
+  SCB_ICSR = SCB_ICSR_PENDSVSET_MASK;
+}
+
+/*! @brief Called over and over by the idle thread.
+ */
+void OSPort_Idle(void)
+{
+}
+
+/*! @brief Gets a free-running count of processor cycles, for the load accounting.
+ *
+ *  @return uint32_t - DWT_CYCCNT, which wraps every 86 s at 50 MHz.
+ */
+uint32_t OSPort_Cycles(void)
+{
+  return DWT_CYCCNT;
+}
+
+/*! @brief Interrupt service routine for PendSV, which switches threads.
+ *
+ *  Saves the running thread's R4-R11, its S16-S31 if it has a floating point frame, and the
+ *  exception return value on its stack, then restores the next thread's the same way.
+ */
+__asm (
+  "  .text\n"
+  "  .syntax unified\n"
+  "  .fpu fpv4-sp-d16\n"
+  "  .thumb\n"
+  "  .global OS_ContextSwitchISR\n"
+  "  .type OS_ContextSwitchISR, %function\n"
+  "  .thumb_func\n"
+  "OS_ContextSwitchISR:\n"
+  "  cpsid i\n"
+  "  mrs r0, psp\n"
+  "  cbz r0, 1f\n"			//No thread to save on the first switch
+  "  tst lr, #0x10\n"
+  "  it eq\n"
+  "  vstmdbeq r0!, {s16-s31}\n"
+  "  stmdb r0!, {r4-r11, lr}\n"
+  "1:\n"
+  "  bl OS_ContextSwitch\n"
+  "  ldmia r0!, {r4-r11, lr}\n"
+  "  tst lr, #0x10\n"
+  "  it eq\n"
+  "  vldmiaeq r0!, {s16-s31}\n"
+  "  msr psp, r0\n"
+  "  cpsie i\n"
+  "  bx lr\n"
+  "  .size OS_ContextSwitchISR, .-OS_ContextSwitchISR\n"
+);
+
+/*! @brief Interrupt service routine for the SysTick, the OS clock.
+ */
+void __attribute__ ((interrupt)) OS_SysTickISR(void)
+{
+  OS_ISREnter();
+  OS_Tick();
+  if (ToggleLED && (++ToggleCount == OS_TICK_HZ / 2))
+  {
+    ToggleCount = 0;
+    LEDs_Toggle(LED_ORANGE);
+  }
+  OS_ISRExit();
+}
+
+/*!
+ ** @}
+ */
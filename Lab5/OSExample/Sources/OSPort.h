@@ -0,0 +1,85 @@
+/*! @file
+ *
+ *  @brief The processor specific part of the RTOS.
+ *
+ *  OS.c is the portable kernel, and calls these to build thread stacks and switch between threads.
+ *  OSPort.c is the port for the Cortex-M4F of the K70; Test_Programs/OSBench has one for Linux.
+ *  A thread's stack pointer is opaque to the kernel: it is whatever the port needs to resume the
+ *  thread.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup osport_module OS port module documentation
+ **  @{
+ */
+#ifndef OSPORT_H
+#define OSPORT_H
+
+// new types
+#include "types.h"
+
+#define OS_TICK_HZ 100		/*!< OS clock ticks per second */
+
+/*! @brief Sets up the tick interrupt and the context switch.
+ *
+ *  Also starts the DWT cycle counter, which the rest of the firmware reads as DWT_CYCCNT.
+ *  @param cpuCoreClk is the CPU core clock frequency in Hz.
+ *  @param toggleLED is TRUE to flash the orange LED every half second from the tick.
+ */
+void OSPort_Init(const uint32_t cpuCoreClk, const bool toggleLED);
+
+/*! @brief Builds the stack of a thread that has not run yet.
+ *
+ *  @param thread is the thread's code.
+ *  @param pData is passed to the thread.
+ *  @param pStack is the thread's top-of-stack.
+ *  @return void* - The stack pointer the thread is first resumed from.
+ */
+void* OSPort_StackInit(void (*thread)(void* pd), void* const pData, void* const pStack);
+
+/*! @brief Runs the first thread.
+ *
+ *  The thread is the one OS_ContextSwitch picks.
+ *  @note Never returns.
+ */
+void OSPort_Start(void);
+
+/*! @brief Asks for a context switch.
+ *
+ *  Called by the kernel, outside of any interrupt, when a thread other than the running one
+ *  should run. The switch may happen later, once the caller's critical section ends.
+ */
+void OSPort_Switch(void);
+
+/*! @brief Called over and over by the idle thread.
+ */
+void OSPort_Idle(void);
+
+/*! @brief Gets a free-running count of processor cycles, for the load accounting.
+ *
+ *  @return uint32_t - The count, which may wrap.
+ *  @note Called on every context switch and outermost interrupt, so it must be fast.
+ */
+uint32_t OSPort_Cycles(void);
+
+/*! @brief Hands over from the running thread to the highest priority ready thread.
+ *
+ *  Called by the port with interrupts disabled.
+ *  @param stackPointer is where the running thread's context was saved, or NULL if there is no
+ *         running thread yet.
+ *  @return void* - The stack pointer of the thread to resume.
+ */
+void* OS_ContextSwitch(void* const stackPointer);
+
+/*! @brief Moves the OS clock on a tick.
+ *
+ *  Called by the port's tick interrupt, between OS_ISREnter and OS_ISRExit.
+ */
+void OS_Tick(void);
+
+/*!
+ ** @}
+ */
+#endif
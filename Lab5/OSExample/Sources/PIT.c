@@ -14,124 +14,201 @@
 #include "PIT.h"
 #include "MK70F12.h"
 #include "OS.h"
-#include "LEDs.h"
+#include "Cpu.h"
+#include "PE_Types.h"
 #include "types.h"
 
 static uint32_t PIT_moduleClk;
-static void * PITArguments; //pointer to userArguments funtion
-static void (*PITCallback)(void *); //pointer to userCallback function
+static volatile uint32_t LifetimeHigh; //Wraps of the lifetime channel, the high half of the lifetime counter
+static OS_FLAGS* ChannelFlags[PIT_NB_CHANNELS]; //The flag group a channel sets instead of signalling its semaphore, or NULL
+static uint32_t ChannelMask[PIT_NB_CHANNELS];
 
 /*! @brief Sets up the PIT before first use.
  *
- *  Enables the PIT and freezes the timer when debugging.
+ *  Enables the PIT, freezes the timer when debugging and starts the lifetime counter.
  *  @param moduleClk The module clock rate in Hz.
- *  @param userFunction is a pointer to a user callback function.
- *  @param userArguments is a pointer to the user arguments to use with the user callback function.
  *  @return bool - TRUE if the PIT was successfully initialized.
- *  @note Assumes that moduleClk has a period which can be expressed as an integral number of nanoseconds.
  */
-bool PIT_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments)
+bool PIT_Init(const uint32_t moduleClk)
 {
+  uint8_t channelNb;
 
-  PITSemaphore = OS_SemaphoreCreate(0); //Create PIT Semaphore
+  for (channelNb = 0; channelNb < PIT_NB_CHANNELS; channelNb++)
+  {
+    PITSemaphore[channelNb] = OS_SemaphoreCreate(0); //Create PIT Semaphores
+    if (!PITSemaphore[channelNb])
+    {
+      return false;
+    }
+    ChannelFlags[channelNb] = NULL;
+  }
 
-  PITArguments = userArguments; //Globally accessible (userArguments)
-  PITCallback = userFunction; //Globally accessible (userFunction)
   PIT_moduleClk = moduleClk;
+  LifetimeHigh = 0;
 
   SIM_SCGC6 |= SIM_SCGC6_PIT_MASK;  // Enable clock gate PIT
   //PIT_MCR - PIT Module Control Register | pg1340/2275 K70Manual
-  //PIT_MCR &= ~PIT_MCR_MDIS_MASK; //module disable - enabled to allow any kind of setup to PIT
-  //PIT_MCR = PIT_MCR_FRZ_MASK; //freeze timer in debug module
-
   PIT_MCR |= PIT_MCR_MDIS_MASK;
 
   // Initialise NVICs for PIT | pg 97/2275 k70 manual
-  //IRQ 68(seconds interrupt) mod 32 for channel 0 ??? why channel 0?
-  NVICICPR2 =  (1 << 4);	 //clears pending  interrupts on PIT channel 0 using IRQ value
-  NVICISER2 =  (1 << 4);  //sets/enables interrupts from PIT channel 0
+  //IRQs 68 to 71 are channels 0 to 3, bits 4 to 7 of the third NVIC register
+  NVICICPR2 = (0xF << 4);	 //clears pending interrupts on the PIT channels using IRQ value
+  NVICISER2 = (0xF << 4);  //sets/enables interrupts from the PIT channels
 
   PIT_MCR &= ~PIT_MCR_MDIS_MASK; //module disable - enabled to allow any kind of setup to PIT
+  PIT_MCR |= PIT_MCR_FRZ_MASK;   //freeze timers in debug mode
 
-  //Enable interrupts
-  //PIT_TCTRL0 - Timer Control Register |TIE - Timer Interrupt Enable |pg 1343/2275 k70 manual
-  PIT_TCTRL0 |= PIT_TCTRL_TIE_MASK; //enable interrupts for PIT-channel 0
-
-
-  //PIT_Enable(true);
+  //The K70 PIT cannot chain channels, so the lifetime channel free-runs over the whole 32-bit range
+  //and its wraps are counted in LifetimeHigh
+  PIT_TCTRL(PIT_LIFETIME_CHANNEL) = 0;
+  PIT_TFLG(PIT_LIFETIME_CHANNEL) = PIT_TFLG_TIF_MASK;
+  PIT_LDVAL(PIT_LIFETIME_CHANNEL) = PIT_LDVAL_TSV(0xFFFFFFFFu);
+  PIT_TCTRL(PIT_LIFETIME_CHANNEL) = PIT_TCTRL_TIE_MASK | PIT_TCTRL_TEN_MASK;
 
   return true;
 }
 
-/*! @brief Sets the value of the desired period of the PIT.
+/*! @brief Sets the value of the desired period of a PIT channel.
  *
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
  *  @param period The desired value of the timer period in nanoseconds.
  *  @param restart TRUE if the PIT is disabled, a new value set, and then enabled.
  *                 FALSE if the PIT will use the new value after a trigger event.
- *  @note The function will enable the timer and interrupts for the PIT.
+ *  @return bool - TRUE if the period was set.
+ *  @note The function will enable interrupts for the channel, and the timer if restart is TRUE.
  */
-void PIT_Set(const uint32_t period, const bool restart)
+bool PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart)
 {
   //pg 1346/2275 K70 Manual
-  uint32_t  freqHz = 1e9 / period;
-  uint32_t cycleCount = PIT_moduleClk / freqHz;
-  uint32_t triggerVal = cycleCount - 1;
+  //Integer maths, so periods that are not a whole number of Hz (e.g. 1.5625 Hz) are kept exact
+  const uint32_t cycleCount = (uint32_t) (((uint64_t) period * PIT_moduleClk) / 1000000000u);
+
+  if ((channelNb >= PIT_NB_CHANNELS) || (channelNb == PIT_LIFETIME_CHANNEL) || !cycleCount)
+  {
+    return false;
+  }
 
   //TSV - Timer Start Value.
-  PIT_LDVAL0 = PIT_LDVAL_TSV(triggerVal); //timer LOad Value registers
+  PIT_LDVAL(channelNb) = PIT_LDVAL_TSV(cycleCount - 1); //timer LOad Value registers
+  //TIE - Timer Interrupt Enable |pg 1343/2275 k70 manual
+  PIT_TCTRL(channelNb) |= PIT_TCTRL_TIE_MASK;
 
   if (restart)
   {
-    PIT_Enable(false);
-    PIT_Enable(true);
+    PIT_Enable(channelNb, false);
+    PIT_Enable(channelNb, true);
+  }
+  return true;
+}
+
+/*! @brief Has a PIT channel set flags in a flag group when it times out, instead of signalling its semaphore.
+ *
+ *  A thread can then wait on the channel together with other interrupts.
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
+ *  @param flags The flag group, or NULL to go back to the channel's semaphore.
+ *  @param mask The flags to set.
+ *  @return bool - TRUE if the channel is valid.
+ */
+bool PIT_SetFlags(const uint8_t channelNb, OS_FLAGS* const flags, const uint32_t mask)
+{
+  if ((channelNb >= PIT_NB_CHANNELS) || (channelNb == PIT_LIFETIME_CHANNEL))
+  {
+    return false;
   }
+
+  EnterCritical();
+  ChannelFlags[channelNb] = flags;
+  ChannelMask[channelNb] = mask;
+  ExitCritical();
+  return true;
 }
 
-/*! @brief Enables or disables the PIT.
+/*! @brief Enables or disables a PIT channel.
  *
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
  *  @param enable - TRUE if the PIT is to be enabled, FALSE if the PIT is to be disabled.
  */
-void PIT_Enable(const bool enable)
+void PIT_Enable(const uint8_t channelNb, const bool enable)
 {
+  if ((channelNb >= PIT_NB_CHANNELS) || (channelNb == PIT_LIFETIME_CHANNEL))
+  {
+    return;
+  }
+
   if (enable == true)
   {
-    PIT_TCTRL0 |= PIT_TCTRL_TEN_MASK;
+    PIT_TCTRL(channelNb) |= PIT_TCTRL_TEN_MASK;
   }
   else
   {
-    PIT_TCTRL0 &= ~PIT_TCTRL_TEN_MASK;
+    PIT_TCTRL(channelNb) &= ~PIT_TCTRL_TEN_MASK;
+  }
+}
+
+/*! @brief Gets the lifetime counter.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - Module clock cycles since PIT_Init.
+ */
+uint64_t PIT_Lifetime(void)
+{
+  uint32_t high, low;
+
+  EnterCritical();
+  low = PIT_CVAL(PIT_LIFETIME_CHANNEL);
+  high = LifetimeHigh;
+  //A wrap the ISR has not carried yet, maybe one just after the count was read, so read the count again
+  if (PIT_TFLG(PIT_LIFETIME_CHANNEL) & PIT_TFLG_TIF_MASK)
+  {
+    low = PIT_CVAL(PIT_LIFETIME_CHANNEL);
+    high++;
   }
+  ExitCritical();
+
+  //The channel counts down
+  return ((uint64_t) high << 32) | (0xFFFFFFFFu - low);
 }
 
 /*! @brief Interrupt service routine for the PIT.
  *
- *  The periodic interrupt timer has timed out.
- *  The user callback function will be called.
+ *  Serves every PIT channel: a timed out channel sets its flags or signals its semaphore, and a wrap of the
+ *  lifetime channel is carried into the high half of the lifetime counter.
  *  @note Assumes the PIT has been initialized.
  */
 void __attribute__ ((interrupt)) PIT_ISR(void)
 {
+  uint8_t channelNb;
+
   OS_ISREnter();
-  PIT_TFLG0 |= PIT_TFLG_TIF_MASK; //Acknowledge interrupt
-  OS_SemaphoreSignal(PITSemaphore); //Signal PIT Semaphore
+  for (channelNb = 0; channelNb < PIT_NB_CHANNELS; channelNb++)
+  {
+    if ((PIT_TCTRL(channelNb) & PIT_TCTRL_TIE_MASK) && (PIT_TFLG(channelNb) & PIT_TFLG_TIF_MASK))
+    {
+      if (channelNb == PIT_LIFETIME_CHANNEL)
+      {
+	//Together, so PIT_Lifetime from a higher priority interrupt never sees the flag cleared but not carried
+	EnterCritical();
+	PIT_TFLG(channelNb) = PIT_TFLG_TIF_MASK; //Acknowledge interrupt
+	LifetimeHigh++;
+	ExitCritical();
+      }
+      else
+      {
+	PIT_TFLG(channelNb) = PIT_TFLG_TIF_MASK; //Acknowledge interrupt
+	if (ChannelFlags[channelNb])
+	{
+	  OS_FlagsSet(ChannelFlags[channelNb], ChannelMask[channelNb]);
+	}
+	else
+	{
+	  OS_SemaphoreSignal(PITSemaphore[channelNb]); //Signal the channel's semaphore
+	}
+      }
+    }
+  }
   OS_ISRExit();
-
-//  if (PITCallback)
-//  {
-//    (*PITCallback)(PITArguments);
-//  }
-
 }
 
-
-
-
-
-
-
-
-
-
 /*!
  ** @}
  */
@@ -3,6 +3,9 @@
  *  @brief Routines for controlling Periodic Interrupt Timer (PIT) on the TWR-K70F120M.
  *
  *  This contains the functions for operating the periodic interrupt timer (PIT).
+ *  Each channel signals its own semaphore when it times out, or sets flags in a flag group if
+ *  PIT_SetFlags has been called for it. PIT_LIFETIME_CHANNEL is kept
+ *  by the driver as a 64-bit count of module clock cycles since PIT_Init.
  *
  *  @author PMcL
  *  @date 2015-08-22
@@ -18,38 +21,62 @@
 #include "types.h"
 #include "OS.h"
 
-OS_ECB *PITSemaphore; //Semaphore for PIT Thread
+#define PIT_NB_CHANNELS 4
+
+// Channel assignments
+#define PIT_SAMPLE_CHANNEL 0		/*!< Polls the accelerometer at its output data rate */
+#define PIT_MONITOR_CHANNEL 1		/*!< Supervises the I2C bus */
+#define PIT_LIFETIME_CHANNEL 3		/*!< Free-runs as the low half of the lifetime counter */
+
+OS_ECB *PITSemaphore[PIT_NB_CHANNELS]; //Semaphore for each PIT channel, signalled when the channel times out
 
 /*! @brief Sets up the PIT before first use.
  *
- *  Enables the PIT and freezes the timer when debugging.
+ *  Enables the PIT, freezes the timer when debugging and starts the lifetime counter.
  *  @param moduleClk The module clock rate in Hz.
- *  @param userFunction is a pointer to a user callback function.
- *  @param userArguments is a pointer to the user arguments to use with the user callback function.
  *  @return bool - TRUE if the PIT was successfully initialized.
- *  @note Assumes that moduleClk has a period which can be expressed as an integral number of nanoseconds.
  */
-bool PIT_Init(const uint32_t moduleClk, void (*userFunction)(void*), void* userArguments);
+bool PIT_Init(const uint32_t moduleClk);
 
-/*! @brief Sets the value of the desired period of the PIT.
+/*! @brief Sets the value of the desired period of a PIT channel.
  *
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
  *  @param period The desired value of the timer period in nanoseconds.
  *  @param restart TRUE if the PIT is disabled, a new value set, and then enabled.
  *                 FALSE if the PIT will use the new value after a trigger event.
- *  @note The function will enable the timer and interrupts for the PIT.
+ *  @return bool - TRUE if the period was set.
+ *  @note The function will enable interrupts for the channel, and the timer if restart is TRUE.
+ */
+bool PIT_Set(const uint8_t channelNb, const uint32_t period, const bool restart);
+
+/*! @brief Has a PIT channel set flags in a flag group when it times out, instead of signalling its semaphore.
+ *
+ *  A thread can then wait on the channel together with other interrupts.
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
+ *  @param flags The flag group, or NULL to go back to the channel's semaphore.
+ *  @param mask The flags to set.
+ *  @return bool - TRUE if the channel is valid.
  */
-void PIT_Set(const uint32_t period, const bool restart);
+bool PIT_SetFlags(const uint8_t channelNb, OS_FLAGS* const flags, const uint32_t mask);
 
-/*! @brief Enables or disables the PIT.
+/*! @brief Enables or disables a PIT channel.
  *
+ *  @param channelNb The channel, other than PIT_LIFETIME_CHANNEL.
  *  @param enable - TRUE if the PIT is to be enabled, FALSE if the PIT is to be disabled.
  */
-void PIT_Enable(const bool enable);
+void PIT_Enable(const uint8_t channelNb, const bool enable);
+
+/*! @brief Gets the lifetime counter.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - Module clock cycles since PIT_Init.
+ */
+uint64_t PIT_Lifetime(void);
 
 /*! @brief Interrupt service routine for the PIT.
  *
- *  The periodic interrupt timer has timed out.
- *  The user callback function will be called.
+ *  Serves every PIT channel: a timed out channel sets its flags or signals its semaphore, and a wrap of the
+ *  lifetime channel is carried into the high half of the lifetime counter.
  *  @note Assumes the PIT has been initialized.
  */
 void __attribute__ ((interrupt)) PIT_ISR(void);
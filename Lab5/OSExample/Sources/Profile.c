@@ -0,0 +1,99 @@
+/*! @file
+ *
+ *  @brief Execution time profiling with the DWT cycle counter.
+ *
+ *  This contains the per-site statistics behind PROFILE_BEGIN and PROFILE_END.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup profile_module Profile module documentation
+ **  @{
+ */
+#include "Profile.h"
+#include "MK70F12.h"
+#include "Cpu.h"
+#include "PE_Types.h"
+
+static TProfileStats Stats[PROFILE_NB_SITES];
+static uint32_t Overhead;	/*!< Cycles an empty pair of markers counts */
+
+/*! @brief Measures the cost of the markers themselves.
+ *
+ *  @return bool - TRUE if the profiler was set up.
+ *  @note Assumes that OS_Init has been called; the OS port starts the cycle counter.
+ */
+bool Profile_Init(void)
+{
+  volatile uint32_t start;
+
+  //The same two reads as an empty PROFILE_BEGIN and PROFILE_END
+  start = DWT_CYCCNT;
+  Overhead = DWT_CYCCNT - start;
+
+  Profile_Clear();
+  return true;
+}
+
+/*! @brief Adds a run of a site.
+ *
+ *  Called by PROFILE_END. Safe to call from interrupt service routines.
+ *  @param site is the site.
+ *  @param cycles is the cycles between the markers; the cost of the markers is taken off.
+ */
+void Profile_Record(const TProfileSite site, const uint32_t cycles)
+{
+  const uint32_t net = (cycles > Overhead) ? (cycles - Overhead) : 0;
+  TProfileStats* const stats = &Stats[site];
+
+  EnterCritical();
+  if (!stats->count || (net < stats->min))
+  {
+    stats->min = net;
+  }
+  if (net > stats->max)
+  {
+    stats->max = net;
+  }
+  stats->total += net;
+  stats->count++;
+  ExitCritical();
+}
+
+/*! @brief Gets what is known about a site.
+ *
+ *  @param site is the site.
+ *  @param stats is where the count, minimum, maximum and total go, taken together.
+ *  @return bool - TRUE if the site is valid.
+ */
+bool Profile_Get(const TProfileSite site, TProfileStats* const stats)
+{
+  if (site >= PROFILE_NB_SITES)
+  {
+    return false;
+  }
+
+  EnterCritical();
+  *stats = Stats[site];
+  ExitCritical();
+  return true;
+}
+
+/*! @brief Forgets every run of every site.
+ */
+void Profile_Clear(void)
+{
+  uint8_t site;
+
+  EnterCritical();
+  for (site = 0; site < PROFILE_NB_SITES; site++)
+  {
+    Stats[site] = (TProfileStats) { 0 };
+  }
+  ExitCritical();
+}
+
+/*!
+ ** @}
+ */
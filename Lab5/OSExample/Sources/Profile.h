@@ -0,0 +1,95 @@
+/*! @file
+ *
+ *  @brief Execution time profiling with the DWT cycle counter.
+ *
+ *  PROFILE_BEGIN and PROFILE_END bracket a piece of code, a site, and the core clock cycles between
+ *  them are added to the site's count, minimum, maximum and total. The times are wall-clock, so they
+ *  include any interrupt or higher priority thread that ran in between.
+ *  With PROFILE_ENABLED 0 the markers compile to nothing.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup profile_module Profile module documentation
+ **  @{
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// new types
+#include "types.h"
+
+#ifndef PROFILE_ENABLED
+  #define PROFILE_ENABLED 0	/*!< 1 to build the profiling markers in */
+#endif
+
+/*!
+ * @brief The profiled sites.
+ */
+typedef enum
+{
+  PROFILE_UART_ISR,
+  PROFILE_I2C_ISR,
+  PROFILE_FIFO_PUT,		/*!< With exclusive access, not the waits for it or for space */
+  PROFILE_FIFO_GET,		/*!< With exclusive access, not the waits for it or for data */
+  PROFILE_PACKET_GET,		/*!< Once a byte has arrived */
+  PROFILE_PACKET_HANDLE,
+  PROFILE_HANDLE_MEDIAN_DATA,
+  PROFILE_I2C_POLL_READ,
+  PROFILE_FLASH_WRITE,		/*!< Erase and program of the data phrase */
+  PROFILE_NB_SITES
+} TProfileSite;
+
+/*!
+ * @brief What is known about a site, in core clock cycles.
+ */
+typedef struct
+{
+  uint32_t count;		/*!< Times the site has run */
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;		/*!< Sum of every run, for the mean */
+} TProfileStats;
+
+#if PROFILE_ENABLED
+  #include "MK70F12.h"
+
+  #define PROFILE_BEGIN(site) const uint32_t profileStart##site = DWT_CYCCNT
+  #define PROFILE_END(site) Profile_Record((site), DWT_CYCCNT - profileStart##site)
+#else
+  #define PROFILE_BEGIN(site)
+  #define PROFILE_END(site)
+#endif
+
+/*! @brief Measures the cost of the markers themselves.
+ *
+ *  @return bool - TRUE if the profiler was set up.
+ *  @note Assumes that OS_Init has been called; the OS port starts the cycle counter.
+ */
+bool Profile_Init(void);
+
+/*! @brief Adds a run of a site.
+ *
+ *  Called by PROFILE_END. Safe to call from interrupt service routines.
+ *  @param site is the site.
+ *  @param cycles is the cycles between the markers; the cost of the markers is taken off.
+ */
+void Profile_Record(const TProfileSite site, const uint32_t cycles);
+
+/*! @brief Gets what is known about a site.
+ *
+ *  @param site is the site.
+ *  @param stats is where the count, minimum, maximum and total go, taken together.
+ *  @return bool - TRUE if the site is valid.
+ */
+bool Profile_Get(const TProfileSite site, TProfileStats* const stats);
+
+/*! @brief Forgets every run of every site.
+ */
+void Profile_Clear(void);
+
+/*!
+ ** @}
+ */
+#endif
@@ -17,10 +17,170 @@
 #include "LEDs.h"
 #include <stdint.h>
 #include "OS.h"
+#include "Cpu.h"
+#include "PE_Types.h"
+
+#define SECONDS_PER_DAY 86400u
+#define PRESCALER_BITS 15			// The seconds register counts when the prescaler passes 2^15
+#define LAST_YEAR (RTC_EPOCH_YEAR + 135)	// The last whole year the time seconds register can hold
+#define MAX_STEPS 8				// Seconds the cached date and time is moved on before it is worked out afresh
 
 static void *RTCArguments; //pointer to userArguments funtion
 static void (*RTCCallback)(void *); //pointer to userCallback function
 
+static TRTCDateTime Cache;		/*!< The date and time last read */
+static uint32_t CacheSeconds;		/*!< The time seconds register value Cache is for */
+static bool CacheValid;			/*!< FALSE until the clock has been read, and after it is set */
+
+static const uint8_t DAYS_IN_MONTH[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+/*! @brief Gets whether a year is a leap year.
+ *
+ *  @param year The year.
+ *  @return bool - TRUE for a leap year.
+ */
+static bool IsLeapYear(const uint16_t year)
+{
+  return !(year % 4) && ((year % 100) || !(year % 400));
+}
+
+/*! @brief Gets the days in a month.
+ *
+ *  @param year The year.
+ *  @param month The month (1-12).
+ *  @return uint8_t - The number of days.
+ */
+static uint8_t DaysInMonth(const uint16_t year, const uint8_t month)
+{
+  return DAYS_IN_MONTH[month - 1] + ((month == 2) && IsLeapYear(year));
+}
+
+/*! @brief Gets the days from the epoch to a date.
+ *
+ *  Counts from 1 March, so that the leap day comes last in the year.
+ *  @param year The year.
+ *  @param month The month (1-12).
+ *  @param day The day of the month, from 1.
+ *  @return uint32_t - The number of days since 1 January RTC_EPOCH_YEAR.
+ */
+static uint32_t DaysFromDate(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+  const uint32_t y = (uint32_t) year - (month <= 2);
+  const uint32_t m = (month > 2) ? (month - 3u) : (month + 9u);
+  const uint32_t days = (y * 365) + (y / 4) - (y / 100) + (y / 400) + (((153 * m) + 2) / 5) + (day - 1);
+
+  //The same count for the epoch: 1 January is day 306 of the year that started on 1 March before
+  const uint32_t e = RTC_EPOCH_YEAR - 1u;
+  return days - ((e * 365) + (e / 4) - (e / 100) + (e / 400) + 306);
+}
+
+/*! @brief Works out a date and time from the time seconds register.
+ *
+ *  @param seconds Seconds since the epoch.
+ *  @param dateTime The address of a variable to store the date and time.
+ */
+static void ToDateTime(const uint32_t seconds, TRTCDateTime* const dateTime)
+{
+  uint32_t days = seconds / SECONDS_PER_DAY;
+  uint32_t time = seconds % SECONDS_PER_DAY;
+  uint16_t year = RTC_EPOCH_YEAR;
+  uint8_t month = 1;
+  uint16_t daysInYear;
+
+  dateTime->hours = time / 3600;
+  time %= 3600;
+  dateTime->minutes = time / 60;
+  dateTime->seconds = time % 60;
+
+  //Only done when the cache is cold, so walking the years and months is fast enough
+  for (daysInYear = 365 + IsLeapYear(year); days >= daysInYear; daysInYear = 365 + IsLeapYear(year))
+  {
+    days -= daysInYear;
+    year++;
+  }
+  while (days >= DaysInMonth(year, month))
+  {
+    days -= DaysInMonth(year, month);
+    month++;
+  }
+
+  dateTime->year = year;
+  dateTime->month = month;
+  dateTime->day = days + 1;
+}
+
+/*! @brief Moves a date and time on by a second.
+ *
+ *  @param dateTime The date and time.
+ */
+static void NextSecond(TRTCDateTime* const dateTime)
+{
+  if (++dateTime->seconds < 60)
+  {
+    return;
+  }
+  dateTime->seconds = 0;
+  if (++dateTime->minutes < 60)
+  {
+    return;
+  }
+  dateTime->minutes = 0;
+  if (++dateTime->hours < 24)
+  {
+    return;
+  }
+  dateTime->hours = 0;
+  if (++dateTime->day <= DaysInMonth(dateTime->year, dateTime->month))
+  {
+    return;
+  }
+  dateTime->day = 1;
+  if (++dateTime->month <= 12)
+  {
+    return;
+  }
+  dateTime->month = 1;
+  dateTime->year++;
+}
+
+/*! @brief Reads the time seconds register.
+ *
+ *  The register counts from the 32.768 kHz clock, so it is read until two reads agree (K70 manual pg 1400).
+ *  @return uint32_t - Seconds since the epoch.
+ */
+static uint32_t ReadSeconds(void)
+{
+  uint32_t seconds;
+
+  do
+  {
+    seconds = RTC_TSR;
+  } while (seconds != RTC_TSR);
+
+  return seconds;
+}
+
+/*! @brief Writes the time seconds register, and the prescaler.
+ *
+ *  @param seconds Seconds since the epoch.
+ *  @param startOfSecond TRUE to start the second afresh, FALSE to keep the fraction of a second.
+ */
+static void WriteSeconds(const uint32_t seconds, const bool startOfSecond)
+{
+  //TCE - time counter enable | pg 1395/2275 K70 manual
+  RTC_SR &= ~RTC_SR_TCE_MASK; //disables the time counter
+  if (startOfSecond)
+  {
+    RTC_TPR = 0; //the prescaler can only be written with the counter disabled
+  }
+  RTC_TSR = seconds; //loads in the time seconds registers
+  RTC_SR |= RTC_SR_TCE_MASK; //Enables the time counter
+
+  EnterCritical();
+  CacheValid = false;
+  ExitCritical();
+}
+
 /*! @brief Initializes the RTC before first use.
  *
  *  Sets up the control register for the RTC and locks it.
@@ -95,16 +255,30 @@ bool RTC_Init(void (*userFunction)(void*), void* userArguments)
 void RTC_Set(const uint8_t hours, const uint8_t minutes, const uint8_t seconds)
 {
   uint32_t timeInSeconds = (hours*3600)+(minutes*60)+(seconds); //calculates the value of the real time clock.
-  //TCE - time counter enable | pg 1395/2275 K70 manual
-  RTC_SR &= ~RTC_SR_TCE_MASK; //disables the time counter
-  RTC_TSR = timeInSeconds; //loads in the time seconds registers
+  uint32_t now = ReadSeconds();
 
-  //Not sure of this is needed
-  // RTC_SR &= ~RTC_SR_TOF_MASK;				//!Time overflow flag is set when the time counter is enabled
-  // RTC_SR &= ~RTC_SR_TIF_MASK;				//!The time invalid flag is set on software reset.
+  WriteSeconds(now - (now % SECONDS_PER_DAY) + timeInSeconds, true); //keeps the date
+}
 
-  //TCE - time counter enable | pg 1395/2275 K70 manual
-  RTC_SR |= RTC_SR_TCE_MASK; //Enables the time counter
+/*! @brief Sets the date of the real time clock.
+ *
+ *  The time of day stays the same.
+ *  @param year The year, RTC_EPOCH_YEAR to RTC_EPOCH_YEAR + 135.
+ *  @param month The month (1-12).
+ *  @param day The day of the month, from 1.
+ *  @return bool - TRUE if the date is valid and was set.
+ *  @note Assumes that the RTC module has been initialized.
+ */
+bool RTC_SetDate(const uint16_t year, const uint8_t month, const uint8_t day)
+{
+  if ((year < RTC_EPOCH_YEAR) || (year > LAST_YEAR) || (month < 1) || (month > 12) || (day < 1)
+      || (day > DaysInMonth(year, month)))
+  {
+    return false;
+  }
+
+  WriteSeconds((DaysFromDate(year, month, day) * SECONDS_PER_DAY) + (ReadSeconds() % SECONDS_PER_DAY), false);
+  return true;
 }
 
 /*! @brief Gets the value of the real time clock.
@@ -116,13 +290,62 @@ void RTC_Set(const uint8_t hours, const uint8_t minutes, const uint8_t seconds)
  */
 void RTC_Get(uint8_t* const hours, uint8_t* const minutes, uint8_t* const seconds)
 {
-  uint32_t currentSeconds = RTC_TSR;
-  // Should be reading this twice, checking if the reads match see p 1400 roughly
+  TRTCDateTime dateTime;
+
+  RTC_GetDateTime(&dateTime);
+  *hours = dateTime.hours; //updates the current time value of hours
+  *minutes = dateTime.minutes; //updates the current time value of minutes
+  *seconds = dateTime.seconds; //updates the current time value of seconds
+}
+
+/*! @brief Gets the date and time of the real time clock.
+ *
+ *  The last date and time read is kept, and moved on a second at a time, so reading the clock
+ *  once a second takes no divisions.
+ *  @param dateTime The address of a variable to store the date and time.
+ *  @note Assumes that the RTC module has been initialized.
+ */
+void RTC_GetDateTime(TRTCDateTime* const dateTime)
+{
+  const uint32_t seconds = ReadSeconds();
+
+  EnterCritical();
+  //Unsigned, so a clock that has gone backwards is worked out afresh too
+  if (!CacheValid || (seconds - CacheSeconds > MAX_STEPS))
+  {
+    ToDateTime(seconds, &Cache);
+    CacheSeconds = seconds;
+    CacheValid = true;
+  }
+  while (CacheSeconds != seconds)
+  {
+    NextSecond(&Cache);
+    CacheSeconds++;
+  }
+  *dateTime = Cache;
+  ExitCritical();
+}
+
+/*! @brief Gets the time of the real time clock to a fraction of a second.
+ *
+ *  The seconds and the prescaler are read together, so the two always agree.
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - The time since RTC_EPOCH_YEAR in 1/RTC_TICKS_PER_SECOND s (about 30.5 us).
+ *  @note Assumes that the RTC module has been initialized.
+ */
+uint64_t RTC_GetTimestamp(void)
+{
+  uint32_t seconds, prescaler;
+
+  //Both count from the 32.768 kHz clock; read until neither has moved, so the prescaler cannot
+  //have wrapped after the seconds were read
+  do
+  {
+    seconds = RTC_TSR;
+    prescaler = RTC_TPR;
+  } while ((seconds != RTC_TSR) || (prescaler != RTC_TPR));
 
-  //Link : http://stackoverflow.com/questions/24850738/how-to-convert-total-seconds-value-to-string-in-hours-minutes-seconds-format
-  *hours = (currentSeconds/3600); //updates the current time value of hours
-  *minutes = (currentSeconds % 3600) / 60; //updates the current time value of minutes
-  *seconds = (currentSeconds % 3600) % 60; //updates the current time value of seconds
+  return ((uint64_t) seconds << PRESCALER_BITS) | (prescaler & (RTC_TICKS_PER_SECOND - 1));
 }
 
 /*! @brief Interrupt service routine for the RTC.
@@ -3,6 +3,8 @@
  *  @brief Routines for controlling the Real Time Clock (RTC) on the TWR-K70F120M.
  *
  *  This contains the functions for operating the real time clock (RTC).
+ *  The time seconds register counts seconds from the start of RTC_EPOCH_YEAR, which gives a date as well
+ *  as a time, and the prescaler gives fractions of a second to 1/32768 s.
  *
  *  @author PMcL
  *  @date 2015-08-24
@@ -20,6 +22,22 @@
 
 OS_ECB *RTCSemaphore; //Semaphore for RTC Thread
 
+#define RTC_EPOCH_YEAR 2000		/*!< The time seconds register counts from 00:00:00 on 1 January of this year */
+#define RTC_TICKS_PER_SECOND 32768	/*!< Resolution of RTC_GetTimestamp, the 32.768 kHz oscillator */
+
+/*!
+ * @brief A date and time of day.
+ */
+typedef struct
+{
+  uint16_t year;		/*!< RTC_EPOCH_YEAR to RTC_EPOCH_YEAR + 136 */
+  uint8_t month;		/*!< 1 to 12 */
+  uint8_t day;			/*!< 1 to 31 */
+  uint8_t hours;		/*!< 0 to 23 */
+  uint8_t minutes;		/*!< 0 to 59 */
+  uint8_t seconds;		/*!< 0 to 59 */
+} TRTCDateTime;
+
 /*! @brief Initializes the RTC before first use.
  *
  *  Sets up the control register for the RTC and locks it.
@@ -32,6 +50,7 @@ bool RTC_Init(void (*userFunction)(void*), void* userArguments);
 
 /*! @brief Sets the value of the real time clock.
  *
+ *  The date stays the same.
  *  @param hours The desired value of the real time clock hours (0-23).
  *  @param minutes The desired value of the real time clock minutes (0-59).
  *  @param seconds The desired value of the real time clock seconds (0-59).
@@ -39,6 +58,17 @@ bool RTC_Init(void (*userFunction)(void*), void* userArguments);
  */
 void RTC_Set(const uint8_t hours, const uint8_t minutes, const uint8_t seconds);
 
+/*! @brief Sets the date of the real time clock.
+ *
+ *  The time of day stays the same.
+ *  @param year The year, RTC_EPOCH_YEAR to RTC_EPOCH_YEAR + 135.
+ *  @param month The month (1-12).
+ *  @param day The day of the month, from 1.
+ *  @return bool - TRUE if the date is valid and was set.
+ *  @note Assumes that the RTC module has been initialized.
+ */
+bool RTC_SetDate(const uint16_t year, const uint8_t month, const uint8_t day);
+
 /*! @brief Gets the value of the real time clock.
  *
  *  @param hours The address of a variable to store the real time clock hours.
@@ -48,6 +78,24 @@ void RTC_Set(const uint8_t hours, const uint8_t minutes, const uint8_t seconds);
  */
 void RTC_Get(uint8_t* const hours, uint8_t* const minutes, uint8_t* const seconds);
 
+/*! @brief Gets the date and time of the real time clock.
+ *
+ *  The last date and time read is kept, and moved on a second at a time, so reading the clock
+ *  once a second takes no divisions.
+ *  @param dateTime The address of a variable to store the date and time.
+ *  @note Assumes that the RTC module has been initialized.
+ */
+void RTC_GetDateTime(TRTCDateTime* const dateTime);
+
+/*! @brief Gets the time of the real time clock to a fraction of a second.
+ *
+ *  The seconds and the prescaler are read together, so the two always agree.
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - The time since RTC_EPOCH_YEAR in 1/RTC_TICKS_PER_SECOND s (about 30.5 us).
+ *  @note Assumes that the RTC module has been initialized.
+ */
+uint64_t RTC_GetTimestamp(void);
+
 /*! @brief Interrupt service routine for the RTC.
  *
  *  The RTC has incremented one second.
@@ -0,0 +1,321 @@
+/*! @file
+ *
+ *  @brief Software timers multiplexed on one FTM0 output compare channel.
+ *
+ *  This contains the timing wheel and the tick handler run from the FTM0 interrupt.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup timer_module Timer module documentation
+ **  @{
+ */
+#include "Timer.h"
+#include "FTM.h"
+#include "Cpu.h"
+#include "PE_Types.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define WHEEL_SPAN (1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS))	/*!< Ticks the wheel covers */
+
+static void TickCallback(void *arg);
+
+static TTimer *Wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];	/*!< The running timers, by when they are due */
+static TTimer *Pending;			/*!< Timers taken out of a slot to be moved down or expired */
+static uint32_t Now;			/*!< The last tick handled */
+static uint32_t NbRunning;		/*!< Timers in the wheel */
+static bool Ticking;			/*!< TRUE while the channel interrupts every tick */
+static uint16_t CountsPerTick;		/*!< Whole FTM0 counts in a tick */
+static uint32_t CountsRemainder;	/*!< FTM0 counts per second that do not make a whole count per tick */
+static uint32_t Fraction;		/*!< Counts owed to the tick period so far, in 1/TIMER_TICK_HZ counts */
+
+static TFTMChannel TickChannel = {
+  .channelNb = 0,			//Set by Timer_Init
+  .delayCount = 0,			//Set per tick
+  .timerFunction = TIMER_FUNCTION_OUTPUT_COMPARE,
+  .ioType.outputAction = TIMER_OUTPUT_DISCONNECT,
+  .userFunction = TickCallback,
+  .userArguments = (void*) 0
+};
+
+/*! @brief Gets the FTM0 counts to the next tick.
+ *
+ *  The counts alternate between CountsPerTick and one more, so that ticks average out to TIMER_TICK_HZ.
+ *  @return uint16_t - FTM0 counts.
+ */
+static uint16_t NextTickCounts(void)
+{
+  uint16_t counts = CountsPerTick;
+
+  Fraction += CountsRemainder;
+  if (Fraction >= TIMER_TICK_HZ)
+  {
+    Fraction -= TIMER_TICK_HZ;
+    counts++;
+  }
+  return counts;
+}
+
+/*! @brief Puts a timer in the slot its expiry falls in.
+ *
+ *  @param timer is a stopped timer.
+ *  @note Must be called inside a critical section.
+ */
+static void Link(TTimer* const timer)
+{
+  const uint32_t delta = timer->expiry - Now;
+  TTimer **slot;
+
+  if (delta < (1u << TIMER_WHEEL_BITS))
+  {
+    slot = &Wheel[0][timer->expiry & SLOT_MASK];
+  }
+  else if (delta < (1u << (2 * TIMER_WHEEL_BITS)))
+  {
+    slot = &Wheel[1][(timer->expiry >> TIMER_WHEEL_BITS) & SLOT_MASK];
+  }
+  else if (delta < WHEEL_SPAN)
+  {
+    slot = &Wheel[2][(timer->expiry >> (2 * TIMER_WHEEL_BITS)) & SLOT_MASK];
+  }
+  else
+  {
+    //Beyond the wheel: park in the last level 2 slot, and go round again when it moves down
+    slot = &Wheel[2][((Now >> (2 * TIMER_WHEEL_BITS)) - 1) & SLOT_MASK];
+  }
+
+  timer->next = *slot;
+  if (timer->next)
+  {
+    timer->next->link = &timer->next;
+  }
+  timer->link = slot;
+  *slot = timer;
+}
+
+/*! @brief Takes a timer out of its slot.
+ *
+ *  @param timer is a running timer.
+ *  @note Must be called inside a critical section.
+ */
+static void Unlink(TTimer* const timer)
+{
+  *timer->link = timer->next;
+  if (timer->next)
+  {
+    timer->next->link = timer->link;
+  }
+  timer->next = (TTimer*) 0;
+  timer->link = (TTimer**) 0;
+}
+
+/*! @brief Moves all the timers of a slot to Pending.
+ *
+ *  The timers stay linked, so they can still be stopped while they are pending.
+ *  @param slot is the slot.
+ *  @note Must be called inside a critical section.
+ */
+static void Detach(TTimer** const slot)
+{
+  Pending = *slot;
+  *slot = (TTimer*) 0;
+  if (Pending)
+  {
+    Pending->link = &Pending;
+  }
+}
+
+/*! @brief Moves the timers of a level 1 or 2 slot down to the levels below.
+ *
+ *  @param slot is the slot.
+ *  @note Must be called inside a critical section.
+ */
+static void Cascade(TTimer** const slot)
+{
+  TTimer *timer;
+
+  Detach(slot);
+  while (Pending)
+  {
+    timer = Pending;
+    Unlink(timer);
+    Link(timer);
+  }
+}
+
+/*! @brief Advances the wheel one tick and expires the timers due on it.
+ *
+ *  @note Must be called inside a critical section.
+ */
+static void Tick(void)
+{
+  TTimer *timer;
+
+  Now++;
+  if (!(Now & SLOT_MASK))
+  {
+    if (!((Now >> TIMER_WHEEL_BITS) & SLOT_MASK))
+    {
+      Cascade(&Wheel[2][(Now >> (2 * TIMER_WHEEL_BITS)) & SLOT_MASK]);
+    }
+    Cascade(&Wheel[1][(Now >> TIMER_WHEEL_BITS) & SLOT_MASK]);
+  }
+
+  //Timers started from a user function go into other slots, so the list only shrinks
+  Detach(&Wheel[0][Now & SLOT_MASK]);
+  while (Pending)
+  {
+    timer = Pending;
+    Unlink(timer);
+    if (timer->period)
+    {
+      timer->expiry += timer->period;
+      Link(timer);
+    }
+    else
+    {
+      NbRunning--;
+    }
+
+    if (timer->userFunction)
+    {
+      timer->userFunction(timer->userArguments);
+    }
+    if (timer->semaphore)
+    {
+      (void)OS_SemaphoreSignal(timer->semaphore);
+    }
+  }
+}
+
+/*! @brief Handles the tick compare on the FTM0 channel.
+ *
+ *  Runs every tick that was due since the last compare, then sets the compare for the next tick
+ *  unless no timers are left.
+ *  @param arg is not used.
+ */
+static void TickCallback(void *arg)
+{
+  EnterCritical();
+  do
+  {
+    Tick();
+    if (!NbRunning)
+    {
+      Ticking = false;
+      break;
+    }
+  } while (!FTM_RestartTimer(TickChannel.channelNb, NextTickCounts()));
+  ExitCritical();
+}
+
+/*! @brief Sets up the timer service on an FTM0 channel.
+ *
+ *  @param channelNb is the FTM0 channel to use; the service owns it from now on.
+ *  @param moduleClk is the FTM0 clock rate in Hz.
+ *  @return bool - TRUE if the timer service was set up.
+ *  @note Assumes that FTM_Init has been called.
+ */
+bool Timer_Init(const uint8_t channelNb, const uint32_t moduleClk)
+{
+  //A tick must be at least a count, and short enough to leave room in the 16-bit counter
+  if ((moduleClk < TIMER_TICK_HZ) || ((moduleClk / TIMER_TICK_HZ) > 0x7FFFu))
+  {
+    return false;
+  }
+
+  TickChannel.channelNb = channelNb;
+  CountsPerTick = (uint16_t)(moduleClk / TIMER_TICK_HZ);
+  CountsRemainder = moduleClk % TIMER_TICK_HZ;
+  Fraction = 0;
+  Now = 0;
+  NbRunning = 0;
+  Ticking = false;
+
+  return FTM_Set(&TickChannel);
+}
+
+/*! @brief Starts a timer, or restarts it if it is running.
+ *
+ *  @param timer is the timer.
+ *  @param delay is the ticks to the first expiry, from 1 to TIMER_MAX_TICKS; 0 is taken as 1.
+ *  @param period is the ticks between later expiries, up to TIMER_MAX_TICKS, or 0 for a one-shot timer.
+ *  @return bool - TRUE if the timer was started.
+ *  @note Safe to call from interrupt service routines.
+ */
+bool Timer_Start(TTimer* const timer, const uint32_t delay, const uint32_t period)
+{
+  if ((delay > TIMER_MAX_TICKS) || (period > TIMER_MAX_TICKS))
+  {
+    return false;
+  }
+
+  EnterCritical();
+  if (timer->link)
+  {
+    Unlink(timer);
+  }
+  else
+  {
+    NbRunning++;
+  }
+
+  timer->expiry = Now + (delay ? delay : 1);
+  timer->period = period;
+  Link(timer);
+
+  if (!Ticking)
+  {
+    TickChannel.delayCount = NextTickCounts();
+    Ticking = FTM_StartTimer(&TickChannel);
+  }
+  ExitCritical();
+
+  return true;
+}
+
+/*! @brief Stops a timer.
+ *
+ *  @param timer is the timer.
+ *  @return bool - TRUE if the timer was running.
+ *  @note Safe to call from interrupt service routines.
+ */
+bool Timer_Stop(TTimer* const timer)
+{
+  bool running;
+
+  EnterCritical();
+  running = (timer->link != (TTimer**) 0);
+  if (running)
+  {
+    Unlink(timer);
+    NbRunning--;
+  }
+  ExitCritical();
+
+  return running;
+}
+
+/*! @brief Gets whether a timer is running.
+ *
+ *  @param timer is the timer.
+ *  @return bool - TRUE if the timer is running.
+ */
+bool Timer_IsRunning(const TTimer* const timer)
+{
+  return (timer->link != (TTimer**) 0);
+}
+
+/*! @brief Gets the number of running timers.
+ *
+ *  @return uint32_t - The number of running timers.
+ */
+uint32_t Timer_NbRunning(void)
+{
+  return NbRunning;
+}
+
+/*!
+ ** @}
+ */
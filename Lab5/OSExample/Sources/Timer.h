@@ -0,0 +1,99 @@
+/*! @file
+ *
+ *  @brief Software timers multiplexed on one FTM0 output compare channel.
+ *
+ *  The channel interrupts once per millisecond tick while any timer is running, and is left off
+ *  when none is. Timers sit in a hierarchical timing wheel of TIMER_WHEEL_LEVELS levels of
+ *  TIMER_WHEEL_SLOTS slots: level 0 holds the timers due in the next 64 ticks, one slot per tick,
+ *  level 1 those due in the next 4096 ticks, 64 ticks per slot, and so on. Starting or stopping a
+ *  timer and each expiry take constant time however many timers are running, and the next compare
+ *  is always one tick on. A level 1 or 2 slot is moved down a level once every 64 or 4096 ticks.
+ *
+ *  Timers are allocated by their users, so there is no limit on how many run at once.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup timer_module Timer module documentation
+ **  @{
+ */
+#ifndef TIMER_H
+#define TIMER_H
+
+// new types
+#include "types.h"
+#include "OS.h"
+
+#define TIMER_TICK_HZ 1000		/*!< Timer ticks per second */
+#define TIMER_WHEEL_LEVELS 3
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_MAX_TICKS 0x7FFFFFFFu	/*!< Longest delay or period, about 24 days */
+
+/*!
+ * @brief A software timer.
+ *
+ * Set userFunction, userArguments and semaphore before starting the timer; the other fields belong
+ * to the timer module. A timer that is all zero is stopped.
+ */
+typedef struct TTimer
+{
+  struct TTimer *next;			/*!< The next timer in the same wheel slot */
+  struct TTimer **link;			/*!< The pointer that points at this timer, NULL when the timer is stopped */
+  uint32_t expiry;			/*!< The tick the timer expires on */
+  uint32_t period;			/*!< Ticks between expiries, 0 for a one-shot timer */
+  void (*userFunction)(void*);		/*!< Called on expiry from the FTM0 interrupt, or NULL */
+  void *userArguments;			/*!< The arguments for userFunction */
+  OS_ECB *semaphore;			/*!< Signalled on expiry, or NULL */
+} TTimer;
+
+/*! @brief Sets up the timer service on an FTM0 channel.
+ *
+ *  @param channelNb is the FTM0 channel to use; the service owns it from now on.
+ *  @param moduleClk is the FTM0 clock rate in Hz.
+ *  @return bool - TRUE if the timer service was set up.
+ *  @note Assumes that FTM_Init has been called.
+ */
+bool Timer_Init(const uint8_t channelNb, const uint32_t moduleClk);
+
+/*! @brief Starts a timer, or restarts it if it is running.
+ *
+ *  The timer expires on the delay-th tick from now, which is between delay - 1 and delay ms away,
+ *  then every period ticks after that if period is not 0.
+ *  On expiry the user function is called, then the semaphore is signalled. The user function runs
+ *  in the FTM0 interrupt, so it must be short and only use OS calls that are safe there.
+ *  It may start or stop any timer, including its own.
+ *  @param timer is the timer.
+ *  @param delay is the ticks to the first expiry, from 1 to TIMER_MAX_TICKS; 0 is taken as 1.
+ *  @param period is the ticks between later expiries, up to TIMER_MAX_TICKS, or 0 for a one-shot timer.
+ *  @return bool - TRUE if the timer was started.
+ *  @note Safe to call from interrupt service routines.
+ */
+bool Timer_Start(TTimer* const timer, const uint32_t delay, const uint32_t period);
+
+/*! @brief Stops a timer.
+ *
+ *  @param timer is the timer.
+ *  @return bool - TRUE if the timer was running.
+ *  @note Safe to call from interrupt service routines.
+ */
+bool Timer_Stop(TTimer* const timer);
+
+/*! @brief Gets whether a timer is running.
+ *
+ *  @param timer is the timer.
+ *  @return bool - TRUE if the timer is running.
+ */
+bool Timer_IsRunning(const TTimer* const timer);
+
+/*! @brief Gets the number of running timers.
+ *
+ *  @return uint32_t - The number of running timers.
+ */
+uint32_t Timer_NbRunning(void);
+
+/*!
+ ** @}
+ */
+#endif
@@ -0,0 +1,98 @@
+/*! @file
+ *
+ *  @brief Microsecond timestamps from a free-running hardware counter.
+ *
+ *  This contains the functions for reading the PIT lifetime counter as a microsecond clock.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup timestamp_module Timestamp module documentation
+ **  @{
+ */
+#include "Timestamp.h"
+#include "PIT.h"
+#include "Cpu.h"
+#include "PE_Types.h"
+
+static uint32_t CyclesPerMicrosecond;
+static uint64_t LastCycles;    /*!< The lifetime count at the last read */
+static uint32_t Remainder;     /*!< Cycles since the last read that do not make a whole microsecond yet */
+static uint64_t Microseconds;  /*!< The time at the last read */
+
+/*! @brief Brings the microsecond count up to date with the lifetime counter.
+ *
+ *  @return uint64_t - Microseconds since Timestamp_Init.
+ *  @note Must be called inside a critical section.
+ */
+static uint64_t Update(void)
+{
+  const uint64_t cycles = PIT_Lifetime();
+  const uint64_t elapsed = (cycles - LastCycles) + Remainder;
+
+  LastCycles = cycles;
+  if (elapsed >> 32)
+  {
+    Microseconds += elapsed / CyclesPerMicrosecond;
+    Remainder = (uint32_t) (elapsed % CyclesPerMicrosecond);
+  }
+  else
+  {
+    //The usual case, read less than 172 s ago, without a 64-bit division
+    Microseconds += (uint32_t) elapsed / CyclesPerMicrosecond;
+    Remainder = (uint32_t) elapsed % CyclesPerMicrosecond;
+  }
+
+  return Microseconds;
+}
+
+/*! @brief Starts the free-running microsecond counter.
+ *
+ *  @param moduleClk The module clock rate in Hz, a whole number of MHz.
+ *  @return bool - TRUE if the counter was started.
+ *  @note Assumes that PIT_Init has been called.
+ */
+bool Timestamp_Init(const uint32_t moduleClk)
+{
+  if ((moduleClk < 1000000) || (moduleClk % 1000000))
+  {
+    return false;
+  }
+
+  CyclesPerMicrosecond = moduleClk / 1000000;
+  LastCycles = PIT_Lifetime();
+  Remainder = 0;
+  Microseconds = 0;
+  return true;
+}
+
+/*! @brief Gets the current time.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint32_t - Microseconds since Timestamp_Init, modulo 2^32.
+ */
+uint32_t Timestamp_Now(void)
+{
+  return (uint32_t) Timestamp_Now64();
+}
+
+/*! @brief Gets the current time, extended to 64 bits.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - Microseconds since Timestamp_Init.
+ */
+uint64_t Timestamp_Now64(void)
+{
+  uint64_t now;
+
+  EnterCritical();
+  now = Update();
+  ExitCritical();
+
+  return now;
+}
+
+/*!
+ ** @}
+ */
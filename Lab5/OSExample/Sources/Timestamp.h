@@ -0,0 +1,45 @@
+/*! @file
+ *
+ *  @brief Microsecond timestamps from a free-running hardware counter.
+ *
+ *  The 64-bit PIT lifetime counter of module clock cycles is turned into a 64-bit count of microseconds.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup timestamp_module Timestamp module documentation
+ **  @{
+ */
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+// new types
+#include "types.h"
+
+/*! @brief Starts the free-running microsecond counter.
+ *
+ *  @param moduleClk The module clock rate in Hz, a whole number of MHz.
+ *  @return bool - TRUE if the counter was started.
+ *  @note Assumes that PIT_Init has been called.
+ */
+bool Timestamp_Init(const uint32_t moduleClk);
+
+/*! @brief Gets the current time.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint32_t - Microseconds since Timestamp_Init, modulo 2^32.
+ */
+uint32_t Timestamp_Now(void);
+
+/*! @brief Gets the current time, extended to 64 bits.
+ *
+ *  Safe to call from interrupt service routines.
+ *  @return uint64_t - Microseconds since Timestamp_Init.
+ */
+uint64_t Timestamp_Now64(void);
+
+/*!
+ ** @}
+ */
+#endif
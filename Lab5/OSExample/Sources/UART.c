@@ -21,6 +21,7 @@
 #include "UART.h"
 #include "Cpu.h"
 #include "packet.h"
+#include "Profile.h"
 
 /****************************************GLOBAL VARS*****************************************************/
 static TFIFO RxFIFO;
@@ -108,6 +109,16 @@ void UART_OutChar(const uint8_t data)
   FIFO_Put(&TxFIFO, data); //Place the value stored in data into the TxFIFO
 }
 
+/*! @brief Gets the free space in the transmit FIFO.
+ *
+ *  @return uint8_t - The free space, in percent of the FIFO size.
+ *  @note Assumes that UART_Init has been called.
+ */
+uint8_t UART_TxHeadroom(void)
+{
+  return (uint8_t) (((FIFO_SIZE - TxFIFO.NbBytes) * 100u) / FIFO_SIZE);
+}
+
 /*! @brief The thread which handles the receiving of data
  *
  *  @param data
@@ -155,6 +166,7 @@ void __attribute__ ((interrupt)) UART_ISR(void)
 {
   OS_ISREnter();
   static uint8_t txData;
+  PROFILE_BEGIN(PROFILE_UART_ISR);
 
   if (UART2_C2 & UART_C2_RIE_MASK)
   {
@@ -172,6 +184,7 @@ void __attribute__ ((interrupt)) UART_ISR(void)
       UART2_C2 &= ~UART_C2_TIE_MASK;
     }
   }
+  PROFILE_END(PROFILE_UART_ISR);
   OS_ISRExit();
 }
 
@@ -42,6 +42,13 @@ void UART_InChar(uint8_t * const dataPtr);
  */
 void UART_OutChar(const uint8_t data);
 
+/*! @brief Gets the free space in the transmit FIFO.
+ *
+ *  @return uint8_t - The free space, in percent of the FIFO size.
+ *  @note Assumes that UART_Init has been called.
+ */
+uint8_t UART_TxHeadroom(void);
+
 /*! @brief The thread which handles the receiving of data
  *
  *  @param data
@@ -23,6 +23,9 @@
 // K70 module registers
 #include "MK70F12.h"
 
+// Microsecond time of the data ready interrupts
+#include "Timestamp.h"
+
 // CPU and PE_types are needed for critical section variables and the defintion of NULL pointer
 #include "CPU.h"
 #include "PE_types.h"
@@ -38,12 +41,47 @@
 
 #define ADDRESS_INT_SOURCE 0x0C
 
+#define ADDRESS_F_STATUS 0x00
+#define F_STATUS_F_CNT_MASK 0x3Fu	/*!< Number of samples in the FIFO. */
+
+#define ADDRESS_F_SETUP 0x09
+#define F_SETUP_F_MODE_CIRCULAR 0x40u	/*!< FIFO keeps the newest 32 samples. */
+
+#define F_STATUS_F_OVF 0x80u		/*!< In trigger mode, the FIFO has filled since the trigger. */
+#define F_STATUS_F_WMRK_FLAG 0x40u	/*!< In trigger mode, the trigger event was detected. */
+#define F_SETUP_F_MODE_TRIGGER 0xC0u	/*!< FIFO keeps the samples before a trigger, then fills and stops. */
+
+#define ADDRESS_TRIG_CFG 0x0A
+#define TRIG_CFG_TRIG_TRANS 0x20u	/*!< Transient events trigger the FIFO. */
+#define TRIG_CFG_TRIG_FF_MT 0x04u	/*!< Motion events trigger the FIFO. */
+
+// Motion detection
+#define ADDRESS_FF_MT_CFG 0x15
+#define FF_MT_CFG_MOTION 0xF8u		/*!< ELE (latched), OAE (motion rather than freefall), X, Y and Z enabled. */
+#define ADDRESS_FF_MT_SRC 0x16
+#define ADDRESS_FF_MT_THS 0x17
+#define ADDRESS_FF_MT_COUNT 0x18
+
+// Transient (high-pass filtered) detection
+#define ADDRESS_TRANSIENT_CFG 0x1D
+#define TRANSIENT_CFG_TRANSIENT 0x1Eu	/*!< ELE (latched), X, Y and Z enabled through the high-pass filter. */
+#define ADDRESS_TRANSIENT_SRC 0x1E
+#define ADDRESS_TRANSIENT_THS 0x1F
+#define ADDRESS_TRANSIENT_COUNT 0x20
+
+#define THS_MASK 0x7Fu			/*!< Thresholds are 0.063 g per count. */
+
+#define FIFO_WATERMARK 16		/*!< Samples in the FIFO that raise the FIFO interrupt, or kept before a trigger. */
+
+#define SAMPLE_SIZE_8_BIT 3		/*!< OUT_X_MSB, OUT_Y_MSB, OUT_Z_MSB. */
+#define SAMPLE_SIZE_14_BIT 6		/*!< OUT_X_MSB, OUT_X_LSB ... OUT_Z_LSB. */
+
 //function prototype
 void actualAccelReadDataBack(void * nothing);
 
 static const TI2CModule I2C_ACCEL_MODULE = {
     .primarySlaveAddress = 0x1D,
-    .baudRate = 100000,
+    .baudRate = 400000, //Fast mode, the MMA8451Q supports up to 400 kHz
     .readCompleteCallbackFunction = actualAccelReadDataBack,
     .readCompleteCallbackArguments = 0
 };
@@ -70,35 +108,15 @@ static union
 
 #define INT_SOURCE     		INT_SOURCE_Union.byte
 #define INT_SOURCE_SRC_DRDY	INT_SOURCE_Union.bits.SRC_DRDY
-#define INT_SOURCE_SRC_FF_MT	CTRL_REG4_Union.bits.SRC_FF_MT
-#define INT_SOURCE_SRC_PULSE	CTRL_REG4_Union.bits.SRC_PULSE
-#define INT_SOURCE_SRC_LNDPRT	CTRL_REG4_Union.bits.SRC_LNDPRT
-#define INT_SOURCE_SRC_TRANS	CTRL_REG4_Union.bits.SRC_TRANS
-#define INT_SOURCE_SRC_FIFO	CTRL_REG4_Union.bits.SRC_FIFO
-#define INT_SOURCE_SRC_ASLP	CTRL_REG4_Union.bits.SRC_ASLP
+#define INT_SOURCE_SRC_FF_MT	INT_SOURCE_Union.bits.SRC_FF_MT
+#define INT_SOURCE_SRC_PULSE	INT_SOURCE_Union.bits.SRC_PULSE
+#define INT_SOURCE_SRC_LNDPRT	INT_SOURCE_Union.bits.SRC_LNDPRT
+#define INT_SOURCE_SRC_TRANS	INT_SOURCE_Union.bits.SRC_TRANS
+#define INT_SOURCE_SRC_FIFO	INT_SOURCE_Union.bits.SRC_FIFO
+#define INT_SOURCE_SRC_ASLP	INT_SOURCE_Union.bits.SRC_ASLP
 
 #define ADDRESS_CTRL_REG1 0x2A
 
-typedef enum
-{
-  DATE_RATE_800_HZ,
-  DATE_RATE_400_HZ,
-  DATE_RATE_200_HZ,
-  DATE_RATE_100_HZ,
-  DATE_RATE_50_HZ,
-  DATE_RATE_12_5_HZ,
-  DATE_RATE_6_25_HZ,
-  DATE_RATE_1_56_HZ
-} TOutputDataRate;
-
-typedef enum
-{
-  SLEEP_MODE_RATE_50_HZ,
-  SLEEP_MODE_RATE_12_5_HZ,
-  SLEEP_MODE_RATE_6_25_HZ,
-  SLEEP_MODE_RATE_1_56_HZ
-} TSLEEPModeRate;
-
 static union
 {
   uint8_t byte;			/*!< The CTRL_REG1 bits accessed as a byte. */
@@ -120,6 +138,12 @@ static union
 #define CTRL_REG1_ASLP_RATE	  CTRL_REG1_Union.bits.ASLP_RATE
 
 #define ADDRESS_CTRL_REG2 0x2B
+#define CTRL_REG2_SLPE 0x04u		/*!< Auto-SLEEP enable. */
+
+#define ADDRESS_SYSMOD 0x0B
+#define SYSMOD_SLEEP 0x02u		/*!< The sensor is in SLEEP mode. */
+
+#define ADDRESS_ASLP_COUNT 0x29		/*!< Inactivity before SLEEP, in 320 ms counts. */
 
 #define ADDRESS_CTRL_REG3 0x2C
 
@@ -130,6 +154,7 @@ static union
   {
     uint8_t PP_OD       : 1;	/*!< Push-pull/open drain selection. */
     uint8_t IPOL        : 1;	/*!< Interrupt polarity. */
+    uint8_t             : 1;
     uint8_t WAKE_FF_MT  : 1;	/*!< Freefall/motion function in SLEEP mode. */
     uint8_t WAKE_PULSE  : 1;	/*!< Pulse function in SLEEP mode. */
     uint8_t WAKE_LNDPRT : 1;	/*!< Orientation function in SLEEP mode. */
@@ -223,6 +248,52 @@ static void *ReadCallbackArgument;
 
 static TAccelMode CurrentMode;
 
+static TOutputDataRate CurrentRate;
+
+static TAccelResolution CurrentResolution;
+
+static bool AutoSleep;			/*!< The sensor drops to SleepRate when still. */
+static TSLEEPModeRate SleepRate;
+static bool Asleep;			/*!< The sensor was in SLEEP mode at the last transition. */
+
+/*!
+ * @brief Sample period of each output data rate, in nanoseconds.
+ */
+static const uint32_t SAMPLE_PERIOD[] =
+{
+  1250000,	//800 Hz
+  2500000,	//400 Hz
+  5000000,	//200 Hz
+  10000000,	//100 Hz
+  20000000,	//50 Hz
+  80000000,	//12.5 Hz
+  160000000,	//6.25 Hz
+  640000000	//1.5625 Hz
+};
+
+static uint32_t SampleCount;	/*!< Samples handed to the pipeline since the last Accel_RateTick. */
+static uint16_t AchievedRate;	/*!< Samples handed to the pipeline during the last second. */
+static uint32_t DroppedCount;	/*!< Samples read but dropped before the pipeline since the last Accel_RateTick. */
+static uint16_t DroppedRate;	/*!< Samples dropped during the last second. */
+
+static volatile uint32_t DataReadyTime;	/*!< Time of the last accelerometer interrupt, in microseconds. */
+static uint32_t EventTime;		/*!< Time of the interrupt that raised the last event. */
+
+static uint32_t LastTimestamp;		/*!< Time of the previous sample handed to the pipeline. */
+static bool HaveTimestamp;
+static uint32_t JitterMax, JitterSum, JitterCount;	/*!< Sample spacing error since the last Accel_RateTick. */
+static uint16_t LatchedJitterMax, LatchedJitterMean;	/*!< Sample spacing error during the last second. */
+
+/*!
+ * @brief F_STATUS followed by the watermark's worth of samples, read in one burst.
+ */
+static uint8_t FIFOBurst[1 + FIFO_WATERMARK * ACCEL_MAX_SAMPLE_SIZE];
+
+/*!
+ * @brief Samples that arrived in the FIFO beyond the watermark.
+ */
+static uint8_t FIFORest[(ACCEL_FIFO_SIZE - FIFO_WATERMARK) * ACCEL_MAX_SAMPLE_SIZE];
+
 /*!
  * @brief Used for controlling Standby mode for REG1
  * @param standby
@@ -238,6 +309,7 @@ void standbyMode(bool standby)
   {
     CTRL_REG1_ACTIVE = 1;
     I2C_Write(ADDRESS_CTRL_REG1, CTRL_REG1);
+    Asleep = false; //Leaving standby always starts in WAKE mode
   }
 }
 
@@ -250,10 +322,11 @@ void standbyMode(bool standby)
 
 bool Accel_Init(const TAccelSetup* const accelSetup)
 {
-  AccelSemaphore = OS_SemaphoreCreate(0); //Create Accel semaphore
+  AccelFlags = OS_FlagsCreate(0); //Create Accel flags
 
   AccelModuleSetup = *accelSetup;
   CurrentMode = ACCEL_POLL; //By default
+  CurrentResolution = ACCEL_RESOLUTION_8_BIT;
 
   DataCallback = accelSetup-> dataReadyCallbackFunction;
   DataCallbackArgument=accelSetup->dataReadyCallbackArguments;
@@ -269,7 +342,8 @@ bool Accel_Init(const TAccelSetup* const accelSetup)
   uint8_t aaaaa;//0x1Au
   I2C_PollRead(MMA8451Q_WHO_AM_I, &aaaaa, 1);
 
-  CTRL_REG1_DR = DATE_RATE_1_56_HZ;
+  CurrentRate = DATE_RATE_1_56_HZ;
+  CTRL_REG1_DR = CurrentRate;
   CTRL_REG1_F_READ = 1; 										//8 bit precision
   CTRL_REG1_LNOISE = 0; 										//Set to full dynamic range mode
   CTRL_REG1_ASLP_RATE = 0; //SLEEP_MODE_RATE_1_56_HZ;
@@ -283,17 +357,27 @@ bool Accel_Init(const TAccelSetup* const accelSetup)
   I2C_Write(ADDRESS_CTRL_REG4, CTRL_REG4); //Write to the register
 
   CTRL_REG5_INT_CFG_DRDY = 1;
+  CTRL_REG5_INT_CFG_FIFO = 1; //FIFO interrupt on INT1 as well
+  CTRL_REG5_INT_CFG_FF_MT = 1; //and the event engines
+  CTRL_REG5_INT_CFG_TRANS = 1;
+  CTRL_REG5_INT_CFG_ASLP = 1;
   I2C_Write(ADDRESS_CTRL_REG5, CTRL_REG5);
 
+  I2C_Write(ADDRESS_TRIG_CFG, TRIG_CFG_TRIG_TRANS | TRIG_CFG_TRIG_FF_MT);
+
   standbyMode(false); //Standby Mode Deactivate
 
+  //Motion above 1.5 g (gravity included) or a 0.5 g jolt, for 2 samples
+  (void) Accel_SetEventDetection(ACCEL_EVENT_MOTION, 24, 2);
+  (void) Accel_SetEventDetection(ACCEL_EVENT_TRANSIENT, 8, 2);
+
   SIM_SCGC5 |=  SIM_SCGC5_PORTB_MASK; //set portB as per lab requirements
 
   //set pins use pin 4
   PORTB_PCR4 &= ~PORT_PCR_MUX_MASK; //clear any previously set bits for the PCR_MUX
   PORTB_PCR4 |= PORT_PCR_MUX(1); //set pin 4
   PORTB_PCR4 |= PORT_PCR_ISF_MASK; //set interrupt status flag pg 323
-  PORTB_PCR4 |= PORT_PCR_IRQC(10); //set interrupt configuration
+  PORTB_PCR4 |= PORT_PCR_IRQC(9); //interrupt on rising edge, the INT1 pin is active high (IPOL)
 
   //NVICS: IQR- Pin detect portB (88mod32) pg98 k70 manual
   NVICICPR2 = (1<<24);
@@ -310,23 +394,461 @@ TAccelMode Accel_GetMode()
   return CurrentMode;
 }
 
+/*! @brief Changes the output data rate of the accelerometer.
+ *
+ *  The rate can only be changed in standby, so the sensor is stopped for the duration of the change.
+ *  @param rate is the new output data rate.
+ *  @return bool - TRUE if the rate is valid and was set.
+ */
+bool Accel_SetDataRate(const TOutputDataRate rate)
+{
+  if (rate > DATE_RATE_1_56_HZ)
+  {
+    return false;
+  }
+
+  standbyMode(true);
+  CurrentRate = rate;
+  CTRL_REG1_DR = rate;
+  I2C_Write(ADDRESS_CTRL_REG1, CTRL_REG1); //Still in standby
+  standbyMode(false);
+
+  return true;
+}
+
+/*!
+ *  @brief Used for accessing the current output data rate
+ */
+TOutputDataRate Accel_GetDataRate(void)
+{
+  return CurrentRate;
+}
+
+/*! @brief Gets the sample period of the current output data rate.
+ *
+ *  While the sensor is asleep this is the period of the sleep rate, if that is slower.
+ *  @return uint32_t - The sample period in nanoseconds, as taken by PIT_Set.
+ */
+uint32_t Accel_GetSamplePeriod(void)
+{
+  //The sleep rates are the four slowest output data rates
+  const TOutputDataRate sleepRate = (TOutputDataRate) (DATE_RATE_50_HZ + SleepRate);
+
+  if (Asleep && (sleepRate > CurrentRate))
+  {
+    return SAMPLE_PERIOD[sleepRate];
+  }
+  return SAMPLE_PERIOD[CurrentRate];
+}
+
+/*! @brief Sets up the sensor's auto-sleep.
+ *
+ *  When no motion or transient event has been seen for the timeout the sensor drops to the sleep rate,
+ *  and the first event wakes it back to the output data rate. The event engines are the wake sources.
+ *  @param enable is TRUE to let the sensor sleep.
+ *  @param sleepRate is the output data rate while asleep.
+ *  @param timeout is the inactivity before sleeping, in 320 ms counts.
+ *  @return bool - TRUE if the settings are valid and were set.
+ */
+bool Accel_SetAutoSleep(const bool enable, const TSLEEPModeRate sleepRate, const uint8_t timeout)
+{
+  if (sleepRate > SLEEP_MODE_RATE_1_56_HZ)
+  {
+    return false;
+  }
+
+  standbyMode(true);
+  AutoSleep = enable;
+  SleepRate = sleepRate;
+
+  CTRL_REG1_ASLP_RATE = sleepRate;
+  I2C_Write(ADDRESS_CTRL_REG1, CTRL_REG1);
+  I2C_Write(ADDRESS_ASLP_COUNT, timeout);
+  I2C_Write(ADDRESS_CTRL_REG2, enable ? CTRL_REG2_SLPE : 0);
+
+  CTRL_REG3_WAKE_FF_MT = enable;
+  CTRL_REG3_WAKE_TRANS = enable;
+  I2C_Write(ADDRESS_CTRL_REG3, CTRL_REG3);
+
+  //Only the modes that cannot see the rate change from their own interrupts need the transitions
+  CTRL_REG4_INT_EN_ASLP = enable && ((CurrentMode == ACCEL_POLL) || (CurrentMode == ACCEL_FIFO));
+  I2C_Write(ADDRESS_CTRL_REG4, CTRL_REG4);
+  standbyMode(false);
+
+  return true;
+}
+
+/*! @brief Checks for a sleep/wake transition of the sensor.
+ *
+ *  Reading SYSMOD clears the transition interrupt. No I2C traffic happens when auto-sleep is off.
+ *  @return bool - TRUE if the sensor fell asleep or woke up since the last call.
+ */
+bool Accel_UpdateSleepState(void)
+{
+  uint8_t sysmod;
+
+  if (!AutoSleep)
+  {
+    return false;
+  }
+
+  I2C_PollRead(ADDRESS_INT_SOURCE, &INT_SOURCE, 1);
+  if (!INT_SOURCE_SRC_ASLP)
+  {
+    return false;
+  }
+
+  I2C_PollRead(ADDRESS_SYSMOD, &sysmod, 1);
+  Asleep = (sysmod & SYSMOD_SLEEP) != 0;
+  return true;
+}
+
+/*!
+ *  @brief Used for accessing the sleep state
+ */
+bool Accel_IsAsleep(void)
+{
+  return Asleep;
+}
+
+/*! @brief Records samples handed to the processing pipeline.
+ *
+ *  @param nbSamples is the number of samples.
+ */
+void Accel_CountSamples(const uint8_t nbSamples)
+{
+  EnterCritical();
+  SampleCount += nbSamples;
+  ExitCritical();
+}
+
+/*! @brief Records samples that were read but dropped before the processing pipeline.
+ *
+ *  @param nbSamples is the number of samples.
+ */
+void Accel_CountDropped(const uint8_t nbSamples)
+{
+  EnterCritical();
+  DroppedCount += nbSamples;
+  ExitCritical();
+}
+
+/*! @brief Latches the samples counted during the last second as the achieved sample rate.
+ *
+ *  @note Must be called once per second.
+ */
+void Accel_RateTick(void)
+{
+  EnterCritical();
+  AchievedRate = (SampleCount > 0xFFFF) ? 0xFFFF : SampleCount;
+  SampleCount = 0;
+  DroppedRate = (DroppedCount > 0xFFFF) ? 0xFFFF : DroppedCount;
+  DroppedCount = 0;
+
+  LatchedJitterMax = (JitterMax > 0xFFFF) ? 0xFFFF : JitterMax;
+  LatchedJitterMean = JitterCount ? (((JitterSum / JitterCount) > 0xFFFF) ? 0xFFFF : (JitterSum / JitterCount)) : 0;
+  JitterMax = JitterSum = JitterCount = 0;
+  ExitCritical();
+}
+
+/*! @brief Records the timestamp of a sample handed to the processing pipeline.
+ *
+ *  The difference between the spacing of consecutive samples and the sample period is the jitter.
+ *  @param timestamp is the time of the sample, in microseconds.
+ */
+void Accel_RecordTimestamp(const uint32_t timestamp)
+{
+  const int32_t period = Accel_GetSamplePeriod() / 1000;
+  int32_t error;
+
+  EnterCritical();
+  if (HaveTimestamp)
+  {
+    error = (int32_t) (timestamp - LastTimestamp) - period;
+    if (error < 0)
+    {
+      error = -error;
+    }
+    if ((uint32_t) error > JitterMax)
+    {
+      JitterMax = error;
+    }
+    JitterSum += error;
+    JitterCount++;
+  }
+  LastTimestamp = timestamp;
+  HaveTimestamp = true;
+  ExitCritical();
+}
+
+/*! @brief Gets the sample spacing jitter.
+ *
+ *  @param max is where the largest error during the last second is stored, in microseconds.
+ *  @param mean is where the mean error during the last second is stored, in microseconds.
+ */
+void Accel_GetJitter(uint16_t* const max, uint16_t* const mean)
+{
+  EnterCritical();
+  *max = LatchedJitterMax;
+  *mean = LatchedJitterMean;
+  ExitCritical();
+}
+
+/*!
+ *  @brief Used for accessing the time of the last data ready interrupt
+ */
+uint32_t Accel_GetDataReadyTime(void)
+{
+  return DataReadyTime;
+}
+
+/*! @brief Stamps a block read from the FIFO.
+ *
+ *  The interrupt came when the FIFO reached the watermark (or the trigger sample), so that sample is
+ *  given the interrupt time and the others are spaced a sample period away from it.
+ *  @param timestamps is where the time of each sample is stored, in microseconds.
+ *  @param nbSamples is the number of samples in the block.
+ *  @param anchorTime is the time of the interrupt.
+ */
+static void stampBlock(uint32_t timestamps[], const uint8_t nbSamples, const uint32_t anchorTime)
+{
+  const uint32_t period = Accel_GetSamplePeriod() / 1000;
+  const int8_t anchor = ((nbSamples < FIFO_WATERMARK) ? nbSamples : FIFO_WATERMARK) - 1;
+  int8_t i;
+
+  for (i = 0; i < nbSamples; i++)
+  {
+    timestamps[i] = anchorTime + (int32_t) (i - anchor) * (int32_t) period;
+  }
+}
+
+/*! @brief Gets the achieved sample rate.
+ *
+ *  @return uint16_t - The number of samples handed to the pipeline during the last second.
+ */
+uint16_t Accel_GetAchievedRate(void)
+{
+  return AchievedRate;
+}
+
+/*! @brief Gets the dropped sample rate.
+ *
+ *  @return uint16_t - The number of samples read but dropped before the pipeline during the last second.
+ */
+uint16_t Accel_GetDroppedRate(void)
+{
+  return DroppedRate;
+}
+
+/*! @brief Sets the resolution samples are read at.
+ *
+ *  F_READ can only be changed in standby, so the sensor is stopped for the duration of the change.
+ *  @param resolution selects the 8-bit MSBs or the full 14-bit registers.
+ *  @return bool - TRUE if the resolution is valid and was set.
+ */
+bool Accel_SetResolution(const TAccelResolution resolution)
+{
+  if (resolution > ACCEL_RESOLUTION_14_BIT)
+  {
+    return false;
+  }
+
+  standbyMode(true);
+  CurrentResolution = resolution;
+  CTRL_REG1_F_READ = (resolution == ACCEL_RESOLUTION_8_BIT);
+  I2C_Write(ADDRESS_CTRL_REG1, CTRL_REG1); //Still in standby
+  standbyMode(false);
+
+  return true;
+}
+
+/*!
+ *  @brief Used for accessing the current resolution
+ */
+TAccelResolution Accel_GetResolution(void)
+{
+  return CurrentResolution;
+}
+
+/*! @brief Gets the size of a raw sample at the current resolution.
+ *
+ *  @return uint8_t - 3 at 8-bit resolution, 6 at 14-bit resolution.
+ */
+uint8_t Accel_GetSampleSize(void)
+{
+  return (CurrentResolution == ACCEL_RESOLUTION_14_BIT) ? SAMPLE_SIZE_14_BIT : SAMPLE_SIZE_8_BIT;
+}
+
+/*! @brief Converts the raw X, Y and Z registers to a sample in 14-bit counts.
+ *
+ *  The 14-bit registers are left justified, MSB first; the 8-bit MSBs are scaled up to the same counts.
+ *  @param data is the raw registers as read by Accel_ReadXYZ at the current resolution.
+ *  @param sample is where the converted sample is stored.
+ */
+void Accel_ConvertSample(const uint8_t* const data, TAccelSample* const sample)
+{
+  uint8_t axis;
+
+  for (axis = 0; axis < 3; axis++)
+  {
+    if (CurrentResolution == ACCEL_RESOLUTION_14_BIT)
+    {
+      sample->counts[axis] = (int16_t) (((uint16_t) data[2 * axis] << 8) | data[2 * axis + 1]) >> 2;
+    }
+    else
+    {
+      sample->counts[axis] = (int16_t) ((int8_t) data[axis] * 64);
+    }
+  }
+}
+
 /*! @brief Reads X, Y and Z accelerations.
- *  @param data is a an array of 3 bytes where the X, Y and Z data are stored.
+ *
+ *  In ACCEL_INT mode the read is only started; ACCEL_FLAG_READ_DONE is set in AccelFlags when it
+ *  ends, and until then data belongs to the I2C driver.
+ *  @param data is where the raw X, Y and Z registers are stored, Accel_GetSampleSize() bytes.
  */
-void Accel_ReadXYZ(uint8_t data[3])
+void Accel_ReadXYZ(uint8_t data[ACCEL_MAX_SAMPLE_SIZE])
 {
   //I2C_SelectSlaveDevice(0x1d);
 
   if (CurrentMode == ACCEL_POLL)
   {
-    I2C_PollRead(ADDRESS_OUT_X_MSB, data, 3);
+    I2C_PollRead(ADDRESS_OUT_X_MSB, data, Accel_GetSampleSize());
   }
   else if (CurrentMode == ACCEL_INT)
   {
-    I2C_IntRead(ADDRESS_OUT_X_MSB, data, 3);
+    I2C_IntRead(ADDRESS_OUT_X_MSB, data, Accel_GetSampleSize(), AccelFlags, ACCEL_FLAG_READ_DONE);
   }
 }
 
+/*! @brief Reads the samples queued in the accelerometer FIFO.
+ *
+ *  F_STATUS and the watermark's worth of samples come in one burst: in FIFO mode the register
+ *  address wraps from the last Z register back to OUT_X_MSB, popping one sample per 3 or 6 bytes.
+ *  Samples that arrived beyond the watermark are fetched with a second burst.
+ *  @param samples is where the samples are stored, oldest first.
+ *  @param timestamps is where the time of each sample is stored, in microseconds.
+ *  @return uint8_t - The number of samples read.
+ */
+uint8_t Accel_ReadFIFO(TAccelSample samples[ACCEL_FIFO_SIZE], uint32_t timestamps[ACCEL_FIFO_SIZE])
+{
+  const uint8_t sampleSize = Accel_GetSampleSize();
+  const uint32_t interruptTime = DataReadyTime;
+  uint8_t nbSamples, nbFirst, i;
+
+  I2C_PollRead(ADDRESS_F_STATUS, FIFOBurst, 1 + FIFO_WATERMARK * sampleSize);
+
+  nbSamples = FIFOBurst[0] & F_STATUS_F_CNT_MASK;
+  nbFirst = (nbSamples < FIFO_WATERMARK) ? nbSamples : FIFO_WATERMARK;
+  for (i = 0; i < nbFirst; i++)
+  {
+    Accel_ConvertSample(&FIFOBurst[1 + i * sampleSize], &samples[i]);
+  }
+
+  if (nbSamples > nbFirst)
+  {
+    I2C_PollRead(ADDRESS_OUT_X_MSB, FIFORest, (nbSamples - nbFirst) * sampleSize);
+    for (i = nbFirst; i < nbSamples; i++)
+    {
+      Accel_ConvertSample(&FIFORest[(i - nbFirst) * sampleSize], &samples[i]);
+    }
+  }
+
+  stampBlock(timestamps, nbSamples, interruptTime);
+  return nbSamples;
+}
+
+/*! @brief Sets up one of the event engines used in ACCEL_EVENT mode.
+ *
+ *  @param event selects the motion or the transient engine.
+ *  @param threshold is the threshold in 0.063 g counts (up to 127), 0 disables the engine.
+ *  @param debounce is the number of samples the threshold must be exceeded for.
+ *  @return bool - TRUE if the engine was set up.
+ */
+bool Accel_SetEventDetection(const TAccelEvent event, const uint8_t threshold, const uint8_t debounce)
+{
+  if ((event > ACCEL_EVENT_TRANSIENT) || (threshold > THS_MASK))
+  {
+    return false;
+  }
+
+  standbyMode(true);
+  if (event == ACCEL_EVENT_MOTION)
+  {
+    I2C_Write(ADDRESS_FF_MT_THS, threshold);
+    I2C_Write(ADDRESS_FF_MT_COUNT, debounce);
+    I2C_Write(ADDRESS_FF_MT_CFG, threshold ? FF_MT_CFG_MOTION : 0);
+  }
+  else
+  {
+    I2C_Write(ADDRESS_TRANSIENT_THS, threshold);
+    I2C_Write(ADDRESS_TRANSIENT_COUNT, debounce);
+    I2C_Write(ADDRESS_TRANSIENT_CFG, threshold ? TRANSIENT_CFG_TRANSIENT : 0);
+  }
+  standbyMode(false);
+
+  return true;
+}
+
+/*! @brief Reads and clears the event that raised the accelerometer interrupt.
+ *
+ *  @param source is where the interrupt and event engine sources are stored.
+ *  @return bool - TRUE if a motion or transient event was latched.
+ */
+bool Accel_ReadEventSource(TAccelEventSource* const source)
+{
+  EventTime = DataReadyTime;
+  I2C_PollRead(ADDRESS_INT_SOURCE, &INT_SOURCE, 1);
+  source->interrupt = INT_SOURCE;
+  source->motion = 0;
+  source->transient = 0;
+
+  //Reading the engine sources clears their latches
+  if (INT_SOURCE_SRC_FF_MT)
+  {
+    I2C_PollRead(ADDRESS_FF_MT_SRC, &source->motion, 1);
+  }
+  if (INT_SOURCE_SRC_TRANS)
+  {
+    I2C_PollRead(ADDRESS_TRANSIENT_SRC, &source->transient, 1);
+  }
+  return INT_SOURCE_SRC_FF_MT || INT_SOURCE_SRC_TRANS;
+}
+
+/*! @brief Checks whether the FIFO has filled since the last trigger.
+ *
+ *  @return bool - TRUE if the pre-trigger and post-trigger window can be read.
+ */
+bool Accel_EventWindowReady(void)
+{
+  uint8_t status;
+
+  I2C_PollRead(ADDRESS_F_STATUS, &status, 1);
+  return (status & (F_STATUS_F_WMRK_FLAG | F_STATUS_F_OVF)) == (F_STATUS_F_WMRK_FLAG | F_STATUS_F_OVF);
+}
+
+/*! @brief Reads the samples around the last trigger and re-arms the trigger.
+ *
+ *  @param samples is where the samples are stored, oldest first.
+ *  @param timestamps is where the time of each sample is stored, in microseconds.
+ *  @return uint8_t - The number of samples read.
+ */
+uint8_t Accel_ReadEventWindow(TAccelSample samples[ACCEL_FIFO_SIZE], uint32_t timestamps[ACCEL_FIFO_SIZE])
+{
+  uint8_t nbSamples = Accel_ReadFIFO(samples, timestamps);
+
+  stampBlock(timestamps, nbSamples, EventTime);
+
+  //The FIFO stops once full; it has to go through F_MODE 00 to capture the next window
+  standbyMode(true);
+  I2C_Write(ADDRESS_F_SETUP, 0);
+  I2C_Write(ADDRESS_F_SETUP, F_SETUP_F_MODE_TRIGGER | FIFO_WATERMARK);
+  standbyMode(false);
+
+  return nbSamples;
+}
+
 /*! @brief actualAccelReadDataBack
  *  @param nothing
  */
@@ -346,30 +868,40 @@ void Accel_SetMode(const TAccelMode mode)
 {
   CurrentMode = mode;
 
-  if (mode == ACCEL_POLL)
+  standbyMode(true); //F_SETUP and CTRL_REG4 can only be changed in standby
+
+  //The FIFO is turned off before its mode changes
+  I2C_Write(ADDRESS_F_SETUP, 0);
+  if (mode == ACCEL_FIFO)
   {
-    CTRL_REG4_INT_EN_DRDY = 0; //Data ready interrupt disabled
-    I2C_Write(ADDRESS_CTRL_REG4, CTRL_REG4);
+    I2C_Write(ADDRESS_F_SETUP, F_SETUP_F_MODE_CIRCULAR | FIFO_WATERMARK);
   }
-  else
+  else if (mode == ACCEL_EVENT)
   {
-    CTRL_REG4_INT_EN_DRDY = 1; //Data ready interrupt enabled
-    I2C_Write(ADDRESS_CTRL_REG4, CTRL_REG4);
+    I2C_Write(ADDRESS_F_SETUP, F_SETUP_F_MODE_TRIGGER | FIFO_WATERMARK);
   }
+
+  CTRL_REG4_INT_EN_DRDY = (mode == ACCEL_INT); //Data ready interrupt, one sample at a time
+  CTRL_REG4_INT_EN_FIFO = (mode == ACCEL_FIFO); //FIFO watermark interrupt, a block at a time
+  CTRL_REG4_INT_EN_FF_MT = (mode == ACCEL_EVENT); //Nothing until the sensor sees an event
+  CTRL_REG4_INT_EN_TRANS = (mode == ACCEL_EVENT);
+  CTRL_REG4_INT_EN_ASLP = AutoSleep && ((mode == ACCEL_POLL) || (mode == ACCEL_FIFO));
+  I2C_Write(ADDRESS_CTRL_REG4, CTRL_REG4);
+
+  standbyMode(false);
 }
 
 
 void __attribute__ ((interrupt)) AccelDataReady_ISR(void)
 {
   OS_ISREnter();
-  if (!(PORTB_PCR7 & PORT_PCR_ISF_MASK))
+  if (PORTB_PCR4 & PORT_PCR_ISF_MASK)
   {
-    return;
+    DataReadyTime = Timestamp_Now(); //Stamp the sample as close to the sensor as possible
+    PORTB_PCR4 |= PORT_PCR_ISF_MASK; //Clear interrupt
+    OS_FlagsSet(AccelFlags, ACCEL_FLAG_DATA_READY); //Signal the accel thread
   }
 
-  PORTB_PCR4 |= PORT_PCR_ISF_MASK; //Clear interrupt
-  OS_SemaphoreSignal(AccelSemaphore); //Signal Accel Semaphore
-
   OS_ISRExit();
 
 //  if (CurrentMode == ACCEL_INT)
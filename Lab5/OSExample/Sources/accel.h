@@ -19,14 +19,61 @@
 #include "types.h"
 #include "OS.h"
 
-OS_ECB *AccelSemaphore; //Semaphore for accel thread
+OS_FLAGS *AccelFlags; //Flags for the accel thread; bits other than the ACCEL_FLAGs are free for the application
+
+#define ACCEL_FLAG_DATA_READY 0x01u	/*!< Set by the accelerometer interrupt. */
+#define ACCEL_FLAG_READ_DONE 0x02u	/*!< Set when a read by Accel_ReadXYZ in ACCEL_INT mode ends. */
+
+#define ACCEL_FIFO_SIZE 32	/*!< Samples held by the MMA8451Q FIFO. */
+#define ACCEL_MAX_SAMPLE_SIZE 6	/*!< Bytes read per sample at full resolution. */
 
 typedef enum
 {
   ACCEL_POLL,
-  ACCEL_INT
+  ACCEL_INT,
+  ACCEL_FIFO,			/*!< Samples are batched in the accelerometer FIFO and read a block at a time. */
+  ACCEL_EVENT			/*!< Only the samples around motion and transient events are read. */
 } TAccelMode;
 
+typedef enum
+{
+  ACCEL_EVENT_MOTION,		/*!< Acceleration, gravity included, above a threshold. */
+  ACCEL_EVENT_TRANSIENT		/*!< High-pass filtered acceleration above a threshold. */
+} TAccelEvent;
+
+typedef struct
+{
+  uint8_t interrupt;		/*!< INT_SOURCE, the interrupts the sensor raised. */
+  uint8_t motion;		/*!< FF_MT_SRC, the axes and directions of a motion event. */
+  uint8_t transient;		/*!< TRANSIENT_SRC, the axes and directions of a transient event. */
+} TAccelEventSource;
+
+typedef enum
+{
+  ACCEL_RESOLUTION_8_BIT,	/*!< Only the MSB of each axis is read (F_READ). */
+  ACCEL_RESOLUTION_14_BIT	/*!< The full 14-bit MSB and LSB registers are read. */
+} TAccelResolution;
+
+typedef enum
+{
+  DATE_RATE_800_HZ,
+  DATE_RATE_400_HZ,
+  DATE_RATE_200_HZ,
+  DATE_RATE_100_HZ,
+  DATE_RATE_50_HZ,
+  DATE_RATE_12_5_HZ,
+  DATE_RATE_6_25_HZ,
+  DATE_RATE_1_56_HZ
+} TOutputDataRate;
+
+typedef enum
+{
+  SLEEP_MODE_RATE_50_HZ,
+  SLEEP_MODE_RATE_12_5_HZ,
+  SLEEP_MODE_RATE_6_25_HZ,
+  SLEEP_MODE_RATE_1_56_HZ
+} TSLEEPModeRate;
+
 typedef struct
 {
   uint32_t moduleClk;				/*!< The module clock rate in Hz. */
@@ -51,6 +98,18 @@ typedef union
 
 #pragma pack(pop)
 
+/*!
+ * @brief A sample in 14-bit counts (-8192 to 8191) whatever the resolution it was read at.
+ */
+typedef union
+{
+  int16_t counts[3];				/*!< The sample accessed as an array. */
+  struct
+  {
+    int16_t x, y, z;				/*!< The sample accessed as individual axes. */
+  } axes;
+} TAccelSample;
+
 
 TAccelMode Accel_GetMode();
 
@@ -62,12 +121,176 @@ TAccelMode Accel_GetMode();
 bool Accel_Init(const TAccelSetup* const accelSetup);
 
 /*! @brief Reads X, Y and Z accelerations.
- *  @param data is a an array of 3 bytes where the X, Y and Z data are stored.
+ *
+ *  In ACCEL_INT mode the read is only started; ACCEL_FLAG_READ_DONE is set in AccelFlags when it
+ *  ends, and until then data belongs to the I2C driver.
+ *  @param data is where the raw X, Y and Z registers are stored, Accel_GetSampleSize() bytes.
+ */
+void Accel_ReadXYZ(uint8_t data[ACCEL_MAX_SAMPLE_SIZE]);
+
+/*! @brief Sets the resolution samples are read at.
+ *
+ *  @param resolution selects the 8-bit MSBs or the full 14-bit registers.
+ *  @return bool - TRUE if the resolution is valid and was set.
+ */
+bool Accel_SetResolution(const TAccelResolution resolution);
+
+/*! @brief Gets the resolution samples are read at.
+ *
+ *  @return TAccelResolution - The resolution.
+ */
+TAccelResolution Accel_GetResolution(void);
+
+/*! @brief Gets the size of a raw sample at the current resolution.
+ *
+ *  @return uint8_t - 3 at 8-bit resolution, 6 at 14-bit resolution.
+ */
+uint8_t Accel_GetSampleSize(void);
+
+/*! @brief Converts the raw X, Y and Z registers to a sample in 14-bit counts.
+ *
+ *  @param data is the raw registers as read by Accel_ReadXYZ at the current resolution.
+ *  @param sample is where the converted sample is stored.
+ */
+void Accel_ConvertSample(const uint8_t* const data, TAccelSample* const sample);
+
+/*! @brief Reads the samples queued in the accelerometer FIFO.
+ *
+ *  Used in ACCEL_FIFO mode once the FIFO interrupt has fired; blocks the calling thread for the transfer.
+ *  @param samples is where the samples are stored, oldest first.
+ *  @param timestamps is where the time of each sample is stored, in microseconds.
+ *  @return uint8_t - The number of samples read.
+ */
+uint8_t Accel_ReadFIFO(TAccelSample samples[ACCEL_FIFO_SIZE], uint32_t timestamps[ACCEL_FIFO_SIZE]);
+
+/*! @brief Changes the output data rate of the accelerometer.
+ *
+ *  The rate can only be changed in standby, so the sensor is stopped for the duration of the change.
+ *  @param rate is the new output data rate.
+ *  @return bool - TRUE if the rate is valid and was set.
+ */
+bool Accel_SetDataRate(const TOutputDataRate rate);
+
+/*! @brief Gets the current output data rate.
+ *
+ *  @return TOutputDataRate - The output data rate.
+ */
+TOutputDataRate Accel_GetDataRate(void);
+
+/*! @brief Gets the sample period of the current output data rate.
+ *
+ *  While the sensor is asleep this is the period of the sleep rate, if that is slower.
+ *  @return uint32_t - The sample period in nanoseconds, as taken by PIT_Set.
+ */
+uint32_t Accel_GetSamplePeriod(void);
+
+/*! @brief Sets up the sensor's auto-sleep.
+ *
+ *  When no motion or transient event has been seen for the timeout the sensor drops to the sleep rate,
+ *  and the first event wakes it back to the output data rate. The event engines are the wake sources.
+ *  @param enable is TRUE to let the sensor sleep.
+ *  @param sleepRate is the output data rate while asleep.
+ *  @param timeout is the inactivity before sleeping, in 320 ms counts.
+ *  @return bool - TRUE if the settings are valid and were set.
+ */
+bool Accel_SetAutoSleep(const bool enable, const TSLEEPModeRate sleepRate, const uint8_t timeout);
+
+/*! @brief Checks for a sleep/wake transition of the sensor.
+ *
+ *  In ACCEL_POLL and ACCEL_FIFO modes the transitions raise the accelerometer interrupt.
+ *  @return bool - TRUE if the sensor fell asleep or woke up since the last call.
+ */
+bool Accel_UpdateSleepState(void);
+
+/*! @brief Gets the sleep state of the sensor.
+ *
+ *  @return bool - TRUE if the sensor is sampling at the sleep rate.
+ */
+bool Accel_IsAsleep(void);
+
+/*! @brief Records samples handed to the processing pipeline.
+ *
+ *  @param nbSamples is the number of samples.
+ */
+void Accel_CountSamples(const uint8_t nbSamples);
+
+/*! @brief Records samples that were read but dropped before the processing pipeline.
+ *
+ *  @param nbSamples is the number of samples.
+ */
+void Accel_CountDropped(const uint8_t nbSamples);
+
+/*! @brief Latches the samples counted during the last second as the achieved sample rate.
+ *
+ *  @note Must be called once per second.
+ */
+void Accel_RateTick(void);
+
+/*! @brief Records the timestamp of a sample handed to the processing pipeline.
+ *
+ *  The difference between the spacing of consecutive samples and the sample period is the jitter.
+ *  @param timestamp is the time of the sample, in microseconds.
+ */
+void Accel_RecordTimestamp(const uint32_t timestamp);
+
+/*! @brief Gets the sample spacing jitter.
+ *
+ *  @param max is where the largest error during the last second is stored, in microseconds.
+ *  @param mean is where the mean error during the last second is stored, in microseconds.
+ */
+void Accel_GetJitter(uint16_t* const max, uint16_t* const mean);
+
+/*! @brief Gets the time of the last accelerometer interrupt.
+ *
+ *  @return uint32_t - The time from Timestamp_Now when the interrupt came in.
+ */
+uint32_t Accel_GetDataReadyTime(void);
+
+/*! @brief Gets the achieved sample rate.
+ *
+ *  @return uint16_t - The number of samples handed to the pipeline during the last second.
+ */
+uint16_t Accel_GetAchievedRate(void);
+
+/*! @brief Gets the dropped sample rate.
+ *
+ *  @return uint16_t - The number of samples read but dropped before the pipeline during the last second.
+ */
+uint16_t Accel_GetDroppedRate(void);
+
+/*! @brief Sets up one of the event engines used in ACCEL_EVENT mode.
+ *
+ *  @param event selects the motion or the transient engine.
+ *  @param threshold is the threshold in 0.063 g counts (up to 127), 0 disables the engine.
+ *  @param debounce is the number of samples the threshold must be exceeded for.
+ *  @return bool - TRUE if the engine was set up.
+ */
+bool Accel_SetEventDetection(const TAccelEvent event, const uint8_t threshold, const uint8_t debounce);
+
+/*! @brief Reads and clears the event that raised the accelerometer interrupt.
+ *
+ *  @param source is where the interrupt and event engine sources are stored.
+ *  @return bool - TRUE if a motion or transient event was latched.
+ */
+bool Accel_ReadEventSource(TAccelEventSource* const source);
+
+/*! @brief Checks whether the FIFO has filled since the last trigger.
+ *
+ *  In ACCEL_EVENT mode the FIFO keeps the samples before a trigger, then fills up with the samples after it.
+ *  @return bool - TRUE if the pre-trigger and post-trigger window can be read.
+ */
+bool Accel_EventWindowReady(void);
+
+/*! @brief Reads the samples around the last trigger and re-arms the trigger.
+ *
+ *  @param samples is where the samples are stored, oldest first.
+ *  @param timestamps is where the time of each sample is stored, in microseconds.
+ *  @return uint8_t - The number of samples read.
  */
-void Accel_ReadXYZ(uint8_t data[3]);
+uint8_t Accel_ReadEventWindow(TAccelSample samples[ACCEL_FIFO_SIZE], uint32_t timestamps[ACCEL_FIFO_SIZE]);
 
 /*! @brief Set the mode of the accelerometer.
- *  @param mode specifies either polled or interrupt driven operation.
+ *  @param mode specifies polled, interrupt driven, FIFO batched or event driven operation.
  */
 void Accel_SetMode(const TAccelMode mode);
 
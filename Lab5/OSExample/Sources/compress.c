@@ -0,0 +1,111 @@
+/*! @file
+ *
+ *  @brief Delta compression of blocks of accelerometer samples.
+ *
+ *  This contains the zigzag and nibble varint coding of a block.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup compress_module Compress module documentation
+ **  @{
+ */
+#include "compress.h"
+
+#define NIBBLE_MORE 0x8u	/*!< More nibbles of the value follow */
+#define NIBBLE_BITS 3		/*!< Bits of the value in each nibble */
+
+/*!
+ * @brief A block being written, one nibble at a time.
+ */
+typedef struct
+{
+  uint8_t* bytes;	/*!< The block, or NULL to count the nibbles only */
+  uint16_t nbNibbles;
+} TNibbleWriter;
+
+/*! @brief Appends a nibble to the block.
+ *
+ *  @param writer is the block.
+ *  @param nibble is the nibble, in the low 4 bits.
+ */
+static void PutNibble(TNibbleWriter* const writer, const uint8_t nibble)
+{
+  if (writer->bytes && (writer->nbNibbles & 1))
+  {
+    writer->bytes[writer->nbNibbles / 2] |= nibble;
+  }
+  else if (writer->bytes)
+  {
+    writer->bytes[writer->nbNibbles / 2] = (uint8_t) (nibble << 4);
+  }
+  writer->nbNibbles++;
+}
+
+/*! @brief Appends a value to the block, zigzag then nibble varint coded.
+ *
+ *  @param writer is the block.
+ *  @param value is the value.
+ */
+static void PutValue(TNibbleWriter* const writer, const int32_t value)
+{
+  //Arithmetic shift gives all ones for a negative value, so the sign ends up in bit 0
+  uint32_t code = ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+
+  while (code >> NIBBLE_BITS)
+  {
+    PutNibble(writer, NIBBLE_MORE | (code & (NIBBLE_MORE - 1)));
+    code >>= NIBBLE_BITS;
+  }
+  PutNibble(writer, (uint8_t) code);
+}
+
+/*! @brief Codes a block with differences of a given order.
+ *
+ *  @param writer is the block.
+ *  @param samples are the samples, oldest first.
+ *  @param nbSamples is the number of samples.
+ *  @param shift is how far the samples are shifted right before coding.
+ *  @param order is the order of the differences, 1 or 2.
+ */
+static void Code(TNibbleWriter* const writer, const int16_t samples[][COMPRESS_NB_CHANNELS], const uint8_t nbSamples,
+    const uint8_t shift, const uint8_t order)
+{
+  int32_t previous[COMPRESS_NB_CHANNELS] = { 0 }, slope[COMPRESS_NB_CHANNELS] = { 0 };
+  int32_t value;
+  uint8_t i, channel;
+
+  PutNibble(writer, order);
+  for (i = 0; i < nbSamples; i++)
+  {
+    for (channel = 0; channel < COMPRESS_NB_CHANNELS; channel++)
+    {
+      //The first sample is predicted as 0, so it goes in full
+      value = samples[i][channel] >> shift;
+      PutValue(writer, value - previous[channel] - ((order == 2) ? slope[channel] : 0));
+      if (i > 0)
+      {
+	slope[channel] = value - previous[channel];
+      }
+      previous[channel] = value;
+    }
+  }
+}
+
+uint8_t Compress_Block(const int16_t samples[][COMPRESS_NB_CHANNELS], const uint8_t nbSamples, const uint8_t shift,
+    uint8_t block[COMPRESS_MAX_BYTES])
+{
+  TNibbleWriter first = { 0, 0 }, second = { 0, 0 };
+  TNibbleWriter writer = { block, 0 };
+
+  //Count both ways, then write the shorter
+  Code(&first, samples, nbSamples, shift, 1);
+  Code(&second, samples, nbSamples, shift, 2);
+  Code(&writer, samples, nbSamples, shift, (second.nbNibbles < first.nbNibbles) ? 2 : 1);
+  return (uint8_t) ((writer.nbNibbles + 1) / 2);
+}
+
+/*!
+ ** @}
+ */
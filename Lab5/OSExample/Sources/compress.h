@@ -0,0 +1,52 @@
+/*! @file
+ *
+ *  @brief Delta compression of blocks of accelerometer samples.
+ *
+ *  A block starts with a nibble giving the order of the differences, 1 or 2, then holds its
+ *  first sample in full and each axis of the later samples as a difference from a prediction:
+ *  - order 1 predicts the previous sample, which suits a sensor at rest;
+ *  - order 2 carries on the slope of the previous two samples, which suits smooth motion.
+ *  Either way the second sample is predicted by the first. The encoder picks the order that
+ *  gives the shorter block.
+ *
+ *  Values are zigzag coded (0, -1, 1, -2, ... become 0, 1, 2, 3, ...) so that small
+ *  differences of either sign are small numbers, then written as nibble varints: 3 bits of the
+ *  value per nibble, least significant first, with the top bit of the nibble set when more
+ *  nibbles follow. A difference of -4 to 3 takes one nibble, -32 to 31 two. Nibbles fill each
+ *  byte most significant first; an odd last nibble is padded with 0.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup compress_module Compress module documentation
+ **  @{
+ */
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+// new types
+#include "types.h"
+
+#define COMPRESS_NB_CHANNELS 3		/*!< X, Y and Z */
+#define COMPRESS_MAX_SAMPLES 16		/*!< Samples in the longest block */
+#define COMPRESS_MAX_NIBBLES 6		/*!< Nibbles for the zigzag code of any difference from a prediction of 14-bit values */
+
+// Bytes in a block of the least compressible samples, with the order nibble
+#define COMPRESS_MAX_BYTES ((1 + COMPRESS_MAX_SAMPLES * COMPRESS_NB_CHANNELS * COMPRESS_MAX_NIBBLES + 1) / 2)
+
+/*! @brief Compresses a block of samples.
+ *
+ *  @param samples are the samples, oldest first.
+ *  @param nbSamples is the number of samples, from 1 to COMPRESS_MAX_SAMPLES.
+ *  @param shift is how far the samples are shifted right before coding, to drop bits that are always 0.
+ *  @param block is where the compressed block is stored.
+ *  @return uint8_t - The length of the compressed block in bytes.
+ */
+uint8_t Compress_Block(const int16_t samples[][COMPRESS_NB_CHANNELS], const uint8_t nbSamples, const uint8_t shift,
+    uint8_t block[COMPRESS_MAX_BYTES]);
+
+/*!
+ ** @}
+ */
+#endif
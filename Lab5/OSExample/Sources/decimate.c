@@ -0,0 +1,166 @@
+/*! @file
+ *
+ *  @brief Decimation of the accelerometer data to the rate the serial link can carry.
+ *
+ *  This contains the CIC decimation filter and the control of its factor.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup decimate_module Decimate module documentation
+ **  @{
+ */
+#include <string.h>
+#include "decimate.h"
+
+static volatile uint8_t MinFactor;	/*!< M as set, the smallest M in automatic mode */
+static volatile bool Automatic;
+static uint8_t Factor;			/*!< M in use */
+static uint8_t Phase;			/*!< Samples added since the last output */
+static uint8_t Calm;			/*!< Outputs in a row with the queue mostly empty */
+
+// The integrators wrap modulo 2^32, which the combs undo exactly
+static uint32_t Integrator1[DECIMATE_NB_CHANNELS], Integrator2[DECIMATE_NB_CHANNELS];
+static uint32_t Comb1[DECIMATE_NB_CHANNELS], Comb2[DECIMATE_NB_CHANNELS];
+static int16_t Last[DECIMATE_NB_CHANNELS];	/*!< The last output sample */
+
+/*! @brief Starts decimating by a new factor.
+ *
+ *  The combs are loaded as though the last output had been the input forever, so the first output
+ *  at the new factor follows on from it.
+ *  @param factor is the new M.
+ */
+static void Restart(const uint8_t factor)
+{
+  uint8_t channel;
+
+  Factor = factor;
+  Phase = 0;
+  Calm = 0;
+  for (channel = 0; channel < DECIMATE_NB_CHANNELS; channel++)
+  {
+    Integrator1[channel] = 0;
+    Integrator2[channel] = 0;
+    Comb1[channel] = 0;
+    Comb2[channel] = (uint32_t) (-(int32_t) Last[channel] * (factor * (factor - 1) / 2));
+  }
+}
+
+/*! @brief Divides by the CIC gain, rounding half away from zero.
+ *
+ *  @param sum is the comb output.
+ *  @return int16_t - The sum divided by M^2.
+ */
+static int16_t Scale(const int32_t sum)
+{
+  const int32_t gain = (int32_t) Factor * Factor;
+
+  return (int16_t) ((sum >= 0) ? (sum + gain / 2) / gain : -((-sum + gain / 2) / gain));
+}
+
+/*! @brief Adjusts M from the transmit queue headroom, once per output.
+ *
+ *  M doubles as soon as the queue runs short of space, and comes back down only once it has
+ *  stayed mostly empty for a while, so it does not hunt between two values.
+ *  @param headroom is the free space in the transmit queue, in percent.
+ */
+static void Adapt(const uint8_t headroom)
+{
+  uint8_t factor = Factor;
+
+  if (headroom < DECIMATE_LOW_HEADROOM)
+  {
+    Calm = 0;
+    factor = (Factor > DECIMATE_MAX_FACTOR / 2) ? DECIMATE_MAX_FACTOR : Factor * 2;
+  }
+  else if ((headroom > DECIMATE_HIGH_HEADROOM) && (Factor > MinFactor))
+  {
+    if (++Calm >= DECIMATE_SETTLE_OUTPUTS)
+    {
+      factor = (Factor / 2 < MinFactor) ? MinFactor : Factor / 2;
+    }
+  }
+  else
+  {
+    Calm = 0;
+  }
+
+  if (factor != Factor)
+  {
+    Restart(factor);
+  }
+}
+
+bool Decimate_Init(void)
+{
+  memset(Last, 0, sizeof(Last));
+  MinFactor = 1;
+  Automatic = false;
+  Restart(1);
+  return true;
+}
+
+bool Decimate_Set(const uint8_t factor, const bool automatic)
+{
+  if ((factor < 1) || (factor > DECIMATE_MAX_FACTOR))
+  {
+    return false;
+  }
+
+  MinFactor = factor;
+  Automatic = automatic;
+  return true;
+}
+
+uint8_t Decimate_GetFactor(void)
+{
+  return Factor;
+}
+
+bool Decimate_IsAutomatic(void)
+{
+  return Automatic;
+}
+
+bool Decimate_Update(const int16_t in[DECIMATE_NB_CHANNELS], int16_t out[DECIMATE_NB_CHANNELS], const uint8_t headroom)
+{
+  uint32_t comb1;
+  uint8_t channel;
+
+  //Settings from the packet thread are applied here, between samples
+  if ((Factor < MinFactor) || (!Automatic && (Factor != MinFactor)))
+  {
+    Restart(MinFactor);
+  }
+
+  for (channel = 0; channel < DECIMATE_NB_CHANNELS; channel++)
+  {
+    Integrator1[channel] += (uint32_t) (int32_t) in[channel];
+    Integrator2[channel] += Integrator1[channel];
+  }
+  if (++Phase < Factor)
+  {
+    return false;
+  }
+  Phase = 0;
+
+  for (channel = 0; channel < DECIMATE_NB_CHANNELS; channel++)
+  {
+    comb1 = Integrator2[channel] - Comb1[channel];
+    Comb1[channel] = Integrator2[channel];
+    Last[channel] = Scale((int32_t) (comb1 - Comb2[channel]));
+    Comb2[channel] = comb1;
+  }
+  memcpy(out, Last, sizeof(Last));
+
+  if (Automatic)
+  {
+    Adapt(headroom);
+  }
+  return true;
+}
+
+/*!
+ ** @}
+ */
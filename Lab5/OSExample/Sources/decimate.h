@@ -0,0 +1,71 @@
+/*! @file
+ *
+ *  @brief Decimation of the accelerometer data to the rate the serial link can carry.
+ *
+ *  A second order CIC filter (two integrators, downsampling by M, two combs) keeps aliasing down
+ *  for any M without multiplications. In automatic mode M follows the free space in the UART
+ *  transmit queue, so the sensor can sample fast while the link carries what it can.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup decimate_module Decimate module documentation
+ **  @{
+ */
+#ifndef DECIMATE_H
+#define DECIMATE_H
+
+// new types
+#include "types.h"
+
+#define DECIMATE_NB_CHANNELS 3		/*!< X, Y and Z are decimated together */
+#define DECIMATE_MAX_FACTOR 16		/*!< Largest M; the CIC gain M^2 stays well inside 32 bits */
+
+// Automatic mode doubles M when the transmit queue is less than DECIMATE_LOW_HEADROOM % free, and halves it
+// once the queue has been more than DECIMATE_HIGH_HEADROOM % free for DECIMATE_SETTLE_OUTPUTS outputs in a row
+#define DECIMATE_LOW_HEADROOM 25
+#define DECIMATE_HIGH_HEADROOM 75
+#define DECIMATE_SETTLE_OUTPUTS 16
+
+/*! @brief Sets up the decimation to pass every sample.
+ *
+ *  @return bool - TRUE if the decimation was set up.
+ */
+bool Decimate_Init(void);
+
+/*! @brief Sets the decimation factor.
+ *
+ *  The change takes effect with the next sample. The filter is preloaded with the last output, so
+ *  the output carries on without a step.
+ *  @param factor is M, from 1 to DECIMATE_MAX_FACTOR, or the smallest M in automatic mode.
+ *  @param automatic is TRUE to let M follow the transmit queue headroom.
+ *  @return bool - TRUE if the factor is valid.
+ */
+bool Decimate_Set(const uint8_t factor, const bool automatic);
+
+/*! @brief Gets the decimation factor in use.
+ *
+ *  @return uint8_t - M.
+ */
+uint8_t Decimate_GetFactor(void);
+
+/*! @brief Gets whether the decimation factor follows the transmit queue.
+ *
+ *  @return bool - TRUE in automatic mode.
+ */
+bool Decimate_IsAutomatic(void);
+
+/*! @brief Adds a sample, and gets an output sample every M samples.
+ *
+ *  @param in is the new sample of each channel, in 14-bit counts.
+ *  @param out is where the output sample is stored, when there is one.
+ *  @param headroom is the free space in the transmit queue, in percent.
+ *  @return bool - TRUE if an output sample was produced.
+ */
+bool Decimate_Update(const int16_t in[DECIMATE_NB_CHANNELS], int16_t out[DECIMATE_NB_CHANNELS], const uint8_t headroom);
+
+/*!
+ ** @}
+ */
+#endif
@@ -0,0 +1,167 @@
+/*! @file
+ *
+ *  @brief Fixed-point low-pass and high-pass filters for accelerometer data.
+ *
+ *  This contains the coefficient sets and the biquad and FIR filter routines.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup filter_module Filter module documentation
+ **  @{
+ */
+#include <string.h>
+#include "filter.h"
+
+// Butterworth sections from the bilinear transform (Q = 1/sqrt(2)), rounded so the DC gain is exact
+static const TBiquadCoefficients LOW_PASS_10 = { 1105, 2210, 1105, -18727, 6763 };
+static const TBiquadCoefficients LOW_PASS_40 = { 91, 181, 91, -29141, 13120 };
+static const TBiquadCoefficients HIGH_PASS_100 = { 15672, -31344, 15672, -31313, 14991 };
+static const TBiquadCoefficients BAND_PASS[2] = {
+  { 15672, -31344, 15672, -31313, 14991 },
+  { 1105, 2210, 1105, -18727, 6763 }
+};
+
+// Hamming windowed sinc, summing to 32768 for unity gain at DC
+static const int16_t FIR_LOW_PASS_8[FILTER_MAX_TAPS] = {
+  -84, -219, -374, 0, 1582, 4321, 7054, 8208, 7054, 4321, 1582, 0, -374, -219, -84
+};
+
+const TFilterSet FILTER_SETS[FILTER_NB_SETS] = {
+  [FILTER_SET_NONE]           = { FILTER_TYPE_NONE, 0, 0, 0 },
+  [FILTER_SET_LOW_PASS_10]    = { FILTER_TYPE_BIQUAD, 1, &LOW_PASS_10, 0 },
+  [FILTER_SET_LOW_PASS_40]    = { FILTER_TYPE_BIQUAD, 1, &LOW_PASS_40, 0 },
+  [FILTER_SET_HIGH_PASS_100]  = { FILTER_TYPE_BIQUAD, 1, &HIGH_PASS_100, 0 },
+  [FILTER_SET_BAND_PASS]      = { FILTER_TYPE_BIQUAD, 2, BAND_PASS, 0 },
+  [FILTER_SET_FIR_LOW_PASS_8] = { FILTER_TYPE_FIR, FILTER_MAX_TAPS, 0, FIR_LOW_PASS_8 }
+};
+
+/*! @brief Rounds a fixed-point value to a whole number of its units.
+ *
+ *  @param value is the value.
+ *  @param shift is the number of fractional bits.
+ *  @return int64_t - The value rounded half up.
+ */
+static int64_t Round(const int64_t value, const uint8_t shift)
+{
+  return (value + ((int64_t) 1 << (shift - 1))) >> shift;
+}
+
+/*! @brief Saturates a value to 14-bit counts.
+ *
+ *  @param value is the value.
+ *  @return int16_t - The nearest value in the output range.
+ */
+static int16_t Saturate(const int64_t value)
+{
+  if (value > FILTER_OUTPUT_MAX)
+  {
+    return FILTER_OUTPUT_MAX;
+  }
+  if (value < FILTER_OUTPUT_MIN)
+  {
+    return FILTER_OUTPUT_MIN;
+  }
+  return (int16_t) value;
+}
+
+/*! @brief Runs a sample through a biquad cascade.
+ *
+ *  Direct form I: the feedback keeps FILTER_STATE_SHIFT fractional bits, so the rounding of
+ *  each output is not recirculated through poles close to the unit circle.
+ *  @param filter is the filter.
+ *  @param channel is the channel.
+ *  @param in is the sample.
+ *  @return int16_t - The output of the last section.
+ */
+static int16_t Biquads(TFilter* const filter, const uint8_t channel, int16_t in)
+{
+  uint8_t stage;
+
+  for (stage = 0; stage < filter->set->nbStages; stage++)
+  {
+    const TBiquadCoefficients* const c = &filter->set->biquads[stage];
+    TBiquadState* const s = &filter->biquad[stage][channel];
+    int64_t sum;
+    int32_t y;
+
+    sum = ((int64_t) ((int32_t) c->b0 * in + (int32_t) c->b1 * s->x1 + (int32_t) c->b2 * s->x2) << FILTER_STATE_SHIFT)
+	- (int64_t) c->a1 * s->y1 - (int64_t) c->a2 * s->y2;
+    y = (int32_t) Round(sum, FILTER_COEF_SHIFT_BIQUAD);
+
+    s->x2 = s->x1;
+    s->x1 = in;
+    s->y2 = s->y1;
+    s->y1 = y;
+    in = Saturate(Round(y, FILTER_STATE_SHIFT));
+  }
+  return in;
+}
+
+/*! @brief Runs a sample through an FIR filter.
+ *
+ *  The history is a ring, so a sample is stored once rather than shifting the taps.
+ *  @param filter is the filter.
+ *  @param channel is the channel.
+ *  @return int16_t - The output.
+ */
+static int16_t FIR(const TFilter* const filter, const uint8_t channel)
+{
+  const int16_t* const history = filter->history[channel];
+  const uint8_t nbTaps = filter->set->nbStages;
+  uint8_t tap, i = filter->newest;
+  int64_t sum = 0;
+
+  for (tap = 0; tap < nbTaps; tap++)
+  {
+    sum += (int32_t) filter->set->taps[tap] * history[i];
+    i = (i == 0) ? nbTaps - 1 : i - 1;
+  }
+  return Saturate(Round(sum, FILTER_COEF_SHIFT_FIR));
+}
+
+bool Filter_Init(TFilter* const filter, const uint8_t setIndex)
+{
+  if (setIndex >= FILTER_NB_SETS)
+  {
+    return false;
+  }
+
+  memset(filter, 0, sizeof(*filter));
+  filter->set = &FILTER_SETS[setIndex];
+  filter->setIndex = setIndex;
+  return true;
+}
+
+void Filter_Update(TFilter* const filter, const int16_t in[FILTER_NB_CHANNELS], int16_t out[FILTER_NB_CHANNELS])
+{
+  uint8_t channel;
+
+  switch (filter->set->type)
+  {
+    case FILTER_TYPE_BIQUAD:
+      for (channel = 0; channel < FILTER_NB_CHANNELS; channel++)
+      {
+	out[channel] = Biquads(filter, channel, in[channel]);
+      }
+      break;
+
+    case FILTER_TYPE_FIR:
+      filter->newest = (filter->newest + 1 == filter->set->nbStages) ? 0 : filter->newest + 1;
+      for (channel = 0; channel < FILTER_NB_CHANNELS; channel++)
+      {
+	filter->history[channel][filter->newest] = in[channel];
+	out[channel] = FIR(filter, channel);
+      }
+      break;
+
+    default:
+      memcpy(out, in, FILTER_NB_CHANNELS * sizeof(out[0]));
+      break;
+  }
+}
+
+/*!
+ ** @}
+ */
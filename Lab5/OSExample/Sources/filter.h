@@ -0,0 +1,118 @@
+/*! @file
+ *
+ *  @brief Fixed-point low-pass and high-pass filters for accelerometer data.
+ *
+ *  Biquad (IIR) and FIR filters on X, Y and Z in integer arithmetic, with a choice of
+ *  coefficient sets held in flash. Cut-off frequencies are fractions of the sample rate,
+ *  so they follow the accelerometer output data rate.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+/*!
+ **  @addtogroup filter_module Filter module documentation
+ **  @{
+ */
+#ifndef FILTER_H
+#define FILTER_H
+
+// new types
+#include "types.h"
+
+#define FILTER_NB_CHANNELS 3	/*!< X, Y and Z are filtered together */
+#define FILTER_MAX_BIQUADS 2	/*!< Biquad sections in the longest cascade */
+#define FILTER_MAX_TAPS 15	/*!< Taps in the longest FIR */
+#define FILTER_COEF_SHIFT_BIQUAD 14	/*!< Biquad coefficients are Q2.14, so that a1 can reach -2 */
+#define FILTER_COEF_SHIFT_FIR 15	/*!< FIR coefficients are Q15 */
+#define FILTER_STATE_SHIFT 8	/*!< Fractional bits kept in the biquad feedback, against rounding noise */
+
+// Outputs saturate to the range of 14-bit accelerometer counts
+#define FILTER_OUTPUT_MIN (-8192)
+#define FILTER_OUTPUT_MAX 8191
+
+/*!
+ * @brief The coefficient sets, selected by packet.
+ */
+typedef enum
+{
+  FILTER_SET_NONE,		/*!< Samples pass through unchanged */
+  FILTER_SET_LOW_PASS_10,	/*!< 2nd order Butterworth low-pass at fs/10 */
+  FILTER_SET_LOW_PASS_40,	/*!< 2nd order Butterworth low-pass at fs/40 */
+  FILTER_SET_HIGH_PASS_100,	/*!< 2nd order Butterworth high-pass at fs/100, removes gravity */
+  FILTER_SET_BAND_PASS,		/*!< High-pass at fs/100 then low-pass at fs/10 */
+  FILTER_SET_FIR_LOW_PASS_8,	/*!< 15-tap Hamming windowed-sinc low-pass at fs/8, linear phase */
+  FILTER_NB_SETS
+} TFilterSetIndex;
+
+typedef enum
+{
+  FILTER_TYPE_NONE,
+  FILTER_TYPE_BIQUAD,
+  FILTER_TYPE_FIR
+} TFilterType;
+
+/*!
+ * @brief Biquad coefficients in Q2.14, for y = b0.x + b1.x1 + b2.x2 - a1.y1 - a2.y2.
+ */
+typedef struct
+{
+  int16_t b0, b1, b2, a1, a2;
+} TBiquadCoefficients;
+
+/*!
+ * @brief A coefficient set.
+ */
+typedef struct
+{
+  TFilterType type;
+  uint8_t nbStages;				/*!< Biquad sections in cascade, or FIR taps */
+  const TBiquadCoefficients* biquads;		/*!< The sections in order, for a biquad cascade */
+  const int16_t* taps;				/*!< The Q15 taps, for an FIR */
+} TFilterSet;
+
+/*!
+ * @brief The history of one biquad section on one channel.
+ */
+typedef struct
+{
+  int16_t x1, x2;				/*!< Previous inputs */
+  int32_t y1, y2;				/*!< Previous outputs, with FILTER_STATE_SHIFT fractional bits */
+} TBiquadState;
+
+/*!
+ * @brief The state of a filter on X, Y and Z.
+ */
+typedef struct
+{
+  const TFilterSet* set;
+  uint8_t setIndex;
+  TBiquadState biquad[FILTER_MAX_BIQUADS][FILTER_NB_CHANNELS];
+  int16_t history[FILTER_NB_CHANNELS][FILTER_MAX_TAPS];	/*!< FIR inputs, as a ring */
+  uint8_t newest;				/*!< Ring index of the newest FIR input */
+} TFilter;
+
+/*! @brief The coefficient sets, indexed by TFilterSetIndex. They are constant and so live in flash.
+ */
+extern const TFilterSet FILTER_SETS[FILTER_NB_SETS];
+
+/*! @brief Selects a coefficient set and clears the filter history.
+ *
+ *  @param filter is the filter to set up.
+ *  @param setIndex is the coefficient set.
+ *  @return bool - TRUE if the set exists.
+ */
+bool Filter_Init(TFilter* const filter, const uint8_t setIndex);
+
+/*! @brief Filters a sample on each channel.
+ *
+ *  The arithmetic is all integer, accumulated in 64 bits and rounded once per stage.
+ *  @param filter is the filter.
+ *  @param in is the new sample of each channel, in 14-bit counts.
+ *  @param out is where the filtered sample of each channel is stored, saturated to 14-bit counts.
+ */
+void Filter_Update(TFilter* const filter, const int16_t in[FILTER_NB_CHANNELS], int16_t out[FILTER_NB_CHANNELS]);
+
+/*!
+ ** @}
+ */
+#endif
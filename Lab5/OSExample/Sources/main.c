@@ -42,151 +42,380 @@
 #include "RTC.h"
 #include "PIT.h"
 #include "FTM.h"
+#include "Timer.h"
 #include "median.h"
+#include "filter.h"
+#include "decimate.h"
+#include "compress.h"
 #include "I2C.h"
 #include "accel.h"
+#include "Timestamp.h"
+#include "Profile.h"
 #include <string.h>
 #include "OS.h"
 
 #define THREAD_STACK_SIZE 100
 
+#define MEDIAN_TAPS 3		/*!< Window length of the median filter on the accelerometer data */
+
+#define SIGN_FLIP_XYZ 0x00808080u	/*!< Flips the sign bit of the X, Y and Z bytes in a packed sample */
+#define MONITOR_PERIOD 20000000	/*!< How often the I2C bus is supervised, in nanoseconds */
+#define EVENT_POLL_TICKS 10	/*!< How often the accel thread checks whether the window after an event is complete */
+#define SAMPLE_TICK_FLAG 0x100u	/*!< Set in AccelFlags by the PIT sample channel */
+#define SAMPLE_QUEUE_SIZE (2 * ACCEL_FIFO_SIZE)	/*!< Room for a FIFO block to be read while the last is still being filtered */
+
+/*!
+ * @brief A sample on its way from the accel thread to the sample thread.
+ */
+typedef struct
+{
+  TAccelSample sample;
+  uint32_t timestamp;	/*!< In microseconds */
+  bool filter;		/*!< FALSE for a sample around an event, which is sent as it is */
+} TSampleMessage;
+
 /****************************************PRIVATE FUNCTION DECLARATION**************************************/
 static void FTM0Callback(void *arg);
 static void RTCCallback(void *arg);
-static void PITCallback(void *arg);
-static void SlidingWindow(uint8_t* const array, const size_t arraylength, const uint8_t newValue);
-static void HandleMedianData();
+static void SendSample(const TAccelSample* const sample, const uint32_t timestamp);
+static void MedianBytes(const TAccelSample* const sample, TAccelSample* const median);
+static void HandleSample(const TAccelSample* const sample, const uint32_t timestamp);
+static void PostSample(const TAccelSample* const sample, const uint32_t timestamp, const bool filter);
+static void PostRead(const uint8_t* const data, const uint32_t timestamp);
+static void HandleSampleBlock(const TAccelSample* const samples, const uint32_t* const timestamps, const uint8_t nbSamples);
+static void HandleEvent(void);
+static void HandleSleepChange(void);
 static void InitThread(void* data);
 static void PacketThread(void* data);
-static void PITThread(void* data);
+static void MonitorThread(void* data);
 static void RTCThread(void* data);
 static void AccelThread(void* data);
-static void I2CThread(void *data);
+static void SampleThread(void* data);
 
 /****************************************THREAD STACKS*****************************************************/
 static uint32_t InitThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 static uint32_t PacketThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 static uint32_t ReceiveThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 static uint32_t TransmitThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
-static uint32_t PITThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
+static uint32_t MonitorThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 static uint32_t RTCThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
-static uint32_t FTM0ThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 static uint32_t AccelThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
-static uint32_t I2CThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
+static uint32_t SampleThreadStack[THREAD_STACK_SIZE] __attribute__ ((aligned(0x08)));
 
 static OS_ECB *InitSemaphore;
+/*!
+ * @brief Samples from the accel thread, in order, to the sample thread, the only thread that filters and sends them.
+ */
+static OS_QUEUE *SampleQueue;
+OS_QUEUE_BUFFER(SampleBuffer, TSampleMessage, SAMPLE_QUEUE_SIZE);
 
 /****************************************GLOBAL VARS*******************************************************/
 const static uint32_t BAUD_RATE = 115200;
 const static uint32_t MODULE_CLOCK = CPU_BUS_CLK_HZ;
 
 /*!
- * @brief Contains the latest accelerometer data
+ * @brief Samples read from the accelerometer FIFO, and the time of each
+ */
+static TAccelSample AccBlock[ACCEL_FIFO_SIZE];
+static uint32_t AccBlockTime[ACCEL_FIFO_SIZE];
+/*!
+ * @brief Time of the last sample sent, in microseconds
+ */
+static uint32_t AccSendTime;
+/*!
+ * @brief The latest accelerometer sample which was sent.
+ */
+static TAccelSample AccelSendHistory;
+/*!
+ * @brief The median filter over the latest samples read from the accelerometer.
  */
-static uint8_t AccReadData[3] = {0};
+static TMedianFilter AccMedian;
 /*!
- * @brief The latest bytes of accelerometer data which were sent.
+ * @brief The filter run after the median filter, on the coefficient set in AccelFilter.
  */
-static uint8_t AccelSendHistory[3] = {0};
+static TFilter AccFilter;
 /*!
- * @brief The latest bytes of X read from the accelerometer .
+ * @brief The last 3 samples at 8-bit resolution, packed X, Y, Z from the low byte with the sign bits flipped.
  */
-static uint8_t AccXHistory[3] = {0};
+static uint32_t AccByteWindow[3] = { SIGN_FLIP_XYZ, SIGN_FLIP_XYZ, SIGN_FLIP_XYZ };
+static uint8_t AccByteOldest = 0;
 /*!
- * @brief The latest bytes of Yread from the accelerometer .
+ * @brief 14-bit samples waiting to be packed and sent.
  */
-static uint8_t AccYHistory[3] = {0};
+static int16_t AccPacked[PACKED_NB_SAMPLES][3];
+static uint32_t AccPackedTime[PACKED_NB_SAMPLES];
+static uint8_t AccNbPacked = 0;
 /*!
- * @brief The latest bytes of Z read from the accelerometer .
+ * @brief Samples waiting to be compressed and sent as a block, and the time of the first.
  */
-static uint8_t AccZHistory[3] = {0};
+static int16_t AccCompressed[COMPRESS_MAX_SAMPLES][3];
+static uint32_t AccCompressedTime;
+static uint8_t AccNbCompressed = 0;
 
 static uint8_t AccTimerRunningFlag = 0;
 
-//TFTMChannel configuration for FTM timer
-TFTMChannel packetTimer = {
-  0, 															//channel
-  CPU_MCGFF_CLK_HZ_CONFIG_0,			//delay count
-  TIMER_FUNCTION_OUTPUT_COMPARE,	//timer function
-  TIMER_OUTPUT_HIGH,							//ioType
-  FTM0Callback,										//User function
-  (void*) 0												//User arguments
+#define TIMER_FTM_CHANNEL 0		/*!< The FTM0 channel the software timers run on */
+#define PACKET_LED_MS 1000		/*!< How long the blue LED stays on after a packet */
+
+/*!
+ * @brief Turns the blue LED off a while after the last packet received.
+ */
+static TTimer PacketLEDTimer = {
+  .userFunction = FTM0Callback,
+  .userArguments = (void*) 0
 };
 
 const static TAccelSetup ACCEL_SETUP = {
   .moduleClk = CPU_BUS_CLK_HZ,
-  .dataReadyCallbackFunction = &HandleMedianData,
+  .dataReadyCallbackFunction = 0, //The accel thread waits on AccelFlags instead
   .dataReadyCallbackArguments = 0,
-  .readCompleteCallbackFunction = &HandleMedianData,
+  .readCompleteCallbackFunction = 0,
   .readCompleteCallbackArguments = 0,
 };
 
 /****************************************PRIVATE FUNCTION DEFINITION***************************************/
 
 /*!
- * @brief slidingwindow Shifts the elements of an array one to the left.
- * @param array The array to shifting window.
- * @param arraylength The length of the array.
- * @param newValue The new value to insert at index 0.
+ * @brief Sends a sample to the PC at the current resolution, or adds it to a compressed block.
+ *
+ * Each sample or block is preceded by the time since the previous one, so the PC can rebuild the
+ * sample spacing whatever the queueing delays were.
+ * @param sample The sample, in 14-bit counts.
+ * @param timestamp The time of the sample, in microseconds.
  */
-void SlidingWindow(uint8_t* const array, const size_t arraylength, const uint8_t newValue)
+void SendSample(const TAccelSample* const sample, const uint32_t timestamp)
 {
-  for (size_t i = (arraylength -1); i > 0; i--)
+  const uint8_t blockLength = Packet_GetBlockLength();
+
+  if (blockLength)
   {
-    array[i] = array [i-1];
+    //Compressed blocks carry the time of their first sample only
+    if (AccNbCompressed == 0)
+    {
+      AccCompressedTime = timestamp;
+    }
+    memcpy(AccCompressed[AccNbCompressed], sample->counts, sizeof(AccCompressed[0]));
+    if (++AccNbCompressed >= blockLength)
+    {
+      Packet_PutTimestamp(AccCompressedTime - AccSendTime);
+      AccSendTime = AccCompressedTime;
+      Packet_PutBlock(AccCompressed, AccNbCompressed, Accel_GetResolution());
+      AccNbCompressed = 0;
+    }
+    return;
+  }
+
+  if (Accel_GetResolution() == ACCEL_RESOLUTION_8_BIT)
+  {
+    Packet_PutTimestamp(timestamp - AccSendTime);
+    AccSendTime = timestamp;
+    Packet_Put(0x10, (uint8_t) (sample->axes.x >> 6), (uint8_t) (sample->axes.y >> 6), (uint8_t) (sample->axes.z >> 6));
+    return;
   }
-  array[0] = newValue;
+
+  //14-bit samples go out packed, a few at a time
+  memcpy(AccPacked[AccNbPacked], sample->counts, sizeof(AccPacked[0]));
+  AccPackedTime[AccNbPacked] = timestamp;
+  if (++AccNbPacked == PACKED_NB_SAMPLES)
+  {
+    for (uint8_t i = 0; i < PACKED_NB_SAMPLES; i++)
+    {
+      Packet_PutTimestamp(AccPackedTime[i] - AccSendTime);
+      AccSendTime = AccPackedTime[i];
+    }
+    Packet_PutPacked(AccPacked);
+    AccNbPacked = 0;
+  }
+}
+
+/*!
+ * @brief Median filters 8-bit samples on all three axes at once.
+ *
+ * At 8-bit resolution the axes fit in one word, so the 3-tap filter is a single packed median.
+ * Flipping the sign bits lets the unsigned byte lanes order the two's complement readings.
+ * @param sample The sample, in 14-bit counts.
+ * @param median Where the median is stored, in 14-bit counts.
+ */
+void MedianBytes(const TAccelSample* const sample, TAccelSample* const median)
+{
+  uint32_t packed;
+
+  AccByteWindow[AccByteOldest] = ((uint32_t) (uint8_t) (sample->axes.x >> 6) | ((uint32_t) (uint8_t) (sample->axes.y >> 6) << 8)
+      | ((uint32_t) (uint8_t) (sample->axes.z >> 6) << 16)) ^ SIGN_FLIP_XYZ;
+  AccByteOldest = (AccByteOldest == 2) ? 0 : AccByteOldest + 1;
+
+  packed = Median_Filter3_Packed(AccByteWindow[0], AccByteWindow[1], AccByteWindow[2]) ^ SIGN_FLIP_XYZ;
+  median->axes.x = (int16_t) ((int8_t) packed * 64);
+  median->axes.y = (int16_t) ((int8_t) (packed >> 8) * 64);
+  median->axes.z = (int16_t) ((int8_t) (packed >> 16) * 64);
 }
 
 /*!
- * @brief Run on the main thread to handle new accelerometer data.
+ * @brief Runs a sample through the median filter, the filter after it and the decimation, or
+ * through the decimation alone in interrupt mode.
+ * @param sample The sample, in 14-bit counts.
+ * @param timestamp The time of the sample, in microseconds.
  */
-void HandleMedianData()
+void HandleSample(const TAccelSample* const sample, const uint32_t timestamp)
 {
+  TAccelSample filtered;
+
+  Accel_CountSamples(1);
+  Accel_RecordTimestamp(timestamp);
+
   if (Accel_GetMode() == ACCEL_INT)
   {
-    Accel_ReadXYZ(AccReadData);
-    Packet_Put(0x10, AccReadData[0], AccReadData[1], AccReadData[2]);
+    if (Decimate_Update(sample->counts, filtered.counts, UART_TxHeadroom()))
+    {
+      SendSample(&filtered, timestamp);
+    }
     return;
   }
 
-  //shifting history
-  SlidingWindow(AccXHistory,3,AccReadData[0]);
-  SlidingWindow(AccYHistory,3,AccReadData[1]);
-  SlidingWindow(AccZHistory,3,AccReadData[2]);
+#if MEDIAN_TAPS == 3
+  if (Accel_GetResolution() == ACCEL_RESOLUTION_8_BIT)
+  {
+    MedianBytes(sample, &filtered);
+  }
+  else
+#endif
+  {
+    Median_Update(&AccMedian, sample->counts, filtered.counts);
+  }
+
+  //The set is changed in flash by the packet thread and picked up here, so only this thread touches the filter
+  if ((AccFilter.setIndex == *AccelFilter) || Filter_Init(&AccFilter, *AccelFilter))
+  {
+    Filter_Update(&AccFilter, filtered.counts, filtered.counts);
+  }
+
+  //Down to the rate the link can carry
+  if (!Decimate_Update(filtered.counts, filtered.counts, UART_TxHeadroom()))
+  {
+    return;
+  }
+
+  if ((filtered.axes.x != AccelSendHistory.axes.x) | (filtered.axes.y != AccelSendHistory.axes.y) | (filtered.axes.z != AccelSendHistory.axes.z))
+  {
+    AccelSendHistory = filtered;
+    SendSample(&filtered, timestamp);
+  }
+}
+
+/*!
+ * @brief Passes a copy of a sample to the sample thread.
+ * @param sample The sample, in 14-bit counts.
+ * @param timestamp The time of the sample, in microseconds.
+ * @param filter FALSE to send the sample as it is.
+ */
+void PostSample(const TAccelSample* const sample, const uint32_t timestamp, const bool filter)
+{
+  const TSampleMessage message = { *sample, timestamp, filter };
+
+  if (OS_QueuePost(SampleQueue, &message) == OS_QUEUE_FULL)
+  {
+    Accel_CountDropped(1); //The sample thread is a whole queue behind; the PC sees it with the achieved rate
+  }
+}
+
+/*!
+ * @brief Passes a sample read with Accel_ReadXYZ to the sample thread.
+ * @param data The raw registers, at the current resolution.
+ * @param timestamp The time of the sample, in microseconds.
+ */
+void PostRead(const uint8_t* const data, const uint32_t timestamp)
+{
+  TAccelSample sample;
+
+  Accel_ConvertSample(data, &sample);
+  PostSample(&sample, timestamp, true);
+}
+
+/*!
+ * @brief Passes a block of samples from the accelerometer FIFO to the sample thread.
+ * @param samples The samples, oldest first.
+ * @param timestamps The time of each sample, in microseconds.
+ * @param nbSamples The number of samples.
+ */
+void HandleSampleBlock(const TAccelSample* const samples, const uint32_t* const timestamps, const uint8_t nbSamples)
+{
+  for (uint8_t i = 0; i < nbSamples; i++)
+  {
+    PostSample(&samples[i], timestamps[i], true);
+  }
+}
+
+/*!
+ * @brief Reports an accelerometer event and streams the samples around it.
+ *
+ * The sensor FIFO holds the samples before the trigger, so nothing runs between events.
+ */
+void HandleEvent(void)
+{
+  TAccelEventSource source;
+  uint8_t nbSamples;
 
-  uint8_t xMedian = Median_Filter3(AccXHistory[0],AccXHistory[1],AccXHistory[2] );
-  uint8_t yMedian = Median_Filter3(AccYHistory[0],AccYHistory[1],AccYHistory[2] );
-  uint8_t zMedian = Median_Filter3(AccZHistory[0],AccZHistory[1],AccZHistory[2] );
+  if (!Accel_ReadEventSource(&source))
+  {
+    return;
+  }
+  Packet_Put(ACCEL_EVENT_COMM, source.interrupt, source.motion, source.transient);
 
-  if ((xMedian!= AccelSendHistory[0]) | (yMedian != AccelSendHistory[1]) | (zMedian != AccelSendHistory[2]))
+  //Wait for the samples after the trigger
+  while (!Accel_EventWindowReady())
   {
-    AccelSendHistory[0] = xMedian;
-    AccelSendHistory[1] = yMedian;
-    AccelSendHistory[2] = zMedian;
+    if (Accel_GetMode() != ACCEL_EVENT)
+    {
+      return;
+    }
+    OS_TimeDelay(EVENT_POLL_TICKS);
+  }
 
-    Packet_Put(0x10, xMedian, yMedian, zMedian);
+  nbSamples = Accel_ReadEventWindow(AccBlock, AccBlockTime);
+  Accel_CountSamples(nbSamples);
+  for (uint8_t i = 0; i < nbSamples; i++)
+  {
+    PostSample(&AccBlock[i], AccBlockTime[i], false);
   }
 }
 
+/*!
+ * @brief Follows the accelerometer between its sleep and wake rates.
+ *
+ * The PIT polls at the rate the sensor is running at, and the PC is told so it knows the
+ * telemetry rate has changed.
+ */
+void HandleSleepChange(void)
+{
+  PIT_Set(PIT_SAMPLE_CHANNEL, Accel_GetSamplePeriod(), true);
+  Packet_Put(ACCEL_SLEEP_COMM, Accel_IsAsleep(), 0x0, 0x0);
+}
+
 /*!
  * @brief Initialise the initial functions
  */
 void TowerInit(void)
 {
+  bool profileStatus = Profile_Init(); //First, so the other modules can be profiled from the start
   bool packetStatus = Packet_Init(BAUD_RATE, MODULE_CLOCK);
   bool flashStatus  = Flash_Init();
   bool ledStatus = LEDs_Init();
-  bool PITStatus = PIT_Init(MODULE_CLOCK, &PITCallback, (void *)0);
-  PIT_Set(500e6, true);
+  bool PITStatus = PIT_Init(MODULE_CLOCK);
+  bool timestampStatus = Timestamp_Init(MODULE_CLOCK);
   bool RTCStatus = RTC_Init(&RTCCallback, (void *)0);
 
   bool FTMStatus = FTM_Init();
-  FTM_Set(&packetTimer);
+  bool timerStatus = Timer_Init(TIMER_FTM_CHANNEL, CPU_MCGFF_CLK_HZ_CONFIG_0);
 
   bool AccelStatus = Accel_Init(&ACCEL_SETUP);
-
-  if (packetStatus && flashStatus && ledStatus && PITStatus && RTCStatus && FTMStatus && AccelStatus)
+  bool medianStatus = Median_Init(&AccMedian, MEDIAN_TAPS);
+  bool filterStatus = Filter_Init(&AccFilter, *AccelFilter) || Filter_Init(&AccFilter, FILTER_SET_NONE);
+  bool decimateStatus = Decimate_Init();
+  PITStatus = PITStatus && PIT_SetFlags(PIT_SAMPLE_CHANNEL, AccelFlags, SAMPLE_TICK_FLAG) //Wakes the accel thread
+    && PIT_Set(PIT_SAMPLE_CHANNEL, Accel_GetSamplePeriod(), true) //Poll at the output data rate
+    && PIT_Set(PIT_MONITOR_CHANNEL, MONITOR_PERIOD, true);
+
+  if (profileStatus && packetStatus && flashStatus && ledStatus && PITStatus && timestampStatus && RTCStatus && FTMStatus && timerStatus && AccelStatus && medianStatus && filterStatus && decimateStatus)
   {
     LEDs_On(LED_ORANGE);	//Tower was initialized correctly
   }
@@ -223,48 +452,104 @@ void PacketThread(void* data)
     if (Packet_Get())	//Check if there is a packet in the retrieved data
     {
       LEDs_On(LED_BLUE);
-      FTM_StartTimer(&packetTimer);
-      Packet_Handle();
+      Timer_Start(&PacketLEDTimer, PACKET_LED_MS, 0);
+      {
+	PROFILE_BEGIN(PROFILE_PACKET_HANDLE);
+	Packet_Handle();
+	PROFILE_END(PROFILE_PACKET_HANDLE);
+      }
     }
   }
 }
 
 /*!
- * @brief Runs pit thread
+ * @brief Runs monitor thread
+ *
+ * Supervises the I2C bus on its own PIT channel, so a stuck transfer is recovered as quickly at
+ * the slowest sample rates as at the fastest.
  */
-void PITThread(void* data)
+void MonitorThread(void* data)
 {
   for (;;)
   {
-    //Wait on PIT Semaphire
-    OS_SemaphoreWait(PITSemaphore, 0);
-
-    LEDs_Toggle(LED_GREEN);
-    //The code stops working with the following code.
-    if (Accel_GetMode() == ACCEL_POLL)
-    {
-      //TODO: ASYNC I2C
-//      Accel_ReadXYZ(AccReadData);
-//      //HandleMedianData();
-//      Packet_Put(0x10, AccReadData[0], AccReadData[1], AccReadData[2]);
-    }
+    OS_SemaphoreWait(PITSemaphore[PIT_MONITOR_CHANNEL], 0);
+    I2C_Service(); //Recover the sensor bus if a transfer is stuck
   }
 }
 
 /*!
  * @brief Runs accel thread
+ *
+ * Reads every sample from the accelerometer, whichever of the accelerometer interrupt, the end of an
+ * interrupt driven read or the PIT sample channel it is waiting for, and passes them on in order
+ * to the sample thread.
  */
 void AccelThread(void* data)
 {
+  uint8_t pollData[ACCEL_MAX_SAMPLE_SIZE];
+  uint8_t intData[ACCEL_MAX_SAMPLE_SIZE]; //Belongs to the I2C driver while a read is in progress
+  uint32_t intTime = 0;
+  uint32_t ready;
+
   for (;;)
   {
-    //Wait on Accel Semaphore
-    OS_SemaphoreWait(AccelSemaphore, 0);
-    Accel_ReadXYZ(AccReadData);
-    //HandleMedianData();
+    (void)OS_FlagsWait(AccelFlags, ACCEL_FLAG_DATA_READY | ACCEL_FLAG_READ_DONE | SAMPLE_TICK_FLAG, false, 0, &ready);
+
+    if (ready & SAMPLE_TICK_FLAG)
+    {
+      LEDs_Toggle(LED_GREEN);
+      if (Accel_GetMode() == ACCEL_POLL)
+      {
+	const uint32_t pollTime = Timestamp_Now();
+
+	Accel_ReadXYZ(pollData); //Blocks this thread only while the ISR runs the transfer
+	PostRead(pollData, pollTime);
+      }
+    }
+
+    //Before a new data ready starts another read into intData
+    if (ready & ACCEL_FLAG_READ_DONE)
+    {
+      if (I2C_IntReadStatus() == I2C_STATUS_OK)
+      {
+	PostRead(intData, intTime);
+      }
+      else
+      {
+	//Read again, otherwise the accelerometer keeps its interrupt asserted and never raises another
+	Accel_ReadXYZ(intData);
+      }
+    }
+
+    if (!(ready & ACCEL_FLAG_DATA_READY))
+    {
+      continue;
+    }
+    if (((Accel_GetMode() == ACCEL_POLL) || (Accel_GetMode() == ACCEL_FIFO)) && Accel_UpdateSleepState())
+    {
+      HandleSleepChange();
+    }
+
+    if (Accel_GetMode() == ACCEL_FIFO)
+    {
+      //One burst for the whole block; on a sleep/wake transition this flushes the partial block,
+      //so the tail of the activity does not wait a whole block at the sleep rate
+      HandleSampleBlock(AccBlock, AccBlockTime, Accel_ReadFIFO(AccBlock, AccBlockTime));
+    }
+    else if (Accel_GetMode() == ACCEL_EVENT)
+    {
+      HandleEvent();
+    }
+    else if (Accel_GetMode() == ACCEL_INT)
+    {
+      //Start the read; I2C_ISR sets ACCEL_FLAG_READ_DONE when intData holds it
+      if (I2C_IntReadStatus() != I2C_STATUS_PENDING)
+      {
+	intTime = Accel_GetDataReadyTime();
+      }
+      Accel_ReadXYZ(intData);
+    }
     LEDs_Toggle(LED_GREEN);
-    Packet_Put(0x10, AccReadData[0], AccReadData[1], AccReadData[2]);
-    (void)OS_SemaphoreSignal(AccelSemaphore);
   }
 }
 
@@ -273,41 +558,53 @@ void AccelThread(void* data)
  */
 void RTCThread(void* data)
 {
+  TRTCDateTime now;
+  uint32_t date = 0, today; //The date last sent, and today's, as year, month, day from the high bits
+
   for (;;)
   {
     //Wait on RTC Semaphore
     OS_SemaphoreWait(RTCSemaphore, 0);
 
-    uint8_t h, m ,s;
-    RTC_Get(&h, &m, &s); //Get hours, mins, secs
-    Packet_Put(0x0c, h, m, s); //Send to PC
+    Accel_RateTick(); //The RTC interrupts once per second
+    (void) Timestamp_Now64(); //Keeps the microsecond count in step with the hardware counter
+
+    RTC_GetDateTime(&now); //Get the date and time, moved on a second from the last
+    today = ((uint32_t) now.year << 16) | ((uint32_t) now.month << 8) | now.day;
+    if (today != date)
+    {
+      date = today;
+      Packet_Put(RTC_DATE_COMM, now.day, now.month, now.year - RTC_EPOCH_YEAR);
+    }
+    Packet_Put(0x0c, now.hours, now.minutes, now.seconds); //Send to PC
+    Packet_PutLoad(); //The load over the last second, if the PC is streaming it
     LEDs_Toggle(LED_YELLOW); //Toggle Yellow LED
   }
 }
 
 /*!
- * @brief Runs FTM0 thread
+ * @brief Runs sample thread
+ *
+ * Filters and sends the samples the accel thread reads. No other thread touches the filters or
+ * the samples waiting to be sent.
  */
-void FTM0Thread(void *data)
+void SampleThread(void *data)
 {
-  for (;;)
-  {
-    //Wait on the FTM0 Semaphore
-    OS_SemaphoreWait(FTM0Semaphore, 0);
-    LEDs_Off(LED_BLUE);
-  }
-}
+  TSampleMessage message;
 
-/*!
- * @brief Runs I2C thread
- */
-void I2CThread(void *data)
-{
   for (;;)
   {
-    //Wait on the I2C Semaphore
-    OS_SemaphoreWait(I2CSemaphore, 0);
-    HandleMedianData();
+    (void)OS_QueuePend(SampleQueue, &message, 0);
+    PROFILE_BEGIN(PROFILE_HANDLE_MEDIAN_DATA);
+    if (message.filter)
+    {
+      HandleSample(&message.sample, message.timestamp);
+    }
+    else
+    {
+      SendSample(&message.sample, message.timestamp);
+    }
+    PROFILE_END(PROFILE_HANDLE_MEDIAN_DATA);
   }
 }
 
@@ -329,17 +626,17 @@ int main(void)
 
   // Create Initialisation Semaphore
   InitSemaphore = OS_SemaphoreCreate(1);
-
-  // Create threads
-  error = OS_ThreadCreate(InitThread, NULL, &InitThreadStack[THREAD_STACK_SIZE-1], 0);
-  error = OS_ThreadCreate(ReceiveThread, NULL, &ReceiveThreadStack[THREAD_STACK_SIZE-1], 1);
-  error = OS_ThreadCreate(TransmitThread, NULL, &TransmitThreadStack[THREAD_STACK_SIZE-1], 2);
-  error = OS_ThreadCreate(PITThread, NULL, &PITThreadStack[THREAD_STACK_SIZE-1], 3);
-  error = OS_ThreadCreate(RTCThread, NULL, &RTCThreadStack[THREAD_STACK_SIZE-1], 4);
-  error = OS_ThreadCreate(FTM0Thread, NULL, &FTM0ThreadStack[THREAD_STACK_SIZE-1], 5);
-  error = OS_ThreadCreate(PacketThread, NULL, &PacketThreadStack[THREAD_STACK_SIZE-1], 6);
-  error = OS_ThreadCreate(AccelThread, NULL, &AccelThreadStack[THREAD_STACK_SIZE-1], 7);
-  error = OS_ThreadCreate(I2CThread, NULL, &I2CThreadStack[THREAD_STACK_SIZE-1], 8);
+  SampleQueue = OS_QueueCreate(SampleBuffer, sizeof(TSampleMessage), SAMPLE_QUEUE_SIZE);
+
+  // Create threads, with painted stacks so the STACK packet can report their usage
+  error = OS_ThreadCreateStack(InitThread, NULL, InitThreadStack, THREAD_STACK_SIZE, 0);
+  error = OS_ThreadCreateStack(ReceiveThread, NULL, ReceiveThreadStack, THREAD_STACK_SIZE, 1);
+  error = OS_ThreadCreateStack(TransmitThread, NULL, TransmitThreadStack, THREAD_STACK_SIZE, 2);
+  error = OS_ThreadCreateStack(AccelThread, NULL, AccelThreadStack, THREAD_STACK_SIZE, 3);
+  error = OS_ThreadCreateStack(RTCThread, NULL, RTCThreadStack, THREAD_STACK_SIZE, 4);
+  error = OS_ThreadCreateStack(MonitorThread, NULL, MonitorThreadStack, THREAD_STACK_SIZE, 5);
+  error = OS_ThreadCreateStack(PacketThread, NULL, PacketThreadStack, THREAD_STACK_SIZE, 6);
+  error = OS_ThreadCreateStack(SampleThread, NULL, SampleThreadStack, THREAD_STACK_SIZE, 7);
 
   // Start threads
   OS_Start();
@@ -364,19 +661,7 @@ void RTCCallback(void *arg)
   LEDs_Toggle(LED_YELLOW);	//Toggle Yellow LED
 }
 
-//PITCallback function from PIT_ISR
-void PITCallback(void *arg)
-{
-  LEDs_Toggle(LED_GREEN);
-  if (Accel_GetMode() == ACCEL_POLL)
-  {
-    Accel_ReadXYZ(AccReadData);
-    //HandleMedianData();
-    Packet_Put(0x10, AccReadData[0], AccReadData[1], AccReadData[2]);
-  }
-}
-
-//FTM0Callback function from FTM_ISR
+//FTM0Callback function from the packet LED timer, in FTM0_ISR
 void FTM0Callback(void *arg)
 {
   LEDs_Off(LED_BLUE);
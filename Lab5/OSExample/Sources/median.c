@@ -2,7 +2,9 @@
  *
  *  @brief Median filter.
  *
- *  This contains the functions for performing a median filter on byte-sized data.
+ *  This contains the functions for performing a median filter on byte-sized and 16-bit data,
+ *  on four byte lanes packed in a word, and a streaming median filter over a sliding window
+ *  of 3 to 31 samples.
  *
  *  @author Corey Stidston and Menka Mehta
  *  @date 2015-10-12
@@ -34,6 +36,182 @@
        return n3;
    }
  }
+ #if !defined(__ARM_FEATURE_SIMD32)
+ #define LANE_MSB 0x80808080u
+
+ /*! @brief Compares 4 unsigned byte lanes, the portable stand-in for USUB8's GE flags.
+  *
+  *  @return uint32_t - 0xFF in each lane where a >= b, 0x00 elsewhere.
+  */
+
+ static uint32_t GreaterOrEqual8(const uint32_t a, const uint32_t b)
+ {
+   //Lane-wise a - b, kept from borrowing across lanes, then the borrow out of each lane's top bit
+   const uint32_t difference = ((a | LANE_MSB) - (b & ~LANE_MSB)) ^ ((a ^ ~b) & LANE_MSB);
+   const uint32_t borrow = ((~a & b) | (~(a ^ b) & difference)) & LANE_MSB;
+
+   return ~((borrow >> 7) * 0xFFu);
+ }
+
+ /*! @brief Picks byte lanes from two words, the portable stand-in for SEL.
+  *
+  *  @return uint32_t - The lanes of a where the mask is set, of b elsewhere.
+  */
+
+ static uint32_t Select8(const uint32_t mask, const uint32_t a, const uint32_t b)
+ {
+   return (a & mask) | (b & ~mask);
+ }
+ #endif
+
+ /*! @brief Median filters 3 words of 4 packed bytes, lane by lane.
+  *
+  *  @param n1 is the first  of 3 words for which the median is sought.
+  *  @param n2 is the second of 3 words for which the median is sought.
+  *  @param n3 is the third  of 3 words for which the median is sought.
+  */
+
+ uint32_t Median_Filter3_Packed(const uint32_t n1, const uint32_t n2, const uint32_t n3)
+ {
+   //median = max(min(n1, n2), min(max(n1, n2), n3))
+ #if defined(__ARM_FEATURE_SIMD32)
+   uint32_t low, high, scratch, median;
+
+   //USUB8 sets a GE flag per lane where the first operand is not below the second, SEL picks by them
+   __asm__ ("usub8 %[scratch], %[n1], %[n2]\n\t"
+	    "sel %[low], %[n2], %[n1]\n\t"
+	    "sel %[high], %[n1], %[n2]\n\t"
+	    "usub8 %[scratch], %[high], %[n3]\n\t"
+	    "sel %[high], %[n3], %[high]\n\t"
+	    "usub8 %[scratch], %[low], %[high]\n\t"
+	    "sel %[median], %[low], %[high]"
+	    : [median] "=&r" (median), [low] "=&r" (low), [high] "=&r" (high), [scratch] "=&r" (scratch)
+	    : [n1] "r" (n1), [n2] "r" (n2), [n3] "r" (n3)
+	    : "cc");
+   return median;
+ #else
+   const uint32_t order = GreaterOrEqual8(n1, n2);
+   const uint32_t low = Select8(order, n2, n1);
+   uint32_t high = Select8(order, n1, n2);
+
+   high = Select8(GreaterOrEqual8(high, n3), n3, high);
+   return Select8(GreaterOrEqual8(low, high), low, high);
+ #endif
+ }
+ /*! @brief Median filters 3 signed 16-bit values.
+  *
+  *  @param n1 is the first  of 3 values for which the median is sought.
+  *  @param n2 is the second of 3 values for which the median is sought.
+  *  @param n3 is the third  of 3 values for which the median is sought.
+  */
+
+ int16_t Median_Filter3_16(const int16_t n1, const int16_t n2, const int16_t n3)
+ {
+   if(((n1 >= n2) && (n1 <= n3)) || ((n1 <= n2) && (n1 >= n3))){
+       return n1;
+   }
+   else if ((n2 >=n1 && n2<=n3) || (n2<=n1 && n2 >=n3))
+     {
+       return n2;
+     }
+   else {
+       return n3;
+   }
+ }
+ /*! @brief Finds a value in a sorted window.
+  *
+  *  @param sorted is the window, in ascending order.
+  *  @param nbSamples is the number of values in the window.
+  *  @param value is a value known to be in the window.
+  *  @return uint8_t - The index of the value.
+  */
+
+ static uint8_t Find(const int16_t* const sorted, const uint8_t nbSamples, const int16_t value)
+ {
+   uint8_t low = 0, high = nbSamples - 1, middle;
+
+   while (low < high)
+   {
+     middle = (low + high) / 2;
+     if (sorted[middle] < value)
+     {
+       low = middle + 1;
+     }
+     else
+     {
+       high = middle;
+     }
+   }
+   return low;
+ }
+
+ /*! @brief Sets up a streaming median filter with an empty window.
+  *
+  *  @param filter is the filter to set up.
+  *  @param nbTaps is the window length, an odd number from MEDIAN_MIN_TAPS to MEDIAN_MAX_TAPS.
+  *  @return bool - TRUE if the window length is valid.
+  */
+
+ bool Median_Init(TMedianFilter* const filter, const uint8_t nbTaps)
+ {
+   if ((nbTaps < MEDIAN_MIN_TAPS) || (nbTaps > MEDIAN_MAX_TAPS) || !(nbTaps & 1))
+   {
+     return false;
+   }
+
+   filter->nbTaps = nbTaps;
+   filter->nbSamples = 0;
+   filter->oldest = 0;
+   return true;
+ }
+
+ /*! @brief Adds a sample to the window and gets the median of each channel.
+  *
+  *  @param filter is the filter.
+  *  @param in is the new sample of each channel.
+  *  @param out is where the median of each channel is stored.
+  */
+
+ void Median_Update(TMedianFilter* const filter, const int16_t in[MEDIAN_NB_CHANNELS], int16_t out[MEDIAN_NB_CHANNELS])
+ {
+   const bool full = (filter->nbSamples == filter->nbTaps);
+   const uint8_t nbSamples = full ? filter->nbTaps : filter->nbSamples + 1;
+   uint8_t channel, i;
+
+   for (channel = 0; channel < MEDIAN_NB_CHANNELS; channel++)
+   {
+     int16_t* const sorted = filter->sorted[channel];
+     const int16_t value = in[channel];
+
+     if (full)
+     {
+       //The new value takes the slot of the oldest, then moves until the window is sorted again
+       i = Find(sorted, nbSamples, filter->ring[channel][filter->oldest]);
+     }
+     else
+     {
+       i = filter->nbSamples;
+     }
+
+     while ((i > 0) && (sorted[i - 1] > value))
+     {
+       sorted[i] = sorted[i - 1];
+       i--;
+     }
+     while ((i < nbSamples - 1) && (sorted[i + 1] < value))
+     {
+       sorted[i] = sorted[i + 1];
+       i++;
+     }
+     sorted[i] = value;
+
+     filter->ring[channel][filter->oldest] = value;
+     out[channel] = sorted[nbSamples / 2];
+   }
+
+   filter->nbSamples = nbSamples;
+   filter->oldest = (filter->oldest + 1 == filter->nbTaps) ? 0 : filter->oldest + 1;
+ }
  /*!
  ** @}
  */
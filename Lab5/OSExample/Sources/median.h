@@ -2,7 +2,9 @@
  *
  *  @brief Median filter.
  *
- *  This contains the functions for performing a median filter on byte-sized data.
+ *  This contains the functions for performing a median filter on byte-sized and 16-bit data,
+ *  on four byte lanes packed in a word, and a streaming median filter over a sliding window
+ *  of 3 to 31 samples.
  *
  *  @author PMcL
  *  @date 2015-10-12
@@ -18,6 +20,25 @@
 // New types
 #include "types.h"
 
+#define MEDIAN_MIN_TAPS 3
+#define MEDIAN_MAX_TAPS 31
+#define MEDIAN_NB_CHANNELS 3	/*!< X, Y and Z are filtered together. */
+
+/*!
+ * @brief The state of a streaming median filter.
+ *
+ * Each channel keeps its window twice: in arrival order in a ring, so the oldest sample is known
+ * without shifting, and sorted, so the median is always the middle element.
+ */
+typedef struct
+{
+  uint8_t nbTaps;					/*!< The window length, odd. */
+  uint8_t nbSamples;					/*!< Samples in the window, up to nbTaps. */
+  uint8_t oldest;					/*!< Ring index of the oldest sample. */
+  int16_t ring[MEDIAN_NB_CHANNELS][MEDIAN_MAX_TAPS];	/*!< The window of each channel in arrival order. */
+  int16_t sorted[MEDIAN_NB_CHANNELS][MEDIAN_MAX_TAPS];	/*!< The window of each channel in ascending order. */
+} TMedianFilter;
+
 /*! @brief Median filters 3 bytes.
  *
  *  @param n1 is the first  of 3 bytes for which the median is sought.
@@ -25,6 +46,44 @@
  *  @param n3 is the third  of 3 bytes for which the median is sought.
  */
 uint8_t Median_Filter3(const uint8_t n1, const uint8_t n2, const uint8_t n3);
+
+/*! @brief Median filters 3 words of 4 packed bytes, lane by lane.
+ *
+ *  Each byte lane of the result is Median_Filter3 of the same lane of the inputs, computed for
+ *  all four lanes at once without branches. Signed bytes can be filtered by flipping their sign
+ *  bits (XOR 0x80) on the way in and out.
+ *  @param n1 is the first  of 3 words for which the median is sought.
+ *  @param n2 is the second of 3 words for which the median is sought.
+ *  @param n3 is the third  of 3 words for which the median is sought.
+ */
+uint32_t Median_Filter3_Packed(const uint32_t n1, const uint32_t n2, const uint32_t n3);
+
+/*! @brief Median filters 3 signed 16-bit values.
+ *
+ *  @param n1 is the first  of 3 values for which the median is sought.
+ *  @param n2 is the second of 3 values for which the median is sought.
+ *  @param n3 is the third  of 3 values for which the median is sought.
+ */
+int16_t Median_Filter3_16(const int16_t n1, const int16_t n2, const int16_t n3);
+
+/*! @brief Sets up a streaming median filter with an empty window.
+ *
+ *  @param filter is the filter to set up.
+ *  @param nbTaps is the window length, an odd number from MEDIAN_MIN_TAPS to MEDIAN_MAX_TAPS.
+ *  @return bool - TRUE if the window length is valid.
+ */
+bool Median_Init(TMedianFilter* const filter, const uint8_t nbTaps);
+
+/*! @brief Adds a sample to the window and gets the median of each channel.
+ *
+ *  The oldest sample is replaced in the sorted window with a binary search and a single pass of
+ *  moves, O(N) per channel rather than a sort. Until the window is full the median of the samples
+ *  so far is given.
+ *  @param filter is the filter.
+ *  @param in is the new sample of each channel.
+ *  @param out is where the median of each channel is stored.
+ */
+void Median_Update(TMedianFilter* const filter, const int16_t in[MEDIAN_NB_CHANNELS], int16_t out[MEDIAN_NB_CHANNELS]);
 /*!
  * @}
 */
@@ -24,6 +24,12 @@
 #include "PE_Types.h"
 #include "Cpu.h"
 #include "accel.h"
+#include "I2C.h"
+#include "PIT.h"
+#include "filter.h"
+#include "decimate.h"
+#include "compress.h"
+#include "Profile.h"
 
 /****************************************GLOBAL VARS*****************************************************/
 
@@ -35,11 +41,24 @@ const uint8_t PACKET_ACK_MASK = 0x80u; //Used to mask out the Acknowledgment bit
 
 uint16union_t volatile *TowerNumber;
 uint16union_t volatile *TowerMode;
+uint8_t volatile *AccelFilter;
+
+static bool SendTimestamps = false; //Sample timestamps are off until the PC asks for them
+static bool StreamLoad = false; //The load is only sent when the PC asks for it
+static OS_ECB *LoadSemaphore; //Guards the load snapshot, sent from both the packet and RTC threads
+static OS_LOAD Loads[OS_LOWEST_PRIORITY + 2]; //Every priority, then the ISRs; too big for a thread stack
+static bool LoadsRan[OS_LOWEST_PRIORITY + 2];
+static uint8_t BlockLength = 0; //Samples go out uncompressed until the PC asks for blocks
 
 /****************************************PRIVATE FUNCTION DECLARATION***********************************/
 
 bool PacketTest(void);
 bool DataToFlash(void);
+void PutI2CErrors(void);
+void PutProfile(void);
+void PutStacks(void);
+void PutLoadReport(void);
+bool Decode(const uint8_t uartData);
 
 /****************************************PRIVATE FUNCTION DEFINITION***************************************/
 
@@ -61,7 +80,8 @@ bool DataToFlash(void)
 {
   bool numberAlloc = Flash_AllocateVar((volatile void **) &TowerNumber, sizeof(uint16union_t));
   bool modeAlloc = Flash_AllocateVar((volatile void **) &TowerMode, sizeof(uint16union_t));
-  if(numberAlloc && modeAlloc)
+  bool filterAlloc = Flash_AllocateVar((volatile void **) &AccelFilter, sizeof(uint8_t));
+  if(numberAlloc && modeAlloc && filterAlloc)
   {
     if(TowerNumber->l == 0xFFFF) //If un-programmed
     {
@@ -71,36 +91,123 @@ bool DataToFlash(void)
     {
       Flash_Write16((uint16_t volatile *) TowerMode, 0x1);
     }
+    if(*AccelFilter == 0xFF)	//If un-programmed
+    {
+      Flash_Write8(AccelFilter, FILTER_SET_NONE);
+    }
     return true;
   }
   return false;
 }
 
-/****************************************PUBLIC FUNCTION DEFINITION***************************************/
+/*! @brief Sends the I2C error counters
+ */
+void PutI2CErrors(void)
+{
+  const TI2CErrors* errors = I2C_GetErrors();
+  const uint32_t counters[] = { errors->nacks, errors->arbitrationLosses, errors->timeouts,
+      errors->busRecoveries, errors->dmaErrors };
+  uint16union_t value;
+  uint8_t i;
 
-/*! @brief Initializes the packets by calling the initialization routines of the supporting software modules.
- *
- *  @param baudRate The desired baud rate in bits/sec.
- *  @param moduleClk The module clock rate in Hz
- *  @return bool - TRUE if the packet module was successfully initialized.
+  for (i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+  {
+    value.l = (counters[i] > 0xFFFF) ? 0xFFFF : counters[i];
+    Packet_Put(I2C_ERRORS_COMM, i, value.s.Lo, value.s.Hi);
+  }
+}
+
+/*! @brief Sends the profile of every site that has run
  */
-bool Packet_Init(const uint32_t baudRate, const uint32_t moduleClk)
+void PutProfile(void)
 {
-  PacketPutSemaphore = OS_SemaphoreCreate(1); //Create Packet Semaphore
+  TProfileStats stats;
+  uint32_t values[4];
+  uint8_t site, i;
 
-  return (UART_Init(baudRate, moduleClk) && DataToFlash());
+  for (site = 0; site < PROFILE_NB_SITES; site++)
+  {
+    if (!Profile_Get((TProfileSite) site, &stats) || !stats.count)
+    {
+      continue;
+    }
+    values[0] = stats.count;
+    values[1] = stats.min;
+    values[2] = stats.max;
+    values[3] = (uint32_t) (stats.total / stats.count);
+
+    Packet_Put(PROFILE_COMM, site, 0, 0);
+    for (i = 0; i < 4; i++)
+    {
+      if (values[i] > 0xFFFFFFu)
+      {
+	values[i] = 0xFFFFFFu;
+      }
+      Packet_Put(PROFILE_DATA_COMM, (uint8_t) values[i], (uint8_t) (values[i] >> 8), (uint8_t) (values[i] >> 16));
+    }
+  }
 }
 
-/*! @brief Attempts to get a packet from the received data.
- *
- *  @return bool - TRUE if a valid packet was received.
+/*! @brief Sends the stack usage of every thread with a tracked stack
  */
-bool Packet_Get(void) {
-  //EnterCritical();
-  uint8_t uartData;
+void PutStacks(void)
+{
+  OS_STACK_INFO info;
+  uint8_t priority;
 
-  //Checks whether there is data in the RxFIFO and stores it the address pointed by uartData
-  UART_InChar(&uartData);
+  for (priority = 0; priority <= OS_LOWEST_PRIORITY; priority++)
+  {
+    if (OS_StackInfo(priority, &info) && info.size)
+    {
+      Packet_Put(STACK_COMM, priority | (info.overflowed ? STACK_OVERFLOW_FLAG : 0),
+		 (info.used > 0xFF) ? 0xFF : info.used, (info.size > 0xFF) ? 0xFF : info.size);
+    }
+  }
+}
+
+/*! @brief Sends the share of processor time and the switch count of every thread that has run and of the ISRs
+ */
+void PutLoadReport(void)
+{
+  uint64_t total = 0;
+  uint32_t count;
+  uint16union_t share;
+  uint8_t i;
+
+  OS_SemaphoreWait(LoadSemaphore, 0);
+
+  //Snapshot first, so the shares add up whatever runs while they are sent
+  for (i = 0; i <= OS_LOWEST_PRIORITY; i++)
+  {
+    LoadsRan[i] = OS_LoadThread(i, &Loads[i]);
+    total += LoadsRan[i] ? Loads[i].cycles : 0;
+  }
+  OS_LoadISR(&Loads[i]);
+  LoadsRan[i] = true;
+  total += Loads[i].cycles;
+
+  for (i = 0; i <= OS_LOWEST_PRIORITY + 1; i++)
+  {
+    if (!LoadsRan[i])
+    {
+      continue;
+    }
+    share.l = total ? (uint16_t) ((Loads[i].cycles * 1000u) / total) : 0;
+    count = (Loads[i].count > 0xFFFFFFu) ? 0xFFFFFFu : Loads[i].count;
+    Packet_Put(LOAD_COMM, (i <= OS_LOWEST_PRIORITY) ? i : LOAD_ISR, share.s.Lo, share.s.Hi);
+    Packet_Put(LOAD_DATA_COMM, (uint8_t) count, (uint8_t) (count >> 8), (uint8_t) (count >> 16));
+  }
+
+  OS_SemaphoreSignal(LoadSemaphore);
+}
+
+/*! @brief Adds a received byte to the packet being built.
+ *
+ *  @param uartData is the byte.
+ *  @return bool - TRUE if the byte completed a valid packet.
+ */
+bool Decode(const uint8_t uartData)
+{
   switch (packet_position)
   {
     //Command byte
@@ -123,7 +230,6 @@ bool Packet_Get(void) {
     case 2:
       Packet_Parameter2 = uartData;
       packet_position++;
-      ExitCritical();
       return false; //Return false, incomplete packet
       break;
 
@@ -166,6 +272,40 @@ bool Packet_Get(void) {
   return false;
 }
 
+/****************************************PUBLIC FUNCTION DEFINITION***************************************/
+
+/*! @brief Initializes the packets by calling the initialization routines of the supporting software modules.
+ *
+ *  @param baudRate The desired baud rate in bits/sec.
+ *  @param moduleClk The module clock rate in Hz
+ *  @return bool - TRUE if the packet module was successfully initialized.
+ */
+bool Packet_Init(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  PacketPutSemaphore = OS_SemaphoreCreate(1); //Create Packet Semaphore
+  LoadSemaphore = OS_SemaphoreCreate(1);
+
+  return (UART_Init(baudRate, moduleClk) && DataToFlash());
+}
+
+/*! @brief Attempts to get a packet from the received data.
+ *
+ *  @return bool - TRUE if a valid packet was received.
+ */
+bool Packet_Get(void)
+{
+  uint8_t uartData;
+  bool complete;
+
+  //Checks whether there is data in the RxFIFO and stores it the address pointed by uartData
+  UART_InChar(&uartData);
+
+  PROFILE_BEGIN(PROFILE_PACKET_GET);
+  complete = Decode(uartData);
+  PROFILE_END(PROFILE_PACKET_GET);
+  return complete;
+}
+
 /*! @brief Builds a packet and places it in the transmit FIFO buffer.
  *
  *  @return bool - TRUE if a valid packet was sent.
@@ -183,6 +323,98 @@ void Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t p
   OS_SemaphoreSignal(PacketPutSemaphore); //Signal Packet Put Semaphore
 }
 
+/*! @brief Packs 14-bit samples 42 bits per sample and places them in the transmit FIFO buffer.
+ *
+ *  Four samples fill seven packets exactly, 1.75 packets per sample instead of the 2 needed to send
+ *  each axis as 16 bits.
+ *  @param samples are PACKED_NB_SAMPLES samples of X, Y and Z, each in 14-bit counts.
+ */
+void Packet_PutPacked(const int16_t samples[PACKED_NB_SAMPLES][3])
+{
+  uint8_t stream[PACKED_NB_PACKETS * 3];
+  uint32_t bits = 0;	//Bits waiting to be output, the newest in the least significant bits
+  uint8_t nbBits = 0, nbBytes = 0;
+  uint8_t i, axis;
+
+  for (i = 0; i < PACKED_NB_SAMPLES; i++)
+  {
+    for (axis = 0; axis < 3; axis++)
+    {
+      bits = (bits << 14) | ((uint16_t) samples[i][axis] & 0x3FFFu);
+      nbBits += 14;
+      while (nbBits >= 8)
+      {
+	nbBits -= 8;
+	stream[nbBytes++] = (uint8_t) (bits >> nbBits);
+      }
+    }
+  }
+
+  for (i = 0; i < PACKED_NB_PACKETS; i++)
+  {
+    Packet_Put(ACCEL_PACKED_COMM + i, stream[3 * i], stream[3 * i + 1], stream[3 * i + 2]);
+  }
+}
+
+/*! @brief Compresses a block of samples and places it in the transmit FIFO buffer.
+ *
+ *  @param samples are the samples, oldest first, each in 14-bit counts.
+ *  @param nbSamples is the number of samples, from 1 to COMPRESS_MAX_SAMPLES.
+ *  @param resolution is the resolution the samples were read at.
+ */
+void Packet_PutBlock(const int16_t samples[][3], const uint8_t nbSamples, const TAccelResolution resolution)
+{
+  static uint8_t block[COMPRESS_MAX_BYTES + 2]; //Too big for the thread stacks
+  //At 8-bit resolution the 6 least significant bits are always 0
+  const uint8_t nbBytes = Compress_Block(samples, nbSamples, (resolution == ACCEL_RESOLUTION_8_BIT) ? 6 : 0, block);
+  const uint8_t nbPackets = (nbBytes + 2) / 3;
+  uint8_t i;
+
+  block[nbBytes] = 0;
+  block[nbBytes + 1] = 0;
+  Packet_Put(ACCEL_BLOCK_COMM, nbSamples, nbPackets, resolution);
+  for (i = 0; i < nbPackets; i++)
+  {
+    Packet_Put(ACCEL_BLOCK_DATA_COMM, block[3 * i], block[3 * i + 1], block[3 * i + 2]);
+  }
+}
+
+/*! @brief Gets the number of samples per compressed block.
+ *
+ *  @return uint8_t - The samples per block, or 0 if samples are sent uncompressed.
+ */
+uint8_t Packet_GetBlockLength(void)
+{
+  return BlockLength;
+}
+
+/*! @brief Places a sample timestamp in the transmit FIFO buffer, if timestamps are on.
+ *
+ *  @param delta is the time since the previous sample sent, in microseconds.
+ */
+void Packet_PutTimestamp(const uint32_t delta)
+{
+  const uint32_t saturated = (delta > 0xFFFFFFu) ? 0xFFFFFFu : delta;
+
+  if (SendTimestamps)
+  {
+    Packet_Put(ACCEL_TIMESTAMP_COMM, (uint8_t) saturated, (uint8_t) (saturated >> 8), (uint8_t) (saturated >> 16));
+  }
+}
+
+/*! @brief Places the processor load in the transmit FIFO buffer and clears it, if the load is streaming.
+ *
+ *  @note Call once a second.
+ */
+void Packet_PutLoad(void)
+{
+  if (StreamLoad)
+  {
+    PutLoadReport();
+    OS_LoadClear();
+  }
+}
+
 /*! @brief Handles the stored packet
  *
  *  @return void
@@ -270,6 +502,9 @@ void Packet_Handle(void)
       RTC_Set(Packet_Parameter1, Packet_Parameter2, Packet_Parameter3);
       error = false;
       break;
+    case SET_DATE:
+      error = !RTC_SetDate(RTC_EPOCH_YEAR + Packet_Parameter3, Packet_Parameter2, Packet_Parameter1);
+      break;
     case 0x0a:
       if (Packet_Parameter1 == 2)
       {
@@ -285,6 +520,16 @@ void Packet_Handle(void)
 	  Accel_SetMode(ACCEL_INT);
 	  error = false;
 	}
+	else if(Packet_Parameter2 == 2)
+	{
+	  Accel_SetMode(ACCEL_FIFO);
+	  error = false;
+	}
+	else if(Packet_Parameter2 == 3)
+	{
+	  Accel_SetMode(ACCEL_EVENT);
+	  error = false;
+	}
       }
       else if(Packet_Parameter1 == 1)
       {
@@ -298,7 +543,154 @@ void Packet_Handle(void)
 	  Packet_Put(0x0A, 0x0,  0, 0x0);
 	  error = false;
 	}
+	else if(Accel_GetMode() == ACCEL_FIFO)
+	{
+	  Packet_Put(0x0A, 0x0,  2, 0x0);
+	  error = false;
+	}
+	else if(Accel_GetMode() == ACCEL_EVENT)
+	{
+	  Packet_Put(0x0A, 0x0,  3, 0x0);
+	  error = false;
+	}
+      }
+      break;
+    case ACCEL_RATE:
+      if (Packet_Parameter1 == ACCEL_RATE_GET)
+      {
+	uint16union_t achieved;
+	achieved.l = Accel_GetAchievedRate();
+	Packet_Put(ACCEL_RATE_COMM, Accel_GetDataRate(), achieved.s.Lo, achieved.s.Hi);
+
+	uint16union_t max, mean;
+	Accel_GetJitter(&max.l, &mean.l);
+	Packet_Put(ACCEL_JITTER_COMM, 0, max.s.Lo, max.s.Hi);
+	Packet_Put(ACCEL_JITTER_COMM, 1, mean.s.Lo, mean.s.Hi);
+
+	uint16union_t dropped;
+	dropped.l = Accel_GetDroppedRate();
+	Packet_Put(ACCEL_DROPPED_COMM, 0, dropped.s.Lo, dropped.s.Hi);
+	error = false;
+      }
+      else if (Packet_Parameter1 == ACCEL_RATE_SET)
+      {
+	error = !Accel_SetDataRate((TOutputDataRate) Packet_Parameter2);
+	if (!error)
+	{
+	  PIT_Set(PIT_SAMPLE_CHANNEL, Accel_GetSamplePeriod(), true); //Poll at the new rate
+	}
       }
+      break;
+    case ACCEL_RESOLUTION:
+      if (Packet_Parameter1 == ACCEL_RESOLUTION_GET)
+      {
+	Packet_Put(ACCEL_RESOLUTION_COMM, Accel_GetResolution(), 0x0, 0x0);
+	error = false;
+      }
+      else if (Packet_Parameter1 == ACCEL_RESOLUTION_SET)
+      {
+	error = !Accel_SetResolution((TAccelResolution) Packet_Parameter2);
+      }
+      break;
+    case ACCEL_EVENT_SETUP:
+      error = !Accel_SetEventDetection((TAccelEvent) Packet_Parameter1, Packet_Parameter2, Packet_Parameter3);
+      break;
+    case ACCEL_AUTO_SLEEP:
+      error = (Packet_Parameter1 > 1) ||
+	  !Accel_SetAutoSleep(Packet_Parameter1, (TSLEEPModeRate) Packet_Parameter2, Packet_Parameter3);
+      if (!error)
+      {
+	PIT_Set(PIT_SAMPLE_CHANNEL, Accel_GetSamplePeriod(), true); //The sensor is awake again
+      }
+      break;
+    case ACCEL_TIMESTAMPS:
+      if (Packet_Parameter1 <= 1)
+      {
+	SendTimestamps = Packet_Parameter1;
+	error = false;
+      }
+      break;
+    case ACCEL_FILTER:
+      if (Packet_Parameter1 == ACCEL_FILTER_GET)
+      {
+	Packet_Put(ACCEL_FILTER_COMM, *AccelFilter, 0x0, 0x0);
+	error = false;
+      }
+      else if ((Packet_Parameter1 == ACCEL_FILTER_SET) && (Packet_Parameter2 < FILTER_NB_SETS))
+      {
+	//The accel pipeline picks the new set up from flash with its next sample
+	error = !Flash_Write8(AccelFilter, Packet_Parameter2);
+      }
+      break;
+    case ACCEL_DECIMATION:
+      if (Packet_Parameter1 == ACCEL_DECIMATION_GET)
+      {
+	Packet_Put(ACCEL_DECIMATION_COMM, Decimate_GetFactor(), Decimate_IsAutomatic(), 0x0);
+	error = false;
+      }
+      else if ((Packet_Parameter1 == ACCEL_DECIMATION_SET) && (Packet_Parameter3 <= 1))
+      {
+	error = !Decimate_Set(Packet_Parameter2, Packet_Parameter3);
+      }
+      break;
+    case ACCEL_COMPRESSION:
+      if (Packet_Parameter1 == ACCEL_COMPRESSION_GET)
+      {
+	Packet_Put(ACCEL_COMPRESSION_COMM, BlockLength, 0x0, 0x0);
+	error = false;
+      }
+      else if ((Packet_Parameter1 == ACCEL_COMPRESSION_SET) && (Packet_Parameter2 <= COMPRESS_MAX_SAMPLES))
+      {
+	BlockLength = Packet_Parameter2;
+	error = false;
+      }
+      break;
+    case I2C_ERRORS:
+      if (Packet_Parameter1 == I2C_ERRORS_GET)
+      {
+	PutI2CErrors();
+	error = false;
+      }
+      else if (Packet_Parameter1 == I2C_ERRORS_CLEAR)
+      {
+	I2C_ClearErrors();
+	error = false;
+      }
+      break;
+    case PROFILE:
+      if (Packet_Parameter1 == PROFILE_GET)
+      {
+	PutProfile();
+	error = false;
+      }
+      else if (Packet_Parameter1 == PROFILE_CLEAR)
+      {
+	Profile_Clear();
+	error = false;
+      }
+      break;
+    case STACK:
+      PutStacks();
+      error = false;
+      break;
+    case LOAD:
+      if (Packet_Parameter1 == LOAD_GET)
+      {
+	PutLoadReport();
+	error = false;
+      }
+      else if (Packet_Parameter1 == LOAD_CLEAR)
+      {
+	OS_LoadClear();
+	error = false;
+      }
+      else if ((Packet_Parameter1 == LOAD_STREAM) && (Packet_Parameter2 <= 1))
+      {
+	StreamLoad = Packet_Parameter2;
+	OS_LoadClear();
+	error = false;
+      }
+      break;
 
     default:
       break;
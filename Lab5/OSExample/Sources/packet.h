@@ -18,6 +18,7 @@
 // New types
 #include "types.h"
 #include "OS.h"
+#include "accel.h"
 
 OS_ECB *PacketPutSemaphore; //Semaphore for Packet Put
 
@@ -86,6 +87,9 @@ typedef union
 
 #define SET_TIME 0x0C
 
+//Set the date: Parameter 1 is the day, Parameter 2 the month, Parameter 3 the years since 2000
+#define SET_DATE 0x0E
+
 //Get or set the tower number
 #define TOWER_NUMBER 0x0B
 
@@ -95,6 +99,97 @@ typedef union
 //Packet Parameter 1 for setting the tower number
 #define TOWER_NUMBER_SET 2
 
+//Get or clear the I2C error counters
+#define I2C_ERRORS 0x20
+
+//Packet Parameter 1 for getting the I2C error counters
+#define I2C_ERRORS_GET 1
+
+//Packet Parameter 1 for clearing the I2C error counters
+#define I2C_ERRORS_CLEAR 2
+
+//Get or set the accelerometer output data rate
+#define ACCEL_RATE 0x21
+
+//Packet Parameter 1 for getting the requested rate code, the achieved sample rate, the jitter and the dropped samples
+#define ACCEL_RATE_GET 1
+
+//Packet Parameter 1 for setting the rate, Parameter 2 is the rate code (0 = 800 Hz ... 7 = 1.56 Hz)
+#define ACCEL_RATE_SET 2
+
+//Get or set the accelerometer resolution
+#define ACCEL_RESOLUTION 0x22
+
+//Packet Parameter 1 for getting the resolution
+#define ACCEL_RESOLUTION_GET 1
+
+//Packet Parameter 1 for setting the resolution, Parameter 2 is 0 for 8-bit or 1 for 14-bit
+#define ACCEL_RESOLUTION_SET 2
+
+//Set up an event engine: Parameter 1 is 0 for motion or 1 for transient,
+//Parameter 2 the threshold in 0.063 g counts (0 disables), Parameter 3 the debounce count in samples
+#define ACCEL_EVENT_SETUP 0x24
+
+//Set up the accelerometer auto-sleep: Parameter 1 is 1 to enable, Parameter 2 the sleep rate
+//(0 = 50 Hz ... 3 = 1.56 Hz), Parameter 3 the inactivity before sleeping in 320 ms counts
+#define ACCEL_AUTO_SLEEP 0x25
+
+//Turn the sample timestamps on (Parameter 1 = 1) or off (0)
+#define ACCEL_TIMESTAMPS 0x26
+
+//Get or set the filter run on the accelerometer data after the median filter, kept in flash
+#define ACCEL_FILTER 0x28
+
+//Packet Parameter 1 for getting the filter coefficient set
+#define ACCEL_FILTER_GET 1
+
+//Packet Parameter 1 for setting the filter, Parameter 2 is the coefficient set (0 = none ... 5, see filter.h)
+#define ACCEL_FILTER_SET 2
+
+//Get or set the decimation of the accelerometer data before it is sent
+#define ACCEL_DECIMATION 0x29
+
+//Packet Parameter 1 for getting the decimation factor in use and whether it is automatic
+#define ACCEL_DECIMATION_GET 1
+
+//Packet Parameter 1 for setting the decimation, Parameter 2 is the factor (1 ... 16, the smallest when automatic),
+//Parameter 3 is 1 for the factor to follow the transmit queue headroom or 0 for a fixed factor
+#define ACCEL_DECIMATION_SET 2
+
+//Get or set the delta compression of the samples sent, Parameter 2 is the samples per block for
+//Packet Parameter 1 = 2 (0 = off, 1 ... 16)
+#define ACCEL_COMPRESSION 0x2A
+
+//Packet Parameter 1 for getting the samples per compressed block
+#define ACCEL_COMPRESSION_GET 1
+
+//Packet Parameter 1 for setting the samples per compressed block
+#define ACCEL_COMPRESSION_SET 2
+
+//Get or clear the execution time profile, when the firmware is built with PROFILE_ENABLED
+#define PROFILE 0x2B
+
+//Packet Parameter 1 for getting the profile
+#define PROFILE_GET 1
+
+//Packet Parameter 1 for clearing the profile
+#define PROFILE_CLEAR 2
+
+//Get the stack usage of every thread
+#define STACK 0x2C
+
+//Get, clear or stream the processor load of the threads and ISRs
+#define LOAD 0x2D
+
+//Packet Parameter 1 for getting the load since it was last cleared
+#define LOAD_GET 1
+
+//Packet Parameter 1 for clearing the load
+#define LOAD_CLEAR 2
+
+//Packet Parameter 1 for streaming the load, Parameter 2 is 1 to send and clear it every second or 0 to stop
+#define LOAD_STREAM 3
+
 //Least significant byte of Student ID
 #define S_ID 0x13A8
 
@@ -125,6 +220,84 @@ typedef union
 
 #define TOWER_READ_BYTE_COMM 0x08
 
+//The date: day, month, years since 2000; sent when it changes, so at startup, at midnight and when it is set
+#define RTC_DATE_COMM 0x0E
+
+//One packet per I2C error counter: index, counter Lo, counter Hi (saturated at 0xFFFF)
+#define I2C_ERRORS_COMM 0x20
+
+//Requested rate code, then the samples handed to the pipeline in the last second (Lo, Hi)
+#define ACCEL_RATE_COMM 0x21
+
+//Resolution, 0 for 8-bit or 1 for 14-bit
+#define ACCEL_RESOLUTION_COMM 0x22
+
+//An event was detected: INT_SOURCE, FF_MT_SRC, TRANSIENT_SRC; the samples around it follow as 0x10 or packed packets
+#define ACCEL_EVENT_COMM 0x23
+
+//The accelerometer fell asleep (1) or woke up (0)
+#define ACCEL_SLEEP_COMM 0x25
+
+//Microseconds since the previous sample sent, 24 bits (Lo, Mid, Hi) saturated at 0xFFFFFF; precedes the sample
+#define ACCEL_TIMESTAMP_COMM 0x26
+
+//Sample spacing error during the last second: index (0 = largest, 1 = mean), microseconds Lo, Hi
+#define ACCEL_JITTER_COMM 0x27
+
+//0, then the samples read but dropped during the last second because the pipeline was too far behind (Lo, Hi)
+#define ACCEL_DROPPED_COMM 0x2E
+
+//The filter coefficient set in use
+#define ACCEL_FILTER_COMM 0x28
+
+//The decimation factor in use, then 1 if it is automatic
+#define ACCEL_DECIMATION_COMM 0x29
+
+//The samples per compressed block, 0 when compression is off
+#define ACCEL_COMPRESSION_COMM 0x2A
+
+/*
+ * The profile is sent a site at a time, for the sites that have run, in the order of TProfileSite.
+ * PROFILE_COMM gives the site, then four PROFILE_DATA_COMM packets give its run count and its
+ * minimum, maximum and mean run time in core clock cycles, each 24 bits (Lo, Mid, Hi) saturated at 0xFFFFFF.
+ */
+#define PROFILE_COMM 0x2B
+#define PROFILE_DATA_COMM 0x3A
+
+//Stack usage of a thread with a tracked stack: priority (bit 7 set if the stack has overflowed),
+//most words used and words in the stack, both saturated at 0xFF
+#define STACK_COMM 0x2C
+#define STACK_OVERFLOW_FLAG 0x80
+
+/*
+ * The load is sent for each thread that has run, idle last, then for the ISRs. LOAD_COMM gives the
+ * priority (LOAD_ISR for the ISRs) and the share of processor time in 0.1 % (Lo, Hi); LOAD_DATA_COMM
+ * follows with the times the thread was switched to, or the interrupts, 24 bits (Lo, Mid, Hi)
+ * saturated at 0xFFFFFF.
+ */
+#define LOAD_COMM 0x2D
+#define LOAD_DATA_COMM 0x3B
+#define LOAD_ISR 0xFF
+
+/*
+ * With compression on, samples are sent in blocks coded as described in compress.h.
+ * ACCEL_BLOCK_COMM starts a block: samples in the block, ACCEL_BLOCK_DATA_COMM packets that follow,
+ * resolution (0 for 8-bit counts, 1 for 14-bit). The data packets carry the coded block 3 bytes at a time,
+ * the last padded with 0. The timestamp before a block is the time from the first sample of the previous
+ * block to the first sample of this one; the samples of a block are evenly spaced.
+ */
+#define ACCEL_BLOCK_COMM 0x38
+#define ACCEL_BLOCK_DATA_COMM 0x39
+
+/*
+ * 14-bit samples are sent PACKED_NB_SAMPLES at a time as a 168-bit stream, X, Y then Z of each sample,
+ * 14 bits per axis in two's complement, most significant bit first.
+ * The stream is split over PACKED_NB_PACKETS packets whose commands are ACCEL_PACKED_COMM + the packet index.
+ */
+#define ACCEL_PACKED_COMM 0x30
+#define PACKED_NB_SAMPLES 4
+#define PACKED_NB_PACKETS 7
+
 extern TPacket Packet;
 
 // Acknowledgment bit mask
@@ -133,6 +306,9 @@ extern const uint8_t PACKET_ACK_MASK;
 //extern uint8_t towerNumberLsb, towerNumberMsb;
 extern uint16union_t volatile *TowerNumber, *TowerMode;
 
+//The filter coefficient set chosen by the PC
+extern uint8_t volatile *AccelFilter;
+
 /*************************************************PUBLIC FUNCTION DECLARATION*************************************************/
 
 /*! @brief Initializes the packets by calling the initialization routines of the supporting software modules.
@@ -154,6 +330,38 @@ bool Packet_Get(void);
  */
 void Packet_Put(const uint8_t command, const uint8_t parameter1, const uint8_t parameter2, const uint8_t parameter3);
 
+/*! @brief Packs 14-bit samples 42 bits per sample and places them in the transmit FIFO buffer.
+ *
+ *  @param samples are PACKED_NB_SAMPLES samples of X, Y and Z, each in 14-bit counts.
+ */
+void Packet_PutPacked(const int16_t samples[PACKED_NB_SAMPLES][3]);
+
+/*! @brief Compresses a block of samples and places it in the transmit FIFO buffer.
+ *
+ *  @param samples are the samples, oldest first, each in 14-bit counts.
+ *  @param nbSamples is the number of samples, from 1 to COMPRESS_MAX_SAMPLES.
+ *  @param resolution is the resolution the samples were read at.
+ */
+void Packet_PutBlock(const int16_t samples[][3], const uint8_t nbSamples, const TAccelResolution resolution);
+
+/*! @brief Gets the number of samples per compressed block.
+ *
+ *  @return uint8_t - The samples per block, or 0 if samples are sent uncompressed.
+ */
+uint8_t Packet_GetBlockLength(void);
+
+/*! @brief Places a sample timestamp in the transmit FIFO buffer, if timestamps are on.
+ *
+ *  @param delta is the time since the previous sample sent, in microseconds.
+ */
+void Packet_PutTimestamp(const uint32_t delta);
+
+/*! @brief Places the processor load in the transmit FIFO buffer and clears it, if the load is streaming.
+ *
+ *  @note Call once a second.
+ */
+void Packet_PutLoad(void);
+
 /*! @brief Handles a packet once it has been validated by Packet_Get
  *
  *  @return void
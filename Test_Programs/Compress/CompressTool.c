@@ -0,0 +1,348 @@
+/*! @file
+ *
+ *  @brief Decoder for the compressed accelerometer blocks of Lab5, and a check of the encoder.
+ *
+ *  With a file argument, decodes the blocks in a capture of the bytes the tower sent and prints
+ *  one sample per line. Other packets in the capture are skipped.
+ *
+ *  Without arguments, runs synthetic accelerometer data through compress.c, frames it as
+ *  Packet_PutBlock does, decodes it with the decoder here, which only follows the format
+ *  described in compress.h and packet.h, and checks that every sample comes back bit for bit.
+ *  It then compares the bytes on the wire per sample with the uncompressed formats.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "compress.h"
+
+// From packet.h, which cannot be included on the host
+#define PACKET_NB_BYTES 5
+#define ACCEL_BLOCK_COMM 0x38
+#define ACCEL_BLOCK_DATA_COMM 0x39
+#define RESOLUTION_8_BIT 0
+#define RESOLUTION_14_BIT 1
+
+#define NB_SAMPLES 6000u       /*!< One minute at 100 Hz */
+#define WIRE_8_BIT 5.0         /*!< Bytes per sample for a 0x10 packet */
+#define WIRE_14_BIT 8.75       /*!< Bytes per sample packed 4 samples to 7 packets */
+
+/*!
+ * @brief The decoder, fed one packet at a time.
+ */
+typedef struct
+{
+  uint8_t nbSamples;                  /*!< Samples in the block being received */
+  uint8_t resolution;
+  uint8_t nbPackets;                  /*!< Data packets still to come */
+  uint8_t nbBytes;
+  uint8_t bytes[COMPRESS_MAX_BYTES + 2];
+} TDecoder;
+
+static int16_t Samples[NB_SAMPLES][COMPRESS_NB_CHANNELS];
+static int16_t Decoded[NB_SAMPLES][COMPRESS_NB_CHANNELS];
+static unsigned NbDecoded;
+static unsigned WireBytes;
+
+/*! @brief Decodes a complete block into Decoded.
+ *
+ *  @return bool - TRUE if the block held exactly the samples announced.
+ */
+static bool DecodeBlock(const TDecoder* const decoder)
+{
+  int32_t previous[COMPRESS_NB_CHANNELS] = { 0 }, slope[COMPRESS_NB_CHANNELS] = { 0 }, value;
+  const unsigned shift = (decoder->resolution == RESOLUTION_8_BIT) ? 6 : 0;
+  unsigned nibble = 1, i, channel, bits;
+  const unsigned order = decoder->bytes[0] >> 4;
+  uint32_t code;
+  uint8_t n;
+
+  if ((order != 1) && (order != 2))
+  {
+    return false;
+  }
+
+  for (i = 0; i < decoder->nbSamples; i++)
+  {
+    for (channel = 0; channel < COMPRESS_NB_CHANNELS; channel++)
+    {
+      code = 0;
+      bits = 0;
+      do
+      {
+        if ((nibble / 2 >= decoder->nbBytes) || (bits > 3 * (COMPRESS_MAX_NIBBLES - 1)))
+        {
+          return false;
+        }
+        n = (nibble & 1) ? (decoder->bytes[nibble / 2] & 0xF) : (decoder->bytes[nibble / 2] >> 4);
+        code |= (uint32_t) (n & 0x7) << bits;
+        bits += 3;
+        nibble++;
+      } while (n & 0x8);
+
+      // Undo the zigzag, then add the prediction: the previous sample, plus its slope for order 2
+      value = ((int32_t) (code >> 1) ^ -(int32_t) (code & 1)) + previous[channel] + ((order == 2) ? slope[channel] : 0);
+      if (i > 0)
+      {
+        slope[channel] = value - previous[channel];
+      }
+      previous[channel] = value;
+      if (NbDecoded < NB_SAMPLES)
+      {
+        Decoded[NbDecoded][channel] = (int16_t) (value * (1 << shift));
+      }
+    }
+    NbDecoded++;
+  }
+  // At most the padding of the last packet is left over
+  return (nibble + 1) / 2 + 3 > decoder->nbBytes;
+}
+
+/*! @brief Feeds a packet to the decoder.
+ *
+ *  @return bool - TRUE unless the packet broke the format.
+ */
+static bool Decode(TDecoder* const decoder, const uint8_t packet[PACKET_NB_BYTES])
+{
+  if ((packet[0] ^ packet[1] ^ packet[2] ^ packet[3]) != packet[4])
+  {
+    return false;
+  }
+
+  switch (packet[0])
+  {
+    case ACCEL_BLOCK_COMM:
+      decoder->nbSamples = packet[1];
+      decoder->nbPackets = packet[2];
+      decoder->resolution = packet[3];
+      decoder->nbBytes = 0;
+      return (packet[1] >= 1) && (packet[1] <= COMPRESS_MAX_SAMPLES) && (packet[2] * 3 <= COMPRESS_MAX_BYTES + 2);
+
+    case ACCEL_BLOCK_DATA_COMM:
+      if (!decoder->nbPackets)
+      {
+        return false;
+      }
+      memcpy(&decoder->bytes[decoder->nbBytes], &packet[1], 3);
+      decoder->nbBytes += 3;
+      return (--decoder->nbPackets > 0) || DecodeBlock(decoder);
+
+    default:
+      return true;
+  }
+}
+
+/*! @brief Frames a block as Packet_PutBlock does and passes it to the decoder.
+ *
+ *  @return bool - TRUE if the decoder accepted every packet.
+ */
+static bool Send(TDecoder* const decoder, const int16_t samples[][COMPRESS_NB_CHANNELS], const uint8_t nbSamples,
+    const uint8_t resolution)
+{
+  uint8_t block[COMPRESS_MAX_BYTES + 2] = { 0 };
+  const uint8_t nbBytes = Compress_Block(samples, nbSamples, (resolution == RESOLUTION_8_BIT) ? 6 : 0, block);
+  const uint8_t nbPackets = (nbBytes + 2) / 3;
+  uint8_t packet[PACKET_NB_BYTES], i;
+  bool ok;
+
+  packet[0] = ACCEL_BLOCK_COMM;
+  packet[1] = nbSamples;
+  packet[2] = nbPackets;
+  packet[3] = resolution;
+  packet[4] = packet[0] ^ packet[1] ^ packet[2] ^ packet[3];
+  ok = Decode(decoder, packet);
+
+  for (i = 0; i < nbPackets; i++)
+  {
+    packet[0] = ACCEL_BLOCK_DATA_COMM;
+    memcpy(&packet[1], &block[3 * i], 3);
+    packet[4] = packet[0] ^ packet[1] ^ packet[2] ^ packet[3];
+    ok &= Decode(decoder, packet);
+  }
+
+  WireBytes += (1 + nbPackets) * PACKET_NB_BYTES;
+  return ok;
+}
+
+/*! @brief Sends the samples in blocks and checks that they all decode bit for bit.
+ *
+ *  @return double - Bytes on the wire per sample, or a negative value if the check failed.
+ */
+static double RoundTrip(const uint8_t blockLength, const uint8_t resolution)
+{
+  TDecoder decoder = { 0 };
+  const unsigned nbSamples = NB_SAMPLES - NB_SAMPLES % blockLength;
+  unsigned i, channel;
+
+  NbDecoded = 0;
+  WireBytes = 0;
+  for (i = 0; i < nbSamples; i += blockLength)
+  {
+    if (!Send(&decoder, &Samples[i], blockLength, resolution))
+    {
+      return -1;
+    }
+  }
+
+  if (NbDecoded != nbSamples)
+  {
+    return -1;
+  }
+  for (i = 0; i < nbSamples; i++)
+  {
+    for (channel = 0; channel < COMPRESS_NB_CHANNELS; channel++)
+    {
+      const int16_t expected = (resolution == RESOLUTION_8_BIT) ? (int16_t) ((Samples[i][channel] >> 6) * 64) : Samples[i][channel];
+
+      if (Decoded[i][channel] != expected)
+      {
+        printf("sample %u axis %u: %d, expected %d\n", i, channel, Decoded[i][channel], expected);
+        return -1;
+      }
+    }
+  }
+  return (double) WireBytes / nbSamples;
+}
+
+/*! @brief Fills Samples with synthetic accelerometer data at 100 Hz, in 14-bit counts (4096 per g).
+ *
+ *  @param motion is the amplitude of the body motion in g.
+ *  @param noise is the peak sensor noise in counts.
+ *  @param random fills the samples with full-range noise instead.
+ *  @param alternate fills the samples with full scale swings from +8191 to -8192 and back instead, the
+ *         longest block there can be.
+ */
+static void Generate(const double motion, const int noise, const bool random, const bool alternate)
+{
+  unsigned n, channel;
+  double t, value;
+
+  srand(1);
+  for (n = 0; n < NB_SAMPLES; n++)
+  {
+    t = n / 100.0;
+    for (channel = 0; channel < COMPRESS_NB_CHANNELS; channel++)
+    {
+      if (alternate)
+      {
+        value = (n & 1) ? -8192 : 8191;
+      }
+      else if (random)
+      {
+        value = (rand() % 16384) - 8192;
+      }
+      else
+      {
+        // A stride at 1.8 Hz sways X and Y and bounces Z, which also carries gravity
+        value = (channel == 2) ? 4096 + 4096 * motion * sin(2 * M_PI * 3.6 * t)
+            : 4096 * motion * sin(2 * M_PI * 1.8 * t + channel);
+        value += (rand() % (2 * noise + 1)) - noise;
+      }
+      Samples[n][channel] = (int16_t) fmax(fmin(lround(value), 8191), -8192);
+    }
+  }
+}
+
+/*! @brief Decodes a capture and prints the samples.
+ *
+ *  @return int - 0 if the whole capture decoded.
+ */
+static int DecodeFile(const char* const fileName)
+{
+  static TDecoder decoder;
+  uint8_t packet[PACKET_NB_BYTES];
+  unsigned i, channel, errors = 0;
+  FILE* file = fopen(fileName, "rb");
+
+  if (!file)
+  {
+    perror(fileName);
+    return 1;
+  }
+
+  while (fread(packet, 1, 1, file) == 1)
+  {
+    // Resynchronise a byte at a time until a packet checks out, as Packet_Get does
+    if (fread(&packet[1], 1, PACKET_NB_BYTES - 1, file) != PACKET_NB_BYTES - 1)
+    {
+      break;
+    }
+    while ((packet[0] ^ packet[1] ^ packet[2] ^ packet[3]) != packet[4])
+    {
+      memmove(packet, &packet[1], PACKET_NB_BYTES - 1);
+      if (fread(&packet[PACKET_NB_BYTES - 1], 1, 1, file) != 1)
+      {
+        fclose(file);
+        return errors ? 1 : 0;
+      }
+    }
+    if (!Decode(&decoder, packet))
+    {
+      errors++;
+      fprintf(stderr, "%s: bad block at byte %ld\n", fileName, ftell(file));
+    }
+
+    for (i = 0; (i < NbDecoded) && (i < NB_SAMPLES); i++)
+    {
+      for (channel = 0; channel < COMPRESS_NB_CHANNELS; channel++)
+      {
+        printf("%d%c", Decoded[i][channel], (channel < COMPRESS_NB_CHANNELS - 1) ? ',' : '\n');
+      }
+    }
+    // Decoded is reused once printed
+    NbDecoded = 0;
+  }
+
+  fclose(file);
+  return errors ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+  static const struct
+  {
+    const char* name;
+    double motion;
+    int noise;
+    bool random;
+    bool alternate;
+  } DATA[] = { { "At rest", 0, 4, false, false }, { "Walking", 0.3, 4, false, false }, { "Running", 1.0, 8, false, false },
+      { "Full-range noise", 0, 0, true, false }, { "Full-scale alternation", 0, 0, false, true } };
+  static const uint8_t BLOCK_LENGTHS[] = { 1, 4, 8, 16 };
+  unsigned d, b, length;
+  double wire8, wire14;
+  bool passed = true;
+
+  if (argc > 1)
+  {
+    return DecodeFile(argv[1]);
+  }
+
+  for (d = 0; d < sizeof(DATA) / sizeof(DATA[0]); d++)
+  {
+    Generate(DATA[d].motion, DATA[d].noise, DATA[d].random, DATA[d].alternate);
+    printf("%s: bytes on the wire per sample (8-bit uncompressed %.2f, 14-bit packed %.2f)\n", DATA[d].name,
+        WIRE_8_BIT, WIRE_14_BIT);
+    for (b = 0; b < sizeof(BLOCK_LENGTHS) / sizeof(BLOCK_LENGTHS[0]); b++)
+    {
+      wire8 = RoundTrip(BLOCK_LENGTHS[b], RESOLUTION_8_BIT);
+      wire14 = RoundTrip(BLOCK_LENGTHS[b], RESOLUTION_14_BIT);
+      printf("  %2u samples per block: 8-bit %5.2f (x%.2f), 14-bit %5.2f (x%.2f)\n", BLOCK_LENGTHS[b], wire8,
+          WIRE_8_BIT / wire8, wire14, WIRE_14_BIT / wire14);
+      passed &= (wire8 > 0) && (wire14 > 0);
+    }
+
+    // Every length, for the bit-exact check
+    for (length = 1; length <= COMPRESS_MAX_SAMPLES; length++)
+    {
+      passed &= (RoundTrip(length, RESOLUTION_8_BIT) > 0) && (RoundTrip(length, RESOLUTION_14_BIT) > 0);
+    }
+  }
+
+  printf(passed ? "PASS\n" : "FAIL\n");
+  return passed ? 0 : 1;
+}
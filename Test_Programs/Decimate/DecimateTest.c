@@ -0,0 +1,163 @@
+/*! @file
+ *
+ *  @brief Checks the decimation stage in Lab5 decimate.c.
+ *
+ *  Checks unity gain at DC for every factor, that changing the factor does not disturb the output,
+ *  how well tones that would alias are rejected, and that the automatic factor keeps a simulated
+ *  transmit queue from filling while sending as many samples as the link can carry.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "decimate.h"
+
+#define QUEUE_SIZE 256u          /*!< The UART transmit FIFO */
+#define BYTES_PER_OUTPUT 10u     /*!< A timestamp and an 8-bit sample packet */
+#define MIN_ALIAS_REJECTION 25.0 /*!< dB, for a tone 5 % of the output rate away from it */
+
+static bool Passed = true;
+
+/*! @brief Reports a check.
+ */
+static void Check(const bool ok, const char* const what)
+{
+  printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+  Passed &= ok;
+}
+
+/*! @brief Feeds a constant until the filter has settled, then checks the output is that constant.
+ *
+ *  @return bool - TRUE if the output equals the input.
+ */
+static bool DC(const int16_t value, const uint8_t factor)
+{
+  const int16_t in[DECIMATE_NB_CHANNELS] = { value, (int16_t) -value, (int16_t) (value / 3) };
+  int16_t out[DECIMATE_NB_CHANNELS];
+  unsigned n;
+
+  for (n = 0; n < 4u * factor; n++)
+  {
+    Decimate_Update(in, out, 100);
+  }
+  return (out[0] == in[0]) && (out[1] == in[1]) && (out[2] == in[2]);
+}
+
+/*! @brief Measures the output level of a tone.
+ *
+ *  @return double - The output amplitude relative to the input, in dB.
+ */
+static double Tone(const uint8_t factor, const double frequency)
+{
+  const double amplitude = 4000;
+  int16_t in[DECIMATE_NB_CHANNELS], out[DECIMATE_NB_CHANNELS];
+  double peak = 0;
+  unsigned n;
+
+  Decimate_Set(factor, false);
+  for (n = 0; n < 400u * factor; n++)
+  {
+    in[0] = in[1] = in[2] = (int16_t) lround(amplitude * sin(2 * M_PI * frequency * n + 0.3));
+    if (Decimate_Update(in, out, 100) && (n > 100u * factor) && (abs(out[0]) > peak))
+    {
+      peak = abs(out[0]);
+    }
+  }
+  return 20 * log10(fmax(peak, 0.5) / amplitude);
+}
+
+/*! @brief Runs a stream through a simulated link.
+ *
+ *  @param drain is the bytes the link sends per input sample.
+ *  @param overflows is set to the outputs that found the queue full after the first second.
+ *  @return uint8_t - The factor at the end.
+ */
+static uint8_t Link(const double drain, unsigned* const overflows)
+{
+  const int16_t in[DECIMATE_NB_CHANNELS] = { 0 };
+  int16_t out[DECIMATE_NB_CHANNELS];
+  double queued = 0;
+  unsigned n;
+
+  *overflows = 0;
+  for (n = 0; n < 8000; n++)
+  {
+    if (Decimate_Update(in, out, (uint8_t) ((QUEUE_SIZE - queued) * 100 / QUEUE_SIZE)))
+    {
+      if (queued + BYTES_PER_OUTPUT > QUEUE_SIZE)
+      {
+        *overflows += (n >= 800);
+      }
+      else
+      {
+        queued += BYTES_PER_OUTPUT;
+      }
+    }
+    queued = fmax(queued - drain, 0);
+  }
+  return Decimate_GetFactor();
+}
+
+int main(void)
+{
+  int16_t in[DECIMATE_NB_CHANNELS] = { 1234, -4321, 8191 }, out[DECIMATE_NB_CHANNELS];
+  bool ok = true;
+  unsigned factor, n, overflows;
+  char text[80];
+
+  Decimate_Init();
+  Check(!Decimate_Set(0, false) && !Decimate_Set(DECIMATE_MAX_FACTOR + 1, false), "Factors out of range are refused");
+
+  for (factor = 1; factor <= DECIMATE_MAX_FACTOR; factor++)
+  {
+    Decimate_Set(factor, false);
+    ok &= DC(8191, factor) && DC(-8192, factor) && DC(1, factor) && DC(-1, factor);
+  }
+  Check(ok, "Unity gain at DC for every factor");
+
+  // A change of factor picks up from the last output
+  ok = true;
+  Decimate_Set(4, false);
+  DC(in[0], 4);
+  for (factor = 1; factor <= DECIMATE_MAX_FACTOR; factor++)
+  {
+    Decimate_Set(factor, false);
+    in[0] = in[1] = in[2] = 1234;
+    for (n = 0; n < factor; n++)
+    {
+      ok &= !Decimate_Update(in, out, 100) == (n < factor - 1u);
+    }
+    ok &= (out[0] == 1234) && (Decimate_GetFactor() == factor);
+  }
+  Check(ok, "No step when the factor changes");
+
+  for (factor = 2; factor <= DECIMATE_MAX_FACTOR; factor *= 2)
+  {
+    const double passband = Tone(factor, 0.05 / factor), alias = Tone(factor, 1.05 / factor);
+
+    snprintf(text, sizeof(text), "M = %2u: tone at 0.05 fs/M %5.1f dB, its alias %5.1f dB", factor, passband, alias);
+    Check((passband > -1) && (passband - alias > MIN_ALIAS_REJECTION), text);
+  }
+
+  // 10 bytes per output against 2 bytes per input sample needs M >= 5, so M should settle on 8
+  Decimate_Set(1, true);
+  factor = Link(2, &overflows);
+  snprintf(text, sizeof(text), "Slow link: M = %u, %u overflows", factor, overflows);
+  Check((factor == 8) && (overflows == 0) && Decimate_IsAutomatic(), text);
+
+  // Once the link speeds up M comes back down to the smallest allowed
+  factor = Link(20, &overflows);
+  snprintf(text, sizeof(text), "Fast link: M = %u, %u overflows", factor, overflows);
+  Check((factor == 1) && (overflows == 0), text);
+
+  Decimate_Set(3, true);
+  factor = Link(20, &overflows);
+  snprintf(text, sizeof(text), "Fast link, smallest M 3: M = %u", factor);
+  Check(factor == 3, text);
+
+  printf(Passed ? "PASS\n" : "FAIL\n");
+  return Passed ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/*! @file
+ *
+ *  @brief Checks the Lab5 fixed-point filters against double precision and times them.
+ *
+ *  Each coefficient set is designed again here in double precision, from the same Butterworth
+ *  and windowed-sinc formulas, and both run over golden vectors: a step from rest to 1 g,
+ *  tones below and above the cut-off, and full-scale noise. The fixed-point output must stay
+ *  within MAX_ERROR counts of the reference, which covers the coefficient quantisation and
+ *  the rounding of each output. Times are per XYZ sample on the host.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "filter.h"
+
+#define NB_SAMPLES 20000u   /*!< Length of each golden vector */
+#define NB_TIMED   2000000u /*!< Samples timed per coefficient set */
+#define ONE_G      4096     /*!< 1 g in 14-bit counts at the 2 g range */
+#define MAX_ERROR  4.0      /*!< Largest allowed difference from the reference, in counts */
+
+typedef enum
+{
+  DESIGN_LOW_PASS,
+  DESIGN_HIGH_PASS
+} TDesign;
+
+/*!
+ * @brief Double precision biquad, y = b0.x + b1.x1 + b2.x2 - a1.y1 - a2.y2.
+ */
+typedef struct
+{
+  double b0, b1, b2, a1, a2;
+  double x1, x2, y1, y2;
+} TReferenceBiquad;
+
+/*!
+ * @brief The reference for a coefficient set.
+ */
+typedef struct
+{
+  unsigned nbBiquads;
+  TReferenceBiquad biquads[FILTER_MAX_BIQUADS];
+  unsigned nbTaps;
+  double taps[FILTER_MAX_TAPS];
+  double history[FILTER_MAX_TAPS];
+} TReference;
+
+static int16_t Input[NB_TIMED][FILTER_NB_CHANNELS];
+static volatile int16_t Sink;  /*!< Keeps the compiler from dropping the filter output */
+
+/*! @brief Designs a 2nd order Butterworth section by the bilinear transform.
+ *
+ *  @param cutOff is the cut-off as a fraction of the sample rate.
+ */
+static TReferenceBiquad Butterworth(const TDesign design, const double cutOff)
+{
+  const double w0 = 2 * M_PI * cutOff, c = cos(w0), alpha = sin(w0) / sqrt(2), a0 = 1 + alpha;
+  TReferenceBiquad biquad = { 0 };
+
+  if (design == DESIGN_LOW_PASS)
+  {
+    biquad.b0 = biquad.b2 = (1 - c) / 2 / a0;
+    biquad.b1 = (1 - c) / a0;
+  }
+  else
+  {
+    biquad.b0 = biquad.b2 = (1 + c) / 2 / a0;
+    biquad.b1 = -(1 + c) / a0;
+  }
+  biquad.a1 = -2 * c / a0;
+  biquad.a2 = (1 - alpha) / a0;
+  return biquad;
+}
+
+/*! @brief Designs a Hamming windowed-sinc low-pass with unity gain at DC.
+ */
+static void WindowedSinc(TReference* const reference, const unsigned nbTaps, const double cutOff)
+{
+  double sum = 0, m;
+  unsigned n;
+
+  reference->nbTaps = nbTaps;
+  for (n = 0; n < nbTaps; n++)
+  {
+    m = n - (nbTaps - 1) / 2.0;
+    reference->taps[n] = ((m == 0) ? 2 * cutOff : sin(2 * M_PI * cutOff * m) / (M_PI * m))
+        * (0.54 - 0.46 * cos(2 * M_PI * n / (nbTaps - 1)));
+    sum += reference->taps[n];
+  }
+  for (n = 0; n < nbTaps; n++)
+  {
+    reference->taps[n] /= sum;
+  }
+}
+
+/*! @brief Designs the reference for a coefficient set, as documented in filter.h.
+ */
+static void Design(TReference* const reference, const TFilterSetIndex set)
+{
+  *reference = (TReference) { 0 };
+  switch (set)
+  {
+    case FILTER_SET_LOW_PASS_10:
+      reference->nbBiquads = 1;
+      reference->biquads[0] = Butterworth(DESIGN_LOW_PASS, 1.0 / 10);
+      break;
+    case FILTER_SET_LOW_PASS_40:
+      reference->nbBiquads = 1;
+      reference->biquads[0] = Butterworth(DESIGN_LOW_PASS, 1.0 / 40);
+      break;
+    case FILTER_SET_HIGH_PASS_100:
+      reference->nbBiquads = 1;
+      reference->biquads[0] = Butterworth(DESIGN_HIGH_PASS, 1.0 / 100);
+      break;
+    case FILTER_SET_BAND_PASS:
+      reference->nbBiquads = 2;
+      reference->biquads[0] = Butterworth(DESIGN_HIGH_PASS, 1.0 / 100);
+      reference->biquads[1] = Butterworth(DESIGN_LOW_PASS, 1.0 / 10);
+      break;
+    case FILTER_SET_FIR_LOW_PASS_8:
+      WindowedSinc(reference, FILTER_MAX_TAPS, 1.0 / 8);
+      break;
+    default:
+      break;
+  }
+}
+
+/*! @brief Runs a sample through the reference.
+ */
+static double Reference(TReference* const reference, double x)
+{
+  unsigned i;
+
+  for (i = 0; i < reference->nbBiquads; i++)
+  {
+    TReferenceBiquad* const s = &reference->biquads[i];
+    const double y = s->b0 * x + s->b1 * s->x1 + s->b2 * s->x2 - s->a1 * s->y1 - s->a2 * s->y2;
+
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    x = y;
+  }
+
+  if (reference->nbTaps)
+  {
+    double y = 0;
+
+    for (i = reference->nbTaps - 1; i > 0; i--)
+    {
+      reference->history[i] = reference->history[i - 1];
+    }
+    reference->history[0] = x;
+    for (i = 0; i < reference->nbTaps; i++)
+    {
+      y += reference->taps[i] * reference->history[i];
+    }
+    x = y;
+  }
+  return x;
+}
+
+/*! @brief Compares a coefficient set with its reference over the golden vectors.
+ *
+ *  @return double - The largest difference, in counts.
+ */
+static double Check(const TFilterSetIndex set)
+{
+  TFilter filter;
+  TReference reference[FILTER_NB_CHANNELS];
+  int16_t out[FILTER_NB_CHANNELS];
+  double error, maxError = 0;
+  unsigned n, channel;
+
+  Filter_Init(&filter, set);
+  for (channel = 0; channel < FILTER_NB_CHANNELS; channel++)
+  {
+    Design(&reference[channel], set);
+  }
+
+  for (n = 0; n < NB_SAMPLES; n++)
+  {
+    Filter_Update(&filter, Input[n], out);
+    for (channel = 0; channel < FILTER_NB_CHANNELS; channel++)
+    {
+      error = fabs(out[channel] - fmin(fmax(Reference(&reference[channel], Input[n][channel]), FILTER_OUTPUT_MIN), FILTER_OUTPUT_MAX));
+      if (error > maxError)
+      {
+        maxError = error;
+      }
+    }
+  }
+  return maxError;
+}
+
+/*! @brief Nanoseconds since an arbitrary start.
+ */
+static double Now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*! @brief Times a coefficient set.
+ *
+ *  @return The time per XYZ sample in nanoseconds.
+ */
+static double Time(const TFilterSetIndex set)
+{
+  TFilter filter;
+  int16_t out[FILTER_NB_CHANNELS];
+  double start;
+  unsigned n;
+
+  Filter_Init(&filter, set);
+  start = Now();
+  for (n = 0; n < NB_TIMED; n++)
+  {
+    Filter_Update(&filter, Input[n], out);
+    Sink = out[0];
+  }
+  return (Now() - start) / NB_TIMED;
+}
+
+int main(void)
+{
+  static const char* const NAMES[FILTER_NB_SETS] = { "None", "Low-pass fs/10", "Low-pass fs/40",
+      "High-pass fs/100", "Band-pass", "FIR low-pass fs/8" };
+  unsigned n, set;
+  double error;
+  bool passed = !Filter_Init(&(TFilter) { 0 }, FILTER_NB_SETS);
+
+  // Golden vectors: X steps from rest to 1 g, Y holds two tones either side of the cut-offs
+  // on top of 1 g, Z is noise over half the range; the timed part carries on with noise
+  srand(1);
+  for (n = 0; n < NB_TIMED; n++)
+  {
+    Input[n][0] = (n < 100) ? 0 : ONE_G;
+    Input[n][1] = (int16_t) lround(ONE_G + 1500 * sin(2 * M_PI * n / 400.0) + 1500 * sin(2 * M_PI * n / 5.0));
+    Input[n][2] = (int16_t) ((rand() % 8000) - 4000);
+  }
+
+  printf("Set                Max error  ns/sample\n");
+  for (set = 0; set < FILTER_NB_SETS; set++)
+  {
+    error = Check(set);
+    if (error > MAX_ERROR)
+    {
+      passed = false;
+    }
+    printf("%-17s  %9.2f  %9.1f\n", NAMES[set], error, Time(set));
+  }
+
+  printf(passed ? "PASS\n" : "FAIL\n");
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/*! @file
+ *
+ *  @brief Replays a flash workload through Flash.c on the FTFE emulator.
+ *
+ *  Reports the erase and program counts, write amplification and wear that the
+ *  flash strategy in Lab5/OSExample/Sources/Flash.c produces for the workload.
+ *
+ *  Workload files hold one operation per line ('#' starts a comment):
+ *    alloc <size>            Flash_AllocateVar, as done by Packet_Init
+ *    w8    <address> <data>  Flash_Write8
+ *    w16   <address> <data>  Flash_Write16
+ *    w32   <address> <data>  Flash_Write32
+ *    erase                   Flash_Erase
+ *  Without a file the built-in workload replays a Lab5 session.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "FlashEmu.h"
+#include "Flash.h"
+
+#define ENDURANCE_CYCLES 10000u /*!< Minimum program/erase endurance of the K70 program flash */
+
+static uint32_t LogicalBytes; /*!< Bytes the workload asked to store */
+static uint32_t Failures;     /*!< Flash.c calls that returned false, or data that did not read back */
+
+/*! @brief Runs one workload operation.
+ *
+ *  @return bool - TRUE if the operation was recognised.
+ */
+static bool Replay(const char* const op, const unsigned long address, const unsigned long data)
+{
+  volatile void *variable;
+  bool ok;
+
+  if (!strcmp(op, "alloc"))
+  {
+    ok = Flash_AllocateVar(&variable, (uint8_t) address);
+  }
+  else if (!strcmp(op, "w8"))
+  {
+    ok = Flash_Write8((volatile uint8_t *) address, (uint8_t) data);
+    LogicalBytes += 1;
+  }
+  else if (!strcmp(op, "w16"))
+  {
+    ok = Flash_Write16((volatile uint16_t *) address, (uint16_t) data);
+    LogicalBytes += 2;
+  }
+  else if (!strcmp(op, "w32"))
+  {
+    ok = Flash_Write32((volatile uint32_t *) address, (uint32_t) data);
+    LogicalBytes += 4;
+  }
+  else if (!strcmp(op, "erase"))
+  {
+    ok = Flash_Erase();
+  }
+  else
+  {
+    return false;
+  }
+
+  if (!ok)
+  {
+    Failures++;
+  }
+  return true;
+}
+
+/*! @brief Replays a workload file.
+ *
+ *  @return bool - TRUE if the whole file was understood.
+ */
+static bool ReplayFile(const char* const fileName)
+{
+  char line[128], op[16];
+  unsigned long address, data;
+  unsigned lineNb = 0;
+  FILE *file = fopen(fileName, "r");
+
+  if (!file)
+  {
+    perror(fileName);
+    return false;
+  }
+
+  while (fgets(line, sizeof(line), file))
+  {
+    lineNb++;
+    address = data = 0;
+    if ((line[0] == '#') || (sscanf(line, "%15s %li %li", op, &address, &data) < 1))
+    {
+      continue;
+    }
+    if (!Replay(op, address, data))
+    {
+      fprintf(stderr, "%s:%u: unknown operation '%s'\n", fileName, lineNb, op);
+      fclose(file);
+      return false;
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+/*! @brief Replays a typical Lab5 session.
+ *
+ *  Start-up programs the tower number and mode, then the PC sets both a few times and
+ *  uses the "program byte" command across the phrase.
+ */
+static void ReplayBuiltIn(void)
+{
+  unsigned i;
+
+  Replay("alloc", 2, 0);
+  Replay("alloc", 2, 0);
+  Replay("w16", FLASH_DATA_START, 0x13A8);
+  Replay("w16", FLASH_DATA_START + 2, 0x0001);
+
+  for (i = 0; i < 100; i++)
+  {
+    Replay("w16", FLASH_DATA_START, 0x1000 + i);
+    Replay("w16", FLASH_DATA_START + 2, i & 1);
+  }
+  for (i = 0; i < 64; i++)
+  {
+    Replay("w8", FLASH_DATA_START + 4 + (i % 4), i);
+  }
+
+  // The emulated array must hold what was last written
+  if ((_FH(FLASH_DATA_START) != 0x1000 + 99) || (_FH(FLASH_DATA_START + 2) != 1) || (_FB(FLASH_DATA_START + 7) != 63))
+  {
+    Failures++;
+  }
+}
+
+/*! @brief Prints the statistics gathered during the replay.
+ */
+static void Report(void)
+{
+  const TFlashEmuStats *stats = FlashEmu_Stats();
+  const TFlashEmuSector *sector;
+  uint32_t physicalBytes = stats->programs * FLASH_EMU_PHRASE_SIZE;
+  uint32_t worstErases = 0;
+  uint32_t address;
+
+  printf("Logical bytes written   : %u\n", LogicalBytes);
+  printf("Failed Flash.c calls    : %u\n", Failures);
+  printf("Commands / rejected     : %u / %u\n", stats->commands, stats->rejected);
+  printf("Sector erases           : %u\n", stats->erases);
+  printf("Phrase programs         : %u\n", stats->programs);
+  printf("Erase-before-program    : %u violations\n", stats->violations);
+  if (LogicalBytes)
+  {
+    printf("Write amplification     : %.2f (programmed bytes / logical bytes)\n", (double) physicalBytes / LogicalBytes);
+    printf("Erased bytes per byte   : %.1f\n", (double) stats->erases * FLASH_EMU_SECTOR_SIZE / LogicalBytes);
+  }
+  printf("Busy time               : %.3f ms in %u FSTAT polls\n", stats->busyTimeUs / 1000.0, stats->polls);
+
+  printf("\nSector       Erases  Programs  Violations\n");
+  for (address = 0; address < FLASH_EMU_SIZE; address += FLASH_EMU_SECTOR_SIZE)
+  {
+    sector = FlashEmu_Sector(address);
+    if (sector->erases || sector->programs)
+    {
+      printf("0x%06X  %8u  %8u  %10u\n", address, sector->erases, sector->programs, sector->violations);
+      if (sector->erases > worstErases)
+      {
+	worstErases = sector->erases;
+      }
+    }
+  }
+
+  if (worstErases)
+  {
+    printf("\nWorkload repetitions to reach %u cycles on the most worn sector: %u\n",
+	ENDURANCE_CYCLES, ENDURANCE_CYCLES / worstErases);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (!FlashEmu_Init() || !Flash_Init())
+  {
+    return 1;
+  }
+
+  if (argc > 1)
+  {
+    if (!ReplayFile(argv[1]))
+    {
+      return 1;
+    }
+  }
+  else
+  {
+    ReplayBuiltIn();
+  }
+
+  Report();
+  return 0;
+}
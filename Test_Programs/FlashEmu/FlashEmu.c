@@ -0,0 +1,233 @@
+/*! @file
+ *
+ *  @brief Host emulator for the K70 FTFE flash controller.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <string.h>
+#include <stdio.h>
+#include "FlashEmu.h"
+#include "MK70F12.h"
+
+#define FCCOB_IDLE 0xFFu /*!< Not a valid FTFE command; marks FCCOB0 as consumed */
+#define CELL(address) (Array[(address) - FLASH_EMU_MAP_START])
+
+TFlashEmuRegs FlashEmu_Regs;
+
+static uint8_t *Array;                  /*!< The simulated array, mapped at its K70 address */
+static TFlashEmuSector Sectors[FLASH_EMU_NB_SECTORS];
+static TFlashEmuStats Stats;
+static bool Armed;                      /*!< The FCCOBs are loaded and the next FSTAT access launches */
+static uint32_t BusyUs;                 /*!< Time left on the current command */
+
+/*! @brief Assembles the 24-bit flash address from FCCOB1..3.
+ *
+ *  @return The target address of the command.
+ */
+static uint32_t CommandAddress(void)
+{
+  return ((uint32_t)FlashEmu_Regs.FCCOB[1] << 16) | ((uint32_t)FlashEmu_Regs.FCCOB[2] << 8) | FlashEmu_Regs.FCCOB[3];
+}
+
+/*! @brief Checks that a range is inside the mapped part of the array.
+ *
+ *  @return bool - TRUE if the firmware is allowed to modify the range.
+ */
+static bool Writable(const uint32_t address, const uint32_t length)
+{
+  return (address >= FLASH_EMU_MAP_START) && (address + length <= FLASH_EMU_SIZE);
+}
+
+/*! @brief Erases one sector (ERSSCR).
+ *
+ *  @return bool - TRUE if the command was accepted.
+ */
+static bool EraseSector(const uint32_t address)
+{
+  uint32_t base = address & ~(FLASH_EMU_SECTOR_SIZE - 1);
+
+  if (!Writable(base, FLASH_EMU_SECTOR_SIZE))
+  {
+    FlashEmu_Regs.FSTAT |= FTFE_FSTAT_FPVIOL_MASK;
+    return false;
+  }
+
+  memset(&CELL(base), 0xFF, FLASH_EMU_SECTOR_SIZE);
+  Sectors[base / FLASH_EMU_SECTOR_SIZE].erases++;
+  Stats.erases++;
+  BusyUs = FLASH_EMU_ERSSCR_US;
+  return true;
+}
+
+/*! @brief Programs one phrase (PGM8).
+ *
+ *  The FCCOB bytes are laid out big-endian per longword, see the Program Phrase command description.
+ *  Programming can only clear bits, so a phrase that was not erased keeps the AND of old and new data.
+ *  @return bool - TRUE if the command was accepted.
+ */
+static bool ProgramPhrase(const uint32_t address)
+{
+  static const uint8_t FCCOB_FOR_BYTE[FLASH_EMU_PHRASE_SIZE] = { 0x7, 0x6, 0x5, 0x4, 0xB, 0xA, 0x9, 0x8 };
+  TFlashEmuSector *sector;
+  bool erased = true;
+  uint8_t i;
+
+  if (address % FLASH_EMU_PHRASE_SIZE)
+  {
+    FlashEmu_Regs.FSTAT |= FTFE_FSTAT_ACCERR_MASK;
+    return false;
+  }
+  if (!Writable(address, FLASH_EMU_PHRASE_SIZE))
+  {
+    FlashEmu_Regs.FSTAT |= FTFE_FSTAT_FPVIOL_MASK;
+    return false;
+  }
+
+  sector = &Sectors[address / FLASH_EMU_SECTOR_SIZE];
+  for (i = 0; i < FLASH_EMU_PHRASE_SIZE; i++)
+  {
+    if (CELL(address + i) != 0xFF)
+    {
+      erased = false;
+    }
+    CELL(address + i) &= FlashEmu_Regs.FCCOB[FCCOB_FOR_BYTE[i]];
+  }
+
+  if (!erased)
+  {
+    // The real part flags this through the program verify
+    FlashEmu_Regs.FSTAT |= FTFE_FSTAT_MGSTAT0_MASK;
+    sector->violations++;
+    Stats.violations++;
+  }
+
+  sector->programs++;
+  Stats.programs++;
+  BusyUs = FLASH_EMU_PGM8_US;
+  return true;
+}
+
+/*! @brief Executes the command held in the FCCOBs.
+ *
+ *  @param written The value the firmware wrote to FSTAT.
+ */
+static void Launch(const uint8_t written)
+{
+  uint8_t errors = FlashEmu_Regs.FSTAT & (FTFE_FSTAT_ACCERR_MASK | FTFE_FSTAT_FPVIOL_MASK);
+  bool accepted = false;
+
+  // ACCERR and FPVIOL are write-1-to-clear, and a launch is refused while either is set
+  FlashEmu_Regs.FSTAT &= ~(written & (FTFE_FSTAT_ACCERR_MASK | FTFE_FSTAT_FPVIOL_MASK | FTFE_FSTAT_RDCOLERR_MASK));
+  FlashEmu_Regs.FSTAT |= FTFE_FSTAT_CCIF_MASK;
+
+  if (!(written & FTFE_FSTAT_CCIF_MASK))
+  {
+    return;
+  }
+  if (errors)
+  {
+    FlashEmu_Regs.FCCOB[0] = FCCOB_IDLE;
+    Stats.rejected++;
+    return;
+  }
+
+  FlashEmu_Regs.FSTAT &= ~FTFE_FSTAT_MGSTAT0_MASK;
+  switch (FlashEmu_Regs.FCCOB[0])
+  {
+    case FLASH_EMU_CMD_ERSSCR:
+      accepted = EraseSector(CommandAddress());
+      break;
+    case FLASH_EMU_CMD_PGM8:
+      accepted = ProgramPhrase(CommandAddress());
+      break;
+    default:
+      FlashEmu_Regs.FSTAT |= FTFE_FSTAT_ACCERR_MASK;
+      break;
+  }
+
+  FlashEmu_Regs.FCCOB[0] = FCCOB_IDLE;
+  if (!accepted)
+  {
+    Stats.rejected++;
+    return;
+  }
+
+  Stats.commands++;
+  Stats.busyTimeUs += BusyUs;
+  FlashEmu_Regs.FSTAT &= ~FTFE_FSTAT_CCIF_MASK;
+}
+
+bool FlashEmu_Init(void)
+{
+  void *map;
+
+  if (!Array)
+  {
+    map = mmap((void *) FLASH_EMU_MAP_START, FLASH_EMU_SIZE - FLASH_EMU_MAP_START, PROT_READ | PROT_WRITE,
+	MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (map != (void *) FLASH_EMU_MAP_START)
+    {
+      perror("FlashEmu: cannot map the flash array");
+      return false;
+    }
+    Array = map;
+  }
+
+  memset(Array, 0xFF, FLASH_EMU_SIZE - FLASH_EMU_MAP_START);
+  memset((void *) &FlashEmu_Regs, 0, sizeof(FlashEmu_Regs));
+  FlashEmu_Regs.FSTAT = FTFE_FSTAT_CCIF_MASK;
+  FlashEmu_Regs.FCCOB[0] = FCCOB_IDLE;
+  Armed = false;
+  BusyUs = 0;
+  FlashEmu_ResetStats();
+  return true;
+}
+
+volatile uint8_t* FlashEmu_FSTAT(void)
+{
+  if (Armed)
+  {
+    // The previous access was the command launch
+    Armed = false;
+    Launch(FlashEmu_Regs.FSTAT);
+  }
+  else if (BusyUs)
+  {
+    Stats.polls++;
+    BusyUs = (BusyUs > FLASH_EMU_POLL_US) ? (BusyUs - FLASH_EMU_POLL_US) : 0;
+    if (!BusyUs)
+    {
+      FlashEmu_Regs.FSTAT |= FTFE_FSTAT_CCIF_MASK;
+    }
+  }
+  else if (FlashEmu_Regs.FCCOB[0] != FCCOB_IDLE)
+  {
+    Armed = true;
+  }
+
+  return &FlashEmu_Regs.FSTAT;
+}
+
+void FlashEmu_ResetStats(void)
+{
+  memset(Sectors, 0, sizeof(Sectors));
+  memset(&Stats, 0, sizeof(Stats));
+}
+
+const TFlashEmuStats* FlashEmu_Stats(void)
+{
+  return &Stats;
+}
+
+const TFlashEmuSector* FlashEmu_Sector(const uint32_t address)
+{
+  if (address >= FLASH_EMU_SIZE)
+  {
+    return NULL;
+  }
+  return &Sectors[address / FLASH_EMU_SECTOR_SIZE];
+}
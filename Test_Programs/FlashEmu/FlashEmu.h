@@ -0,0 +1,109 @@
+/*! @file
+ *
+ *  @brief Host emulator for the K70 FTFE flash controller.
+ *
+ *  Models the FTFE command interface over a simulated 1 MB program flash so
+ *  that Flash.c can be exercised without a board. The emulator enforces the
+ *  erase-before-program rule, charges a latency to every command and keeps
+ *  erase and program counts per 4 KB sector.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#ifndef FLASHEMU_H
+#define FLASHEMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Geometry of the MK70FN1M0 program flash
+#define FLASH_EMU_SIZE        0x00100000LU  /*!< 1 MB of program flash */
+#define FLASH_EMU_SECTOR_SIZE 0x1000LU      /*!< 4 KB erase sector */
+#define FLASH_EMU_PHRASE_SIZE 8LU           /*!< Program phrase */
+#define FLASH_EMU_NB_SECTORS  (FLASH_EMU_SIZE / FLASH_EMU_SECTOR_SIZE)
+
+// The host cannot map page zero, so the array is mapped from the usual mmap_min_addr.
+// The vector table and flash configuration field live below it and are treated as protected.
+#define FLASH_EMU_MAP_START   0x00010000LU
+
+// FTFE commands understood by the emulator
+#define FLASH_EMU_CMD_PGM8    0x07u
+#define FLASH_EMU_CMD_ERSSCR  0x09u
+
+// Typical command times from the K70 data sheet, in microseconds
+#define FLASH_EMU_ERSSCR_US   13000u
+#define FLASH_EMU_PGM8_US     70u
+// Time charged for each FSTAT poll while a command is in progress
+#define FLASH_EMU_POLL_US     10u
+
+/*!
+ * @brief The FTFE registers written directly by Flash.c.
+ */
+typedef struct
+{
+  volatile uint8_t FSTAT;      /*!< Status as seen by the firmware */
+  volatile uint8_t FCNFG;      /*!< Configuration (unused) */
+  volatile uint8_t FCCOB[12];  /*!< Command object, indexed FCCOB0..FCCOBB */
+  volatile uint32_t SCGC3;     /*!< Stand-in for SIM_SCGC3 */
+} TFlashEmuRegs;
+
+/*!
+ * @brief Per-sector wear counters.
+ */
+typedef struct
+{
+  uint32_t erases;        /*!< Sector erase commands executed */
+  uint32_t programs;      /*!< Phrase program commands executed */
+  uint32_t violations;    /*!< Programs into a phrase that was not erased */
+} TFlashEmuSector;
+
+/*!
+ * @brief Totals accumulated since FlashEmu_Init or FlashEmu_ResetStats.
+ */
+typedef struct
+{
+  uint64_t busyTimeUs;    /*!< Simulated time spent with a command in progress */
+  uint32_t polls;         /*!< FSTAT reads that found the controller busy */
+  uint32_t commands;      /*!< Commands launched */
+  uint32_t rejected;      /*!< Launches refused because of ACCERR/FPVIOL or a bad command */
+  uint32_t erases;        /*!< Sector erases across the array */
+  uint32_t programs;      /*!< Phrase programs across the array */
+  uint32_t violations;    /*!< Erase-before-program violations across the array */
+} TFlashEmuStats;
+
+extern TFlashEmuRegs FlashEmu_Regs;
+
+/*! @brief Maps the simulated flash array and resets the controller.
+ *
+ *  @return bool - TRUE if the array could be mapped at its K70 address.
+ */
+bool FlashEmu_Init(void);
+
+/*! @brief Accessor behind the FTFE_FSTAT macro.
+ *
+ *  The FTFE launches a command when CCIF is written; the emulator treats the first FSTAT access
+ *  after FCCOB0 has been loaded as that write, which is the sequence used by Flash.c and the
+ *  reference manual. Later accesses advance the simulated clock until the command completes.
+ *  @return A pointer to the status register value seen by the firmware.
+ */
+volatile uint8_t* FlashEmu_FSTAT(void);
+
+/*! @brief Clears the wear counters and statistics, keeping the array contents.
+ */
+void FlashEmu_ResetStats(void);
+
+/*! @brief Gets the accumulated statistics.
+ *
+ *  @return A pointer to the statistics.
+ */
+const TFlashEmuStats* FlashEmu_Stats(void);
+
+/*! @brief Gets the wear counters of a sector.
+ *
+ *  @param address Any address within the sector.
+ *  @return A pointer to the sector counters, or NULL if the address is outside the array.
+ */
+const TFlashEmuSector* FlashEmu_Sector(const uint32_t address);
+
+#endif
@@ -0,0 +1,45 @@
+/*! @file
+ *
+ *  @brief Host stand-in for the K70 peripheral header, FTFE subset.
+ *
+ *  Lets Lab5/OSExample/Sources/Flash.c be compiled unmodified on Linux.
+ *  The FTFE registers are redirected into the emulator in FlashEmu.c.
+ *  Only the registers and masks that Flash.c touches are provided.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#ifndef MK70F12_H
+#define MK70F12_H
+
+#include "FlashEmu.h"
+
+// FSTAT Bit Fields (K70 reference manual 30.34.1)
+#define FTFE_FSTAT_MGSTAT0_MASK  0x1u
+#define FTFE_FSTAT_FPVIOL_MASK   0x10u
+#define FTFE_FSTAT_ACCERR_MASK   0x20u
+#define FTFE_FSTAT_RDCOLERR_MASK 0x40u
+#define FTFE_FSTAT_CCIF_MASK     0x80u
+
+// FSTAT goes through an accessor so the emulator sees every poll and launch
+#define FTFE_FSTAT  (*FlashEmu_FSTAT())
+#define FTFE_FCNFG  (FlashEmu_Regs.FCNFG)
+#define FTFE_FCCOB0 (FlashEmu_Regs.FCCOB[0x0])
+#define FTFE_FCCOB1 (FlashEmu_Regs.FCCOB[0x1])
+#define FTFE_FCCOB2 (FlashEmu_Regs.FCCOB[0x2])
+#define FTFE_FCCOB3 (FlashEmu_Regs.FCCOB[0x3])
+#define FTFE_FCCOB4 (FlashEmu_Regs.FCCOB[0x4])
+#define FTFE_FCCOB5 (FlashEmu_Regs.FCCOB[0x5])
+#define FTFE_FCCOB6 (FlashEmu_Regs.FCCOB[0x6])
+#define FTFE_FCCOB7 (FlashEmu_Regs.FCCOB[0x7])
+#define FTFE_FCCOB8 (FlashEmu_Regs.FCCOB[0x8])
+#define FTFE_FCCOB9 (FlashEmu_Regs.FCCOB[0x9])
+#define FTFE_FCCOBA (FlashEmu_Regs.FCCOB[0xA])
+#define FTFE_FCCOBB (FlashEmu_Regs.FCCOB[0xB])
+
+// Clock gating is a no-op on the host
+#define SIM_SCGC3_NFC_MASK 0x100u
+#define SIM_SCGC3          (FlashEmu_Regs.SCGC3)
+
+#endif
@@ -0,0 +1,20 @@
+/*! @file
+ *
+ *  @brief Host stand-in for the Processor Expert CPU header.
+ *
+ *  Provides the clock settings of the Lab5 configuration.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#ifndef __Cpu_H
+#define __Cpu_H
+
+#include "PE_Types.h"
+
+#define CPU_BUS_CLK_HZ             25000000U
+#define CPU_CORE_CLK_HZ            50000000U
+#define CPU_MCGFF_CLK_HZ_CONFIG_0  24414U
+
+#endif
@@ -0,0 +1,99 @@
+/*! @file
+ *
+ *  @brief Host stand-in for the RTOS library.
+ *
+ *  Semaphores are plain counters, flag groups plain words, and nothing ever
+ *  blocks, which is enough for host tests that call the pure parts of a module.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include "OS.h"
+
+static OS_ECB Events[OS_MAX_EVENTS];
+static uint8_t NbEvents;
+static uint32_t Ticks;
+
+void OS_Init(const uint32_t cpuCoreClk, const bool toggleLED)
+{
+}
+
+void OS_ISREnter(void)
+{
+}
+
+void OS_ISRExit(void)
+{
+}
+
+OS_ECB* OS_SemaphoreCreate(const uint32_t value)
+{
+  if (NbEvents == OS_MAX_EVENTS)
+  {
+    return (OS_ECB*)0;
+  }
+  Events[NbEvents].count = value;
+  return &Events[NbEvents++];
+}
+
+OS_ERROR OS_SemaphoreSignal(OS_ECB* const pEvent)
+{
+  pEvent->count++;
+  return OS_NO_ERROR;
+}
+
+OS_ERROR OS_SemaphoreWait(OS_ECB* const pEvent, const uint32_t timeout)
+{
+  if (!pEvent->count)
+  {
+    return OS_TIMEOUT;
+  }
+  pEvent->count--;
+  return OS_NO_ERROR;
+}
+
+OS_FLAGS* OS_FlagsCreate(const uint32_t flags)
+{
+  static OS_FLAGS groups[OS_MAX_FLAGS];
+  static uint8_t nbGroups;
+
+  if (nbGroups == OS_MAX_FLAGS)
+  {
+    return (OS_FLAGS*)0;
+  }
+  groups[nbGroups].flags = flags;
+  return &groups[nbGroups++];
+}
+
+void OS_FlagsSet(OS_FLAGS* const pFlags, const uint32_t flags)
+{
+  pFlags->flags |= flags;
+}
+
+OS_ERROR OS_FlagsWait(OS_FLAGS* const pFlags, const uint32_t flags, const bool all, const uint32_t timeout, uint32_t* const ready)
+{
+  *ready = pFlags->flags & flags;
+  if (all ? (*ready != flags) : !*ready)
+  {
+    *ready = 0;
+    return OS_TIMEOUT;
+  }
+  pFlags->flags &= ~*ready;
+  return OS_NO_ERROR;
+}
+
+void OS_TimeDelay(const uint32_t ticks)
+{
+  Ticks += ticks;
+}
+
+uint32_t OS_TimeGet(void)
+{
+  return Ticks;
+}
+
+void OS_TimeSet(const uint32_t ticks)
+{
+  Ticks = ticks;
+}
@@ -0,0 +1,29 @@
+/*! @file
+ *
+ *  @brief Host stand-in for the Processor Expert types header.
+ *
+ *  Lets Lab5/OSExample/Sources modules be compiled on Linux. The Cortex-M
+ *  critical section macros become no-ops since host tests are single threaded.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#ifndef PE_TYPES_H
+#define PE_TYPES_H
+
+#include "types.h"
+
+#ifndef TRUE
+  #define TRUE  1U
+#endif
+#ifndef FALSE
+  #define FALSE 0U
+#endif
+
+#define EnableInterrupts
+#define DisableInterrupts
+#define EnterCritical() do {} while (0)
+#define ExitCritical()  do {} while (0)
+
+#endif
@@ -0,0 +1,159 @@
+/*! @file
+ *
+ *  @brief Checks the I2C baud divider solver in Lab5 I2C.c.
+ *
+ *  Every answer is decoded with the SCL divider table copied from the K70
+ *  reference manual (table 55-41) and compared with an exhaustive search.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include "I2C.h"
+#include "Timer.h"
+
+// SCL divider by ICR, K70 reference manual table 55-41
+static const uint16_t RM_SCL_DIVIDER[64] = {
+  /* 0x00 */ 20, 22, 24, 26, 28, 30, 34, 40,
+  /* 0x08 */ 28, 32, 36, 40, 44, 48, 56, 68,
+  /* 0x10 */ 48, 56, 64, 72, 80, 88, 104, 128,
+  /* 0x18 */ 80, 96, 112, 128, 144, 160, 192, 240,
+  /* 0x20 */ 160, 192, 224, 256, 288, 320, 384, 480,
+  /* 0x28 */ 320, 384, 448, 512, 576, 640, 768, 960,
+  /* 0x30 */ 640, 768, 896, 1024, 1152, 1280, 1536, 1920,
+  /* 0x38 */ 1280, 1536, 1792, 2048, 2304, 2560, 3072, 3840
+};
+
+static unsigned Failures;
+
+// The solver never touches the bus, so the bus timer is never started
+bool Timer_Start(TTimer* const timer, const uint32_t delay, const uint32_t period)
+{
+  return true;
+}
+
+bool Timer_Stop(TTimer* const timer)
+{
+  return false;
+}
+
+/*! @brief Decodes an I2C0_F value.
+ *
+ *  @return The total divider, or 0 for the reserved MULT value.
+ */
+static uint32_t Divider(const uint8_t f)
+{
+  uint8_t mult = f >> 6;
+
+  if (mult == 3)
+  {
+    return 0;
+  }
+  return (1u << mult) * RM_SCL_DIVIDER[f & 0x3F];
+}
+
+/*! @brief Smallest divider that does not exceed the rate, found by trying every F value.
+ *
+ *  @return The divider, or 0 if every setting is too fast.
+ */
+static uint32_t BestDivider(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  uint32_t best = 0, divider;
+  unsigned f;
+
+  for (f = 0; f < 0xC0; f++)
+  {
+    divider = Divider(f);
+    if (((uint64_t)baudRate * divider >= moduleClk) && (!best || (divider < best)))
+    {
+      best = divider;
+    }
+  }
+  return best;
+}
+
+/*! @brief Solves one rate and checks the answer.
+ */
+static void Check(const uint32_t baudRate, const uint32_t moduleClk)
+{
+  uint8_t f;
+  uint32_t achieved, divider, best;
+  bool solved = I2C_SolveBaud(baudRate, moduleClk, &f, &achieved);
+
+  best = BestDivider(baudRate, moduleClk);
+  if (!best)
+  {
+    if (solved)
+    {
+      printf("FAIL %u Hz from %u Hz: accepted, but every setting is faster\n", baudRate, moduleClk);
+      Failures++;
+    }
+    return;
+  }
+  if (!solved)
+  {
+    printf("FAIL %u Hz from %u Hz: rejected\n", baudRate, moduleClk);
+    Failures++;
+    return;
+  }
+
+  divider = Divider(f);
+  if (!divider || (divider != best) || (achieved != moduleClk / divider))
+  {
+    printf("FAIL %u Hz from %u Hz: F=0x%02X divider %u (expected %u), achieved %u\n",
+	baudRate, moduleClk, f, divider, best, achieved);
+    Failures++;
+  }
+}
+
+/*! @brief Checks a rate against a known I2C0_F value.
+ */
+static void CheckKnown(const uint32_t baudRate, const uint32_t moduleClk, const uint8_t expectedF, const uint32_t expectedRate)
+{
+  uint8_t f;
+  uint32_t achieved;
+
+  if (!I2C_SolveBaud(baudRate, moduleClk, &f, &achieved) || (f != expectedF) || (achieved != expectedRate))
+  {
+    printf("FAIL %u Hz from %u Hz: F=0x%02X %u Hz, expected F=0x%02X %u Hz\n",
+	baudRate, moduleClk, f, achieved, expectedF, expectedRate);
+    Failures++;
+  }
+  else
+  {
+    printf("%6u Hz from %8u Hz -> F=0x%02X, %u Hz\n", baudRate, moduleClk, f, achieved);
+  }
+}
+
+int main(void)
+{
+  static const uint32_t CLOCKS[] = { 25000000, 50000000, 20971520, 60000000 };
+  uint8_t f;
+  uint32_t achieved, rate;
+  unsigned c;
+
+  // Lab5 bus clock: 25 MHz / 64 and 25 MHz / 256, both with MULT = 0
+  CheckKnown(400000, 25000000, 0x12, 390625);
+  CheckKnown(100000, 25000000, 0x23, 97656);
+
+  // Below the slowest setting, 25 MHz / (4 x 3840) = 1627 Hz, no setting is slow enough
+  if (I2C_SolveBaud(0, 25000000, &f, &achieved) || I2C_SolveBaud(400001, 25000000, &f, &achieved)
+      || I2C_SolveBaud(1000, 25000000, &f, &achieved) || I2C_SolveBaud(1627, 25000000, &f, &achieved))
+  {
+    printf("FAIL out of range rates were accepted\n");
+    Failures++;
+  }
+  CheckKnown(1628, 25000000, 0xBF, 1627);
+
+  for (c = 0; c < sizeof(CLOCKS) / sizeof(CLOCKS[0]); c++)
+  {
+    for (rate = 1000; rate <= 400000; rate += 250)
+    {
+      Check(rate, CLOCKS[c]);
+    }
+  }
+
+  printf(Failures ? "%u failures\n" : "PASS\n", Failures);
+  return Failures != 0;
+}
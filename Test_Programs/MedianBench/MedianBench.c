@@ -0,0 +1,179 @@
+/*! @file
+ *
+ *  @brief Checks and times the streaming median filter in Lab5 median.c.
+ *
+ *  For every window length the filter output is compared with a brute force median of the
+ *  same window, then the filter is timed against shifting and sorting the window per sample,
+ *  as main.c used to do. Times are per XYZ sample on the host.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "median.h"
+
+#define NB_CHECKED 20000u   /*!< Samples compared with the brute force median per window length */
+#define NB_TIMED   2000000u /*!< Samples timed per window length */
+
+static int16_t Input[NB_TIMED][MEDIAN_NB_CHANNELS];
+static volatile int16_t Sink;  /*!< Keeps the compiler from dropping the filter output */
+
+/*! @brief Median of a window by sorting a copy of it.
+ */
+static int16_t BruteMedian(const int16_t* const window, const unsigned nbSamples)
+{
+  int16_t copy[MEDIAN_MAX_TAPS], value;
+  unsigned i, j;
+
+  memcpy(copy, window, nbSamples * sizeof(copy[0]));
+  for (i = 1; i < nbSamples; i++)
+  {
+    value = copy[i];
+    for (j = i; (j > 0) && (copy[j - 1] > value); j--)
+    {
+      copy[j] = copy[j - 1];
+    }
+    copy[j] = value;
+  }
+  return copy[nbSamples / 2];
+}
+
+/*! @brief Feeds the test input through the filter and the brute force median.
+ *
+ *  @return bool - TRUE if every output matched.
+ */
+static bool Check(const uint8_t nbTaps)
+{
+  TMedianFilter filter;
+  int16_t out[MEDIAN_NB_CHANNELS];
+  unsigned n, channel, first, nbSamples;
+
+  if (!Median_Init(&filter, nbTaps))
+  {
+    return false;
+  }
+
+  for (n = 0; n < NB_CHECKED; n++)
+  {
+    Median_Update(&filter, Input[n], out);
+    first = (n + 1 >= nbTaps) ? n + 1 - nbTaps : 0;
+    nbSamples = n + 1 - first;
+    for (channel = 0; channel < MEDIAN_NB_CHANNELS; channel++)
+    {
+      int16_t window[MEDIAN_MAX_TAPS];
+      unsigned i;
+
+      for (i = 0; i < nbSamples; i++)
+      {
+        window[i] = Input[first + i][channel];
+      }
+      if (out[channel] != BruteMedian(window, nbSamples))
+      {
+        printf("taps %u sample %u channel %u: %d, expected %d\n", nbTaps, n, channel, out[channel],
+            BruteMedian(window, nbSamples));
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*! @brief Nanoseconds since an arbitrary start.
+ */
+static double Now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*! @brief Times the streaming filter.
+ *
+ *  @return The time per XYZ sample in nanoseconds.
+ */
+static double TimeStreaming(const uint8_t nbTaps)
+{
+  TMedianFilter filter;
+  int16_t out[MEDIAN_NB_CHANNELS];
+  double start;
+  unsigned n;
+
+  Median_Init(&filter, nbTaps);
+  start = Now();
+  for (n = 0; n < NB_TIMED; n++)
+  {
+    Median_Update(&filter, Input[n], out);
+    Sink = out[0];
+  }
+  return (Now() - start) / NB_TIMED;
+}
+
+/*! @brief Times shifting each window and sorting a copy of it.
+ *
+ *  @return The time per XYZ sample in nanoseconds.
+ */
+static double TimeShiftAndSort(const uint8_t nbTaps)
+{
+  int16_t history[MEDIAN_NB_CHANNELS][MEDIAN_MAX_TAPS] = {{0}};
+  double start;
+  unsigned n, channel, i;
+
+  start = Now();
+  for (n = 0; n < NB_TIMED; n++)
+  {
+    for (channel = 0; channel < MEDIAN_NB_CHANNELS; channel++)
+    {
+      for (i = nbTaps - 1; i > 0; i--)
+      {
+        history[channel][i] = history[channel][i - 1];
+      }
+      history[channel][0] = Input[n][channel];
+      Sink = BruteMedian(history[channel], nbTaps);
+    }
+  }
+  return (Now() - start) / NB_TIMED;
+}
+
+int main(void)
+{
+  unsigned n, channel;
+  uint8_t nbTaps;
+  bool passed = true;
+
+  // Accelerometer-like input: a slow wave, noise and a few spikes, with plenty of repeated values
+  srand(1);
+  for (n = 0; n < NB_TIMED; n++)
+  {
+    for (channel = 0; channel < MEDIAN_NB_CHANNELS; channel++)
+    {
+      int value = ((int)(n % 512) - 256) * (int)(channel + 1) + (rand() % 64) - 32;
+
+      if (rand() % 50 == 0)
+      {
+        value = (rand() % 16384) - 8192;
+      }
+      Input[n][channel] = (int16_t) value;
+    }
+  }
+
+  passed = !Median_Init(&(TMedianFilter){0}, 2) && !Median_Init(&(TMedianFilter){0}, 33);
+
+  printf("Taps  Streaming ns/sample  Shift and sort ns/sample\n");
+  for (nbTaps = MEDIAN_MIN_TAPS; nbTaps <= MEDIAN_MAX_TAPS; nbTaps += 2)
+  {
+    if (!Check(nbTaps))
+    {
+      passed = false;
+      continue;
+    }
+    printf("%4u  %19.1f  %24.1f\n", nbTaps, TimeStreaming(nbTaps), TimeShiftAndSort(nbTaps));
+  }
+
+  printf(passed ? "PASS\n" : "FAIL\n");
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/*! @file
+ *
+ *  @brief Checks the packed median-of-3 in Lab5 median.c against Median_Filter3.
+ *
+ *  Every one of the 2^24 byte triples is run through each of the four lanes at once, the lanes
+ *  seeing the triples in different orders, and each lane must match Median_Filter3 exactly.
+ *  The host build exercises the portable code; the USUB8/SEL code is only built for the K70.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "median.h"
+
+#define NB_TRIPLES (1u << 24)
+
+static volatile uint32_t Sink;  /*!< Keeps the compiler from dropping the filter output */
+
+/*! @brief Gets a byte lane of a word.
+ */
+static uint8_t Lane(const uint32_t word, const unsigned lane)
+{
+  return (uint8_t) (word >> (8 * lane));
+}
+
+/*! @brief Nanoseconds since an arbitrary start.
+ */
+static double Now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int main(void)
+{
+  uint32_t i, n1, n2, n3, median;
+  uint8_t a, b, c;
+  unsigned lane, failures = 0;
+  double start, scalarTime, packedTime;
+
+  for (i = 0; i < NB_TRIPLES; i++)
+  {
+    a = (uint8_t) i;
+    b = (uint8_t) (i >> 8);
+    c = (uint8_t) (i >> 16);
+
+    // Lane 0 gets (a, b, c), the others rotations and a scrambled copy, so each lane sees every triple
+    n1 = a | ((uint32_t) b << 8) | ((uint32_t) c << 16) | ((uint32_t) (uint8_t) ~c << 24);
+    n2 = b | ((uint32_t) c << 8) | ((uint32_t) a << 16) | ((uint32_t) (uint8_t) (a ^ 0x5A) << 24);
+    n3 = c | ((uint32_t) a << 8) | ((uint32_t) b << 16) | ((uint32_t) (uint8_t) (b + 0x33) << 24);
+
+    median = Median_Filter3_Packed(n1, n2, n3);
+    for (lane = 0; lane < 4; lane++)
+    {
+      if (Lane(median, lane) != Median_Filter3(Lane(n1, lane), Lane(n2, lane), Lane(n3, lane)))
+      {
+        if (failures++ < 10)
+        {
+          printf("lane %u of %08X %08X %08X: %02X, expected %02X\n", lane, n1, n2, n3, Lane(median, lane),
+              Median_Filter3(Lane(n1, lane), Lane(n2, lane), Lane(n3, lane)));
+        }
+      }
+    }
+  }
+
+  // Filtering X, Y and Z: three scalar calls against one packed call
+  start = Now();
+  for (i = 0; i < NB_TRIPLES; i++)
+  {
+    Sink = Median_Filter3((uint8_t) i, (uint8_t) (i >> 8), (uint8_t) (i >> 16))
+        + Median_Filter3((uint8_t) (i >> 8), (uint8_t) (i >> 16), (uint8_t) i)
+        + Median_Filter3((uint8_t) (i >> 16), (uint8_t) i, (uint8_t) (i >> 8));
+  }
+  scalarTime = (Now() - start) / NB_TRIPLES;
+
+  start = Now();
+  for (i = 0; i < NB_TRIPLES; i++)
+  {
+    Sink = Median_Filter3_Packed(i, (i >> 8) | (i << 16), (i >> 16) | (i << 8));
+  }
+  packedTime = (Now() - start) / NB_TRIPLES;
+
+  printf("XYZ median: %.2f ns scalar, %.2f ns packed\n", scalarTime, packedTime);
+  printf(failures ? "FAIL\n" : "PASS\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,517 @@
+/*! @file
+ *
+ *  @brief Checks the Lab5 RTOS kernel on Linux and times it.
+ *
+ *  Lab5 OS.c runs on the ucontext port in OSPortHost.c. The checks cover priority preemption,
+ *  semaphore timeouts, delays, message queues, event flags, the thread creation and deletion errors
+ *  and stack usage tracking.
+ *  The host port does not run threads on the stacks they are given, so the stack checks write
+ *  the stack by hand. The benchmark runs
+ *  the thread graph of Lab5 main.c, the same threads at the same priorities waiting on the same
+ *  kinds of interrupt and passing samples through a queue, with the drivers replaced by a few lines of work each and the idle hook
+ *  playing the UART, PIT, I2C and RTC, and prints the load of each thread as the kernel accounts
+ *  it. A semaphore ping-pong between two threads times a bare context switch.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "OS.h"
+#include "OSHost.h"
+
+#define STACK_SIZE 100		/*!< Not used by the host port, which has stacks of its own */
+#define PING_PONGS 1000000u
+#define SIM_MS 200000u		/*!< Simulated milliseconds of the Lab5 thread graph */
+#define MS_PER_TICK 10u		/*!< The OS clock runs at 100 Hz */
+#define RX_BYTES_PER_MS 11u	/*!< 115200 baud */
+#define SAMPLE_MS 1u		/*!< The PIT sample channel at 800 Hz, rounded */
+#define MONITOR_MS 20u
+#define RTC_MS 1000u
+#define PACKET_SIZE 5u
+#define STACK_USED 40u
+#define QUEUE_SIZE 4u
+#define SAMPLE_TICK_FLAG 0x100u	/*!< As in Lab5 main.c */
+#define READ_DONE_FLAG 0x02u	/*!< ACCEL_FLAG_READ_DONE */
+
+OS_THREAD_STACK(BenchStack, STACK_SIZE);
+OS_THREAD_STACK(Stack1, STACK_SIZE);
+OS_THREAD_STACK(Stack2, STACK_SIZE);
+OS_THREAD_STACK(ReceiveStack, STACK_SIZE);
+OS_THREAD_STACK(TransmitStack, STACK_SIZE);
+OS_THREAD_STACK(RTCStack, STACK_SIZE);
+OS_THREAD_STACK(MonitorStack, STACK_SIZE);
+OS_THREAD_STACK(PacketStack, STACK_SIZE);
+OS_THREAD_STACK(AccelStack, STACK_SIZE);
+OS_THREAD_STACK(SampleStack, STACK_SIZE);
+
+static bool Passed = true;
+static OS_ECB *Done;
+
+static OS_ECB *Ping, *Pong;
+static uint32_t Order[4];
+static uint8_t NbOrder;
+
+static OS_QUEUE *Queue;
+OS_QUEUE_BUFFER(QueueBuffer, uint32_t, QUEUE_SIZE);
+static uint32_t Received;
+static OS_FLAGS *Flags;
+static uint32_t FlagsGot;
+
+//The Lab5 thread graph
+static OS_ECB *RxSemaphore, *TxSemaphore, *PacketSemaphore, *MonitorSemaphore, *RTCSemaphore;
+static OS_FLAGS *AccelFlags;
+static OS_QUEUE *SampleQueue;
+OS_QUEUE_BUFFER(SampleBuffer, uint32_t, 64);
+static uint8_t RxByte;
+static uint32_t PacketBytes, TxQueued;
+static bool I2CBusy;
+static uint32_t SimMs, SimRxBytes;
+static uint32_t NbPackets, NbSamples, NbMonitors, NbRTC, NbTxBytes, NbRxLost;
+static OS_LOAD Loads[OS_LOWEST_PRIORITY + 2];	/*!< Every priority, then the ISRs */
+
+/*! @brief Reports a check.
+ */
+static void Check(const bool ok, const char* const what)
+{
+  printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+  Passed &= ok;
+}
+
+static double Seconds(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static const char* ThreadName(const uint32_t priority)
+{
+  static const char* const names[] = { "Bench", "Receive", "Transmit", "Accel", "RTC", "Monitor", "Packet", "Sample" };
+
+  return (priority < sizeof(names) / sizeof(names[0])) ? names[priority] : "";
+}
+
+/*! @brief Runs an interrupt service routine that signals a semaphore, from the idle hook.
+ */
+static void Interrupt(OS_ECB* const semaphore)
+{
+  OS_ISREnter();
+  OS_SemaphoreSignal(semaphore);
+  OS_ISRExit();
+}
+
+/*! @brief Runs an interrupt service routine that sets flags, from the idle hook.
+ */
+static void InterruptFlags(OS_FLAGS* const flags, const uint32_t mask)
+{
+  OS_ISREnter();
+  OS_FlagsSet(flags, mask);
+  OS_ISRExit();
+}
+
+static void LowThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(Ping, 0);
+    Order[NbOrder++] = 2;
+    OS_SemaphoreSignal(Pong); //Wakes the higher priority thread, which must run before this goes on
+    Order[NbOrder++] = 4;
+    OS_SemaphoreSignal(Done);
+  }
+}
+
+static void HighThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(Pong, 0);
+    Order[NbOrder++] = 3;
+  }
+}
+
+/*! @brief Uses STACK_USED words of its stack, then overflows it.
+ */
+static void StackThread(void* pData)
+{
+  Stack1[STACK_SIZE - STACK_USED] = 0;
+  OS_SemaphoreWait(Ping, 0);
+  Stack1[0] = 0;
+  OS_SemaphoreWait(Ping, 0);
+}
+
+static void QueueThread(void* pData)
+{
+  for (;;)
+  {
+    OS_QueuePend(Queue, &Received, 0);
+    OS_SemaphoreSignal(Done);
+  }
+}
+
+/*! @brief Waits for both of two flags.
+ */
+static void FlagsThread(void* pData)
+{
+  for (;;)
+  {
+    OS_FlagsWait(Flags, 0x3u, true, 0, &FlagsGot);
+    OS_SemaphoreSignal(Done);
+  }
+}
+
+static void PingThread(void* pData)
+{
+  uint32_t i;
+
+  for (i = 0; i < PING_PONGS; i++)
+  {
+    OS_SemaphoreSignal(Pong);
+    OS_SemaphoreWait(Ping, 0);
+  }
+  OS_SemaphoreSignal(Done);
+  OS_ThreadDelete(OS_PRIORITY_SELF);
+}
+
+static void PongThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(Pong, 0);
+    OS_SemaphoreSignal(Ping);
+  }
+}
+
+/*! @brief Adds a packet to the transmit queue, as Packet_Put does.
+ */
+static void PutPacket(void)
+{
+  TxQueued += PACKET_SIZE;
+  OS_SemaphoreSignal(TxSemaphore);
+}
+
+static void ReceiveThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(RxSemaphore, 0);
+    (void) RxByte;
+    OS_SemaphoreSignal(PacketSemaphore);
+  }
+}
+
+static void TransmitThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(TxSemaphore, 0);
+    NbTxBytes += TxQueued;
+    TxQueued = 0;
+  }
+}
+
+static void RTCThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(RTCSemaphore, 0);
+    NbRTC++;
+    PutPacket();
+  }
+}
+
+static void MonitorThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(MonitorSemaphore, 0);
+    NbMonitors++;
+  }
+}
+
+static void PacketThread(void* pData)
+{
+  for (;;)
+  {
+    OS_SemaphoreWait(PacketSemaphore, 0);
+    if (++PacketBytes == PACKET_SIZE)
+    {
+      PacketBytes = 0;
+      NbPackets++;
+      PutPacket(); //The acknowledgement
+    }
+  }
+}
+
+static void AccelThread(void* pData)
+{
+  uint32_t ready, sample = 0;
+
+  for (;;)
+  {
+    OS_FlagsWait(AccelFlags, SAMPLE_TICK_FLAG | READ_DONE_FLAG, false, 0, &ready);
+    if (ready & READ_DONE_FLAG)
+    {
+      OS_QueuePost(SampleQueue, &sample);
+      sample++;
+    }
+    if (ready & SAMPLE_TICK_FLAG)
+    {
+      I2CBusy = true; //Start the accelerometer read
+    }
+  }
+}
+
+static void SampleThread(void* pData)
+{
+  uint32_t sample;
+
+  for (;;)
+  {
+    OS_QueuePend(SampleQueue, &sample, 0);
+    if (sample == NbSamples)
+    {
+      NbSamples++;
+    }
+    PutPacket(); //The sample
+  }
+}
+
+/*! @brief Plays the Lab5 hardware, a millisecond per call.
+ *
+ *  The I2C transfer a PIT sample starts completes on the next call.
+ */
+static void GraphHook(void)
+{
+  uint32_t i;
+
+  if (I2CBusy)
+  {
+    I2CBusy = false;
+    InterruptFlags(AccelFlags, READ_DONE_FLAG);
+  }
+  if (SimMs == SIM_MS)
+  {
+    OSHost_SetIdleHook(NULL);
+    Interrupt(Done);
+    return;
+  }
+  SimMs++;
+
+  for (i = 0; i < RX_BYTES_PER_MS; i++)
+  {
+    RxByte = (uint8_t) SimRxBytes++;
+    if (RxSemaphore->count)
+    {
+      NbRxLost++;
+    }
+    Interrupt(RxSemaphore);
+  }
+  if (!(SimMs % SAMPLE_MS))
+  {
+    InterruptFlags(AccelFlags, SAMPLE_TICK_FLAG);
+  }
+  if (!(SimMs % MONITOR_MS))
+  {
+    Interrupt(MonitorSemaphore);
+  }
+  if (!(SimMs % RTC_MS))
+  {
+    Interrupt(RTCSemaphore);
+  }
+  if (!(SimMs % MS_PER_TICK))
+  {
+    OSHost_Tick();
+  }
+}
+
+/*! @brief Runs the checks and benchmarks one after the other, at the highest priority.
+ */
+static void BenchThread(void* pData)
+{
+  uint32_t start, i, message, got;
+  uint64_t switches, counted, accounted;
+  double begin, seconds;
+  OS_ECB *never;
+  OS_STACK_INFO info;
+
+  //Priority preemption
+  Ping = OS_SemaphoreCreate(0);
+  Pong = OS_SemaphoreCreate(0);
+  OS_ThreadCreate(LowThread, NULL, &Stack1[STACK_SIZE - 1], 20);
+  OS_ThreadCreate(HighThread, NULL, &Stack2[STACK_SIZE - 1], 10);
+  Order[NbOrder++] = 1;
+  OS_SemaphoreSignal(Ping);
+  OS_SemaphoreWait(Done, 0);
+  Check((NbOrder == 4) && (Order[0] == 1) && (Order[1] == 2) && (Order[2] == 3) && (Order[3] == 4),
+        "A signal switches to a higher priority waiter at once");
+
+  Check(OS_ThreadCreate(LowThread, NULL, &Stack1[STACK_SIZE - 1], 20) == OS_PRIORITY_EXISTS,
+        "OS_ThreadCreate rejects a priority in use");
+  Check(OS_ThreadCreate(LowThread, NULL, &Stack1[STACK_SIZE - 1], OS_LOWEST_PRIORITY + 1) == OS_PRIORITY_INVALID,
+        "OS_ThreadCreate rejects an invalid priority");
+  Check(OS_ThreadDelete(OS_LOWEST_PRIORITY) == OS_THREAD_DELETE_IDLE, "OS_ThreadDelete refuses the idle thread");
+  Check((OS_ThreadDelete(20) == OS_NO_ERROR) && (OS_ThreadDelete(10) == OS_NO_ERROR)
+        && (OS_ThreadDelete(20) == OS_THREAD_DELETE_ERROR), "OS_ThreadDelete deletes a thread only once");
+
+  //Time
+  never = OS_SemaphoreCreate(0);
+  start = OS_TimeGet();
+  Check((OS_SemaphoreWait(never, 5) == OS_TIMEOUT) && (OS_TimeGet() - start == 5),
+        "OS_SemaphoreWait times out after its timeout");
+  start = OS_TimeGet();
+  OS_TimeDelay(3);
+  Check(OS_TimeGet() - start == 3, "OS_TimeDelay delays for its ticks");
+  OS_SemaphoreSignal(never);
+  Check((OS_SemaphoreWait(never, 5) == OS_NO_ERROR) && (OS_TimeGet() - start == 3),
+        "OS_SemaphoreWait takes a signal without waiting");
+  Check((OS_SemaphoreSignal(OS_SemaphoreCreate(0xFFFFFFFFu)) == OS_SEMAPHORE_OVERFLOW),
+        "OS_SemaphoreSignal reports an overflow");
+
+  //Message queues
+  Queue = OS_QueueCreate(QueueBuffer, sizeof(uint32_t), QUEUE_SIZE);
+  for (i = 0; i < QUEUE_SIZE; i++)
+  {
+    OS_QueuePost(Queue, &i);
+  }
+  message = 0;
+  Check(OS_QueuePost(Queue, &message) == OS_QUEUE_FULL, "OS_QueuePost reports a full queue");
+  for (i = 0; (i < QUEUE_SIZE) && (OS_QueuePend(Queue, &message, 1) == OS_NO_ERROR) && (message == i); i++)
+  {
+  }
+  Check(i == QUEUE_SIZE, "OS_QueuePend gets the messages in the order they were posted");
+  start = OS_TimeGet();
+  Check((OS_QueuePend(Queue, &message, 2) == OS_TIMEOUT) && (OS_TimeGet() - start == 2),
+        "OS_QueuePend times out on an empty queue");
+  OS_ThreadCreate(QueueThread, NULL, &Stack1[STACK_SIZE - 1], 20);
+  OS_TimeDelay(1);
+  message = 0x12345678u;
+  OS_QueuePost(Queue, &message);
+  message = 0;
+  OS_SemaphoreWait(Done, 0);
+  Check((Received == 0x12345678u) && !Queue->count, "OS_QueuePost copies a message straight to a waiting thread");
+  OS_ThreadDelete(20);
+
+  //Event flags
+  Flags = OS_FlagsCreate(0x4u);
+  Check((OS_FlagsWait(Flags, 0x6u, false, 1, &got) == OS_NO_ERROR) && (got == 0x4u) && !Flags->flags,
+        "OS_FlagsWait for any gets the flags set and clears them");
+  start = OS_TimeGet();
+  Check((OS_FlagsWait(Flags, 0x1u, false, 2, &got) == OS_TIMEOUT) && !got && (OS_TimeGet() - start == 2),
+        "OS_FlagsWait times out");
+  OS_ThreadCreate(FlagsThread, NULL, &Stack1[STACK_SIZE - 1], 20);
+  OS_TimeDelay(1);
+  OS_FlagsSet(Flags, 0x1u);
+  OS_TimeDelay(1);
+  Check(!FlagsGot && (Flags->flags == 0x1u), "OS_FlagsWait for all waits for every flag");
+  OS_FlagsSet(Flags, 0x2u | 0x8u);
+  OS_SemaphoreWait(Done, 0);
+  Check((FlagsGot == 0x3u) && (Flags->flags == 0x8u), "OS_FlagsSet readies a thread once all its flags are set");
+  OS_ThreadDelete(20);
+
+  //Stack usage, found by the idle thread, which scans a stack a pass and ticks the clock a pass
+  Ping = OS_SemaphoreCreate(0);
+  OS_ThreadCreateStack(StackThread, NULL, Stack1, STACK_SIZE, 20);
+  OS_TimeDelay(OS_LOWEST_PRIORITY + 2);
+  Check(OS_StackInfo(20, &info) && (info.size == STACK_SIZE) && (info.used == STACK_USED) && !info.overflowed,
+        "The idle thread finds the deepest stack use");
+  OS_SemaphoreSignal(Ping);
+  OS_TimeDelay(1);
+  OS_StackInfo(20, &info);
+  Check(info.overflowed, "A context switch finds an overwritten canary");
+  Check(OS_StackInfo(OS_LOWEST_PRIORITY, &info) && info.size && !OS_StackInfo(21, &info),
+        "OS_StackInfo covers the idle thread and no dormant one");
+  OS_ThreadDelete(20);
+
+  //Bare context switch
+  Ping = OS_SemaphoreCreate(0);
+  Pong = OS_SemaphoreCreate(0);
+  OS_ThreadCreate(PongThread, NULL, &Stack2[STACK_SIZE - 1], 10);
+  switches = OSHost_NbSwitches();
+  begin = Seconds();
+  OS_ThreadCreate(PingThread, NULL, &Stack1[STACK_SIZE - 1], 20);
+  OS_SemaphoreWait(Done, 0);
+  seconds = Seconds() - begin;
+  switches = OSHost_NbSwitches() - switches;
+  printf("Semaphore ping-pong: %.0f ns per context switch (host)\n", seconds * 1e9 / (double) switches);
+  OS_ThreadDelete(10);
+
+  //The Lab5 thread graph
+  RxSemaphore = OS_SemaphoreCreate(0);
+  TxSemaphore = OS_SemaphoreCreate(0);
+  PacketSemaphore = OS_SemaphoreCreate(0);
+  MonitorSemaphore = OS_SemaphoreCreate(0);
+  RTCSemaphore = OS_SemaphoreCreate(0);
+  Check(RTCSemaphore != NULL, "OS_SemaphoreCreate has event control blocks for Lab5");
+  AccelFlags = OS_FlagsCreate(0);
+  SampleQueue = OS_QueueCreate(SampleBuffer, sizeof(uint32_t), 64);
+  OS_ThreadCreate(ReceiveThread, NULL, &ReceiveStack[STACK_SIZE - 1], 1);
+  OS_ThreadCreate(TransmitThread, NULL, &TransmitStack[STACK_SIZE - 1], 2);
+  OS_ThreadCreate(AccelThread, NULL, &AccelStack[STACK_SIZE - 1], 3);
+  OS_ThreadCreate(RTCThread, NULL, &RTCStack[STACK_SIZE - 1], 4);
+  OS_ThreadCreate(MonitorThread, NULL, &MonitorStack[STACK_SIZE - 1], 5);
+  OS_ThreadCreate(PacketThread, NULL, &PacketStack[STACK_SIZE - 1], 6);
+  OS_ThreadCreate(SampleThread, NULL, &SampleStack[STACK_SIZE - 1], 7);
+
+  OS_LoadClear();
+  switches = OSHost_NbSwitches();
+  begin = Seconds();
+  OSHost_SetIdleHook(GraphHook);
+  OS_SemaphoreWait(Done, 0);
+  seconds = Seconds() - begin;
+  switches = OSHost_NbSwitches() - switches;
+  for (i = 0; i <= OS_LOWEST_PRIORITY; i++)
+  {
+    if (!OS_LoadThread((uint8_t) i, &Loads[i]))
+    {
+      Loads[i] = (OS_LOAD) { 0 };
+    }
+  }
+  OS_LoadISR(&Loads[i]);
+
+  Check(!NbRxLost && (NbPackets == SIM_MS * RX_BYTES_PER_MS / PACKET_SIZE),
+        "Every received byte reaches the packet thread");
+  Check((NbSamples == SIM_MS / SAMPLE_MS) && (NbMonitors == SIM_MS / MONITOR_MS) && (NbRTC == SIM_MS / RTC_MS),
+        "Every timer interrupt is served");
+  Check(NbTxBytes == (NbPackets + NbSamples + NbRTC) * PACKET_SIZE, "Every packet is transmitted");
+  printf("Lab5 thread graph: %u simulated seconds in %.2f s, %llu context switches, %.0f ns each (host)\n",
+         SIM_MS / 1000u, seconds, (unsigned long long) switches, seconds * 1e9 / (double) switches);
+
+  for (i = 0, counted = 0, accounted = 0; i <= OS_LOWEST_PRIORITY + 1; i++)
+  {
+    counted += (i <= OS_LOWEST_PRIORITY) ? Loads[i].count : 0;
+    accounted += Loads[i].cycles;
+  }
+  for (i = 0; i <= OS_LOWEST_PRIORITY + 1; i++)
+  {
+    if (Loads[i].count)
+    {
+      printf("  %2u %-9s %5.1f %% %10u %s\n",
+             i, (i == OS_LOWEST_PRIORITY) ? "Idle" : (i > OS_LOWEST_PRIORITY) ? "ISRs" : ThreadName(i),
+             100.0 * (double) Loads[i].cycles / (double) accounted, Loads[i].count,
+             (i > OS_LOWEST_PRIORITY) ? "interrupts" : "switches in");
+    }
+  }
+  Check(counted == switches, "The load accounting counts every context switch");
+  Check((accounted > seconds * 0.99e9) && (accounted < seconds * 1.01e9), "The load accounting charges all the time");
+
+  for (i = 1; i <= 7; i++)
+  {
+    OS_ThreadDelete((uint8_t) i);
+  }
+  printf("%s\n", Passed ? "PASS" : "FAIL");
+  exit(Passed ? 0 : 1);
+}
+
+int main(void)
+{
+  OS_Init(50000000u, false);
+  Done = OS_SemaphoreCreate(0);
+  OS_ThreadCreate(BenchThread, NULL, &BenchStack[STACK_SIZE - 1], 0);
+  OS_Start();
+  return 1;
+}
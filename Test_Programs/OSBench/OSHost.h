@@ -0,0 +1,36 @@
+/*! @file
+ *
+ *  @brief The Linux port of the Lab5 RTOS.
+ *
+ *  Threads are ucontext coroutines on one Linux thread, each with its own large stack in place of
+ *  the one passed to OS_ThreadCreate. There are no real interrupts: the idle thread runs the idle
+ *  hook, which plays the hardware by calling interrupt service routines, so a thread only ever
+ *  loses the processor to an interrupt when every thread is waiting. With no hook, each pass of
+ *  the idle thread is a clock tick.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#ifndef OSHOST_H
+#define OSHOST_H
+
+#include "OS.h"
+
+/*! @brief Sets the function the idle thread calls over and over.
+ *
+ *  @param hook is the function, or NULL to tick the clock instead.
+ */
+void OSHost_SetIdleHook(void (*hook)(void));
+
+/*! @brief Runs the OS clock tick interrupt.
+ */
+void OSHost_Tick(void);
+
+/*! @brief Gets the number of context switches so far.
+ *
+ *  @return uint64_t - The number of context switches.
+ */
+uint64_t OSHost_NbSwitches(void);
+
+#endif
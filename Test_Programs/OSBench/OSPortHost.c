@@ -0,0 +1,123 @@
+/*! @file
+ *
+ *  @brief The Linux port of the Lab5 RTOS.
+ *
+ *  Implements OSPort.h with ucontext, so Lab5 OS.c runs unchanged on the host.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+#include "OSPort.h"
+#include "OSHost.h"
+
+#define HOST_STACK_SIZE (64 * 1024)
+
+/*!
+ * @brief A thread's context, what the kernel sees as its stack pointer.
+ */
+typedef struct
+{
+  ucontext_t context;
+  void (*thread)(void*);
+  void *pData;
+} THostThread;
+
+static THostThread *Running;
+static void (*IdleHook)(void);
+static uint64_t NbSwitches;
+
+/*! @brief Runs a thread the first time it is switched to; a thread that returns is deleted.
+ */
+static void Trampoline(void)
+{
+  Running->thread(Running->pData);
+  (void) OS_ThreadDelete(OS_PRIORITY_SELF);
+}
+
+void OSPort_Init(const uint32_t cpuCoreClk, const bool toggleLED)
+{
+  IdleHook = NULL;
+  NbSwitches = 0;
+}
+
+void* OSPort_StackInit(void (*thread)(void* pd), void* const pData, void* const pStack)
+{
+  THostThread *host = malloc(sizeof(THostThread) + HOST_STACK_SIZE);
+
+  if (!host)
+  {
+    abort();
+  }
+  host->thread = thread;
+  host->pData = pData;
+  getcontext(&host->context);
+  host->context.uc_stack.ss_sp = host + 1;
+  host->context.uc_stack.ss_size = HOST_STACK_SIZE;
+  host->context.uc_link = NULL;
+  makecontext(&host->context, Trampoline, 0);
+  return host;
+}
+
+void OSPort_Start(void)
+{
+  Running = OS_ContextSwitch(NULL);
+  setcontext(&Running->context);
+  abort();
+}
+
+/*! @brief Switches at once; the kernel only asks outside interrupts, and the host has no others.
+ */
+void OSPort_Switch(void)
+{
+  THostThread* const from = Running;
+
+  Running = OS_ContextSwitch(from);
+  if (Running != from)
+  {
+    NbSwitches++;
+    swapcontext(&from->context, &Running->context);
+  }
+}
+
+void OSPort_Idle(void)
+{
+  if (IdleHook)
+  {
+    IdleHook();
+  }
+  else
+  {
+    OSHost_Tick();
+  }
+}
+
+/*! @brief Counts nanoseconds, the host's stand-in for processor cycles.
+ */
+uint32_t OSPort_Cycles(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t) ((uint64_t) now.tv_sec * 1000000000u + now.tv_nsec);
+}
+
+void OSHost_SetIdleHook(void (*hook)(void))
+{
+  IdleHook = hook;
+}
+
+void OSHost_Tick(void)
+{
+  OS_ISREnter();
+  OS_Tick();
+  OS_ISRExit();
+}
+
+uint64_t OSHost_NbSwitches(void)
+{
+  return NbSwitches;
+}
@@ -0,0 +1,242 @@
+/*! @file
+ *
+ *  @brief Checks the software timer service in Lab5 Timer.c and times it.
+ *
+ *  The FTM is replaced by stubs, and the test runs the tick interrupt itself. Thousands of one-shot
+ *  and periodic timers, some beyond the span of the wheel, must expire on exactly the tick they are
+ *  due, including when compares are missed and ticks have to be caught up. Stopping and restarting
+ *  timers, also from the user functions, and the channel going idle with no timers are checked too.
+ *
+ *  @author Corey Stidston and Menka Mehta
+ *  @date 2026-10-18
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "Timer.h"
+#include "FTM.h"
+
+#define NB_TIMERS 5000u
+#define MAX_DELAY 700000u	/*!< Well past the 262144 ticks the wheel covers */
+#define MAX_PERIOD 5000u
+#define RUN_TICKS 800000u
+#define BENCH_TIMERS 10000u
+#define BENCH_TICKS 200000u
+
+typedef struct
+{
+  TTimer timer;
+  uint32_t due;		/*!< The tick the timer should expire on next */
+  uint32_t period;
+  unsigned fired;
+  bool late;		/*!< Expired on another tick than due */
+  bool stopped;
+  bool chain;		/*!< Restarts itself from its user function */
+} TTestTimer;
+
+static TTestTimer Timers[NB_TIMERS];
+static TTestTimer BenchTimers[BENCH_TIMERS];
+
+static void (*TickFunction)(void*);
+static void *TickArguments;
+static bool Armed;		/*!< The tick compare is set */
+static unsigned NbStarts;	/*!< Times the channel was started from idle */
+static uint32_t SimNow;		/*!< Ticks run by the test */
+static unsigned MissEvery;	/*!< Every so many restarts, the compare has already passed; 0 for never */
+static unsigned NbRestarts;
+static unsigned NbMissed;	/*!< Compares missed, so ticks caught up */
+static uint32_t Seed = 12345;
+static bool Passed = true;
+
+bool FTM_Set(const TFTMChannel* const aFTMChannel)
+{
+  TickFunction = aFTMChannel->userFunction;
+  TickArguments = aFTMChannel->userArguments;
+  return true;
+}
+
+bool FTM_StartTimer(const TFTMChannel* const aFTMChannel)
+{
+  Armed = true;
+  NbStarts++;
+  return true;
+}
+
+bool FTM_RestartTimer(const uint8_t channelNb, const uint16_t delayCount)
+{
+  if (MissEvery && !(++NbRestarts % MissEvery))
+  {
+    NbMissed++;
+    SimNow++;		//The timer module runs the next tick straight away
+    return false;
+  }
+  Armed = true;
+  return true;
+}
+
+/*! @brief Reports a check.
+ */
+static void Check(const bool ok, const char* const what)
+{
+  printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+  Passed &= ok;
+}
+
+static uint32_t Random(const uint32_t range)
+{
+  Seed = Seed * 1664525u + 1013904223u;
+  return (Seed >> 8) % range;
+}
+
+/*! @brief Runs tick interrupts until the channel goes idle or the count is reached.
+ */
+static void RunTicks(const uint32_t nbTicks)
+{
+  uint32_t n;
+
+  for (n = 0; (n < nbTicks) && Armed; n++)
+  {
+    Armed = false;
+    SimNow++;
+    TickFunction(TickArguments);
+  }
+}
+
+static void Expired(void *arg)
+{
+  TTestTimer* const t = (TTestTimer*) arg;
+
+  t->late |= (SimNow != t->due) || t->stopped;
+  t->fired++;
+  if (t->period)
+  {
+    t->due += t->period;
+  }
+  else if (t->chain && (t->fired < 10))
+  {
+    //Each restart also stops the next timer, which may expire on this same tick
+    t->due = SimNow + 7;
+    (void)Timer_Start(&t->timer, 7, 0);
+    if ((t + 1 < Timers + NB_TIMERS) && Timer_Stop(&t[1].timer))
+    {
+      t[1].stopped = true;
+    }
+  }
+}
+
+static void StartTimer(TTestTimer* const t, const uint32_t delay, const uint32_t period)
+{
+  t->due = SimNow + (delay ? delay : 1);
+  t->period = period;
+  t->stopped = false;
+  t->timer.userFunction = Expired;
+  t->timer.userArguments = t;
+  (void)Timer_Start(&t->timer, delay, period);
+}
+
+/*! @brief Starts every timer, runs them, stopping and restarting some on the way, and checks they expire on time.
+ *
+ *  @param missEvery is how often a compare is missed, 0 for never.
+ *  @return bool - TRUE if every timer expired exactly when it was due.
+ */
+static bool RunAll(const unsigned missEvery)
+{
+  unsigned i, late = 0, missing = 0;
+  uint32_t start, tick;
+
+  MissEvery = missEvery;
+  for (i = 0; i < NB_TIMERS; i++)
+  {
+    Timers[i] = (TTestTimer) { .chain = (i % 50 == 0) };
+    StartTimer(&Timers[i], 1 + Random(MAX_DELAY), (i % 3 == 0) ? 1 + Random(MAX_PERIOD) : 0);
+  }
+  start = SimNow;
+
+  for (tick = 0; tick < RUN_TICKS; tick += 1000)
+  {
+    RunTicks(1000);
+    //Between ticks, stop one timer and restart another
+    i = Random(NB_TIMERS);
+    if (Timer_Stop(&Timers[i].timer))
+    {
+      Timers[i].stopped = true;
+    }
+    i = Random(NB_TIMERS);
+    if (!Timers[i].chain)
+    {
+      StartTimer(&Timers[i], 1 + Random(MAX_DELAY), Timers[i].period);
+      Timers[i].fired = 0;
+    }
+  }
+
+  for (i = 0; i < NB_TIMERS; i++)
+  {
+    late += Timers[i].late;
+    //A one-shot that was not stopped and was due in the run must have expired
+    if (!Timers[i].period && !Timers[i].stopped && !Timers[i].chain && (Timers[i].due <= start + RUN_TICKS - 1000)
+        && !Timers[i].fired)
+    {
+      missing++;
+    }
+    (void)Timer_Stop(&Timers[i].timer);
+  }
+  printf("  %u ticks (%u caught up), %u timers expired late, %u never expired\n",
+         (unsigned)(SimNow - start), NbMissed, late, missing);
+  return !late && !missing;
+}
+
+int main(void)
+{
+  unsigned i, nbStarts;
+  uint32_t due;
+  clock_t begin;
+  double seconds;
+  unsigned long expiries = 0;
+
+  Check(Timer_Init(0, 24414) && TickFunction, "Timer_Init on the 24414 Hz fixed frequency clock");
+  Check(!Timer_Init(0, 500), "Timer_Init rejects a clock slower than the tick");
+
+  Check(RunAll(0), "5000 timers expire on their tick");
+  RunTicks(2);
+  Check(!Armed && !Timer_NbRunning(), "Channel goes idle once the timers are stopped");
+
+  NbMissed = 0;
+  Check(RunAll(7), "5000 timers expire on their tick with missed compares");
+  MissEvery = 0;
+  RunTicks(2);
+
+  //From idle, a timer must start the channel again and count from the tick it was started on
+  nbStarts = NbStarts;
+  Timers[0] = (TTestTimer) { 0 };
+  StartTimer(&Timers[0], 5, 0);
+  due = Timers[0].due;
+  RunTicks(100);
+  Check((NbStarts == nbStarts + 1) && (Timers[0].fired == 1) && !Timers[0].late && (SimNow == due),
+        "A timer started when idle restarts the channel");
+
+  Timers[0] = (TTestTimer) { 0 };
+  StartTimer(&Timers[0], 0, 0);
+  RunTicks(100);
+  Check((Timers[0].fired == 1) && !Timers[0].late, "A delay of 0 expires on the next tick");
+  Check(!Timer_Start(&Timers[0].timer, TIMER_MAX_TICKS + 1u, 0) && !Timer_IsRunning(&Timers[0].timer),
+        "Timer_Start rejects a delay that is too long");
+
+  for (i = 0; i < BENCH_TIMERS; i++)
+  {
+    BenchTimers[i] = (TTestTimer) { 0 };
+    StartTimer(&BenchTimers[i], 1 + Random(MAX_PERIOD), 1 + Random(MAX_PERIOD));
+  }
+  begin = clock();
+  RunTicks(BENCH_TICKS);
+  seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+  for (i = 0; i < BENCH_TIMERS; i++)
+  {
+    expiries += BenchTimers[i].fired;
+    Passed &= !BenchTimers[i].late;
+  }
+  printf("%u periodic timers: %.0f ns per tick, %.0f ns per expiry (host)\n", BENCH_TIMERS,
+         seconds * 1e9 / BENCH_TICKS, seconds * 1e9 / (double)expiries);
+
+  printf("%s\n", Passed ? "PASS" : "FAIL");
+  return Passed ? 0 : 1;
+}